@@ -22,6 +22,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -119,11 +120,15 @@ RoutingExperiment::WriteToSummaryFile (RunSummary srs)
     {
       out.open ((m_csvFileNamePrefix + "-Summary.csv").c_str (), std::ofstream::out | std::ofstream::trunc);
       out << "Rng Run, Number of Flows, Throughput [bps],, Tx Packets,, Rx Packets,, Lost Packets,, Packet Lost Ratio [%],, Packet Delivery Ratio [%],, PHY Tx Packets,, Useful Traffic Ratio [%],,"
-          << "E2E Delay Min [ms],, E2E Delay Max [ms],, E2E Delay Average [ms],, E2E Delay Median Estimate [ms],, E2E Delay Jitter [ms]"
+          << "E2E Delay Min [ms],, E2E Delay Max [ms],, E2E Delay Average [ms],, E2E Delay Median Estimate [ms],, E2E Delay Jitter [ms],,"
+          << "PHY Tx Airtime [s], LPP Tx Packets, LPP Saved Packets, LPP Saved Airtime [s],"
+          << "Route Discoveries, Route Discovery Success [%], Route Discovery Latency Average [ms], Transmissions per Route Discovery"
           << std::endl;
       out << ", , all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg"
           << "  , all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg"
           << "  , all flows avg, all packets avg, all packets avg, all packets avg, all packets avg, all packets avg"
+          << "  , all packets avg, all packets avg, all packets avg, all packets avg"
+          << "  , all packets avg, all packets avg, all packets avg, all packets avg"
           << std::endl;
     }
   else
@@ -143,7 +148,11 @@ RoutingExperiment::WriteToSummaryFile (RunSummary srs)
       << srs.aaf.e2eDelayMax * 1000.0 << "," << srs.aap.e2eDelayMax * 1000.0 << ","
       << srs.aaf.e2eDelayAverage * 1000.0 << "," << srs.aap.e2eDelayAverage * 1000.0 << ","
       << srs.aaf.e2eDelayMedianEstinate * 1000.0 << "," << srs.aap.e2eDelayMedianEstinate * 1000.0 << ","
-      << srs.aaf.e2eDelayJitter * 1000.0 << "," << srs.aap.e2eDelayJitter * 1000.0
+      << srs.aaf.e2eDelayJitter * 1000.0 << "," << srs.aap.e2eDelayJitter * 1000.0 << ","
+      << srs.aap.phyTxAirtime << "," << srs.aap.lppTxPkts << ","
+      << srs.aap.lppSavedPkts << "," << srs.aap.lppSavedAirtime << ","
+      << srs.aap.routeDiscoveries << "," << srs.aap.routeDiscoverySuccess << ","
+      << srs.aap.routeDiscoveryLatencyAverage * 1000.0 << "," << srs.aap.routeDiscoveryTxPkts
       << std::endl;
   if (m_rngRun == m_stopRngRun)
     {
@@ -176,7 +185,15 @@ RoutingExperiment::WriteToSummaryFile (RunSummary srs)
                     << "=MIN(Y3:Y" << m_stopRngRun - m_startRngRun + 3 << "),"
                     << "=MIN(Z3:Z" << m_stopRngRun - m_startRngRun + 3 << "),"
                     << "=MIN(AA3:AA" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << ")"
+                    << "=MIN(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MIN(AC3:AC" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MIN(AD3:AD" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MIN(AE3:AE" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MIN(AF3:AF" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MIN(AG3:AG" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MIN(AH3:AH" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MIN(AI3:AI" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MIN(AJ3:AJ" << m_stopRngRun - m_startRngRun + 3 << ")"
                     << std::endl;
       out << "," << "Max,"
                     << "=MAX(C3:C" << m_stopRngRun - m_startRngRun + 3 << "),"
@@ -206,7 +223,15 @@ RoutingExperiment::WriteToSummaryFile (RunSummary srs)
                     << "=MAX(Y3:Y" << m_stopRngRun - m_startRngRun + 3 << "),"
                     << "=MAX(Z3:Z" << m_stopRngRun - m_startRngRun + 3 << "),"
                     << "=MAX(AA3:AA" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << ")"
+                    << "=MAX(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MAX(AC3:AC" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MAX(AD3:AD" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MAX(AE3:AE" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MAX(AF3:AF" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MAX(AG3:AG" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MAX(AH3:AH" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MAX(AI3:AI" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MAX(AJ3:AJ" << m_stopRngRun - m_startRngRun + 3 << ")"
                     << std::endl;
       out << "," << "Average,"
                     << "=AVERAGE(C3:C" << m_stopRngRun - m_startRngRun + 3 << "),"
@@ -236,7 +261,15 @@ RoutingExperiment::WriteToSummaryFile (RunSummary srs)
                     << "=AVERAGE(Y3:Y" << m_stopRngRun - m_startRngRun + 3 << "),"
                     << "=AVERAGE(Z3:Z" << m_stopRngRun - m_startRngRun + 3 << "),"
                     << "=AVERAGE(AA3:AA" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << ")"
+                    << "=AVERAGE(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=AVERAGE(AC3:AC" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=AVERAGE(AD3:AD" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=AVERAGE(AE3:AE" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=AVERAGE(AF3:AF" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=AVERAGE(AG3:AG" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=AVERAGE(AH3:AH" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=AVERAGE(AI3:AI" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=AVERAGE(AJ3:AJ" << m_stopRngRun - m_startRngRun + 3 << ")"
                     << std::endl;
       out << "," << "Median,"
                     << "=MEDIAN(C3:C" << m_stopRngRun - m_startRngRun + 3 << "),"
@@ -266,7 +299,15 @@ RoutingExperiment::WriteToSummaryFile (RunSummary srs)
                     << "=MEDIAN(Y3:Y" << m_stopRngRun - m_startRngRun + 3 << "),"
                     << "=MEDIAN(Z3:Z" << m_stopRngRun - m_startRngRun + 3 << "),"
                     << "=MEDIAN(AA3:AA" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << ")"
+                    << "=MEDIAN(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MEDIAN(AC3:AC" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MEDIAN(AD3:AD" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MEDIAN(AE3:AE" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MEDIAN(AF3:AF" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MEDIAN(AG3:AG" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MEDIAN(AH3:AH" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MEDIAN(AI3:AI" << m_stopRngRun - m_startRngRun + 3 << "),"
+                    << "=MEDIAN(AJ3:AJ" << m_stopRngRun - m_startRngRun + 3 << ")"
                     << std::endl;
       out << "," << "Std. deviation,"
                     << "=STDEV(C3:C" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
@@ -296,7 +337,15 @@ RoutingExperiment::WriteToSummaryFile (RunSummary srs)
                     << "=STDEV(Y3:Y" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
                     << "=STDEV(Z3:Z" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
                     << "=STDEV(AA3:AA" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << ")"
+                    << "=STDEV(AB3:AB" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
+                    << "=STDEV(AC3:AC" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
+                    << "=STDEV(AD3:AD" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
+                    << "=STDEV(AE3:AE" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
+                    << "=STDEV(AF3:AF" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
+                    << "=STDEV(AG3:AG" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
+                    << "=STDEV(AH3:AH" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
+                    << "=STDEV(AI3:AI" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
+                    << "=STDEV(AJ3:AJ" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << ")"
                     << std::endl;
     }
   out.close ();
@@ -338,6 +387,18 @@ RoutingExperiment::Run (int argc, char **argv)
   int scenario = 1; // ManhattanGrid
   uint32_t routingProtocol = 4; ///< routing protocol, DSR default
   std::string routingProtocolName = ""; // name not specified
+  std::string metric = ""; // AODV link metric, module default if not specified
+  bool adaptiveLpp = false; // AODV LPP interval adapted to changes in the neighborhood
+  bool lppPiggyback = false; // AODV LPP piggybacked on broadcast AODV messages
+  bool deltaLpp = false; // AODV LPP with only changed neighbor counts
+  double rreqHoldDown = 0.0; // [s] AODV RREQ forwarding hold-down, 0 - disabled
+  double rerrWindow = 0.0; // [s] AODV RERR aggregation window, 0 - disabled
+  bool localRepair = false; // AODV local repair of broken routes by intermediate nodes
+  uint32_t multipath = 1; // AODV routes per destination, the best one and backups, 1 - disabled
+  bool routeCache = false; // AODV cache of routes from RREPs, with RREQ replies by intermediate nodes
+  bool routeHistory = false; // AODV first RREQ ring seeded by the last discovered hop count
+  bool controlScheduler = false; // AODV jittered control packets sent through one priority queue
+  bool compactLpp = false; // AODV LPP neighbor list in compact encoding
   int routingTables = 0; ///< routing tables
 
   CommandLine cmd;
@@ -366,9 +427,40 @@ RoutingExperiment::Run (int argc, char **argv)
   cmd.AddValue ("routingTables", "Dump routing tables at t=5 seconds", routingTables);
   cmd.AddValue ("routingProtocol", "1=OLSR;2=AODV;3=DSDV;4=DSR", routingProtocol);
   cmd.AddValue ("routingProtocolName", "Name of the routing protocol used for creating file name for storing results", routingProtocolName);
+  cmd.AddValue ("metric", "AODV link metric: HopCount, Etx, LightEtx, LightReverseEtx or PowerLightReverseEtx. "
+                "Comma separated list assigns metrics to nodes in turn (node i gets metric i % list size)", metric);
+  cmd.AddValue ("adaptiveLpp", "Adapt AODV LPP interval to the rate of changes in the neighborhood", adaptiveLpp);
+  cmd.AddValue ("lppPiggyback", "Piggyback AODV LPP on broadcast RREQ, RERR and HELLO messages", lppPiggyback);
+  cmd.AddValue ("deltaLpp", "Send only changed neighbor counts in AODV LPP, with periodic full list", deltaLpp);
+  cmd.AddValue ("rreqHoldDown", "Maximal AODV RREQ forwarding hold-down in seconds, only the best RREQ copy is forwarded (0 - disabled)", rreqHoldDown);
+  cmd.AddValue ("rerrWindow", "AODV RERR aggregation window in seconds, unreachable destinations are merged into one RERR (0 - disabled)", rerrWindow);
+  cmd.AddValue ("localRepair", "Repair broken AODV routes by one-hop detour or TTL-limited RREQ before sending RERR", localRepair);
+  cmd.AddValue ("multipath", "Maximal number of AODV routes per destination, the best one and backup routes ranked by ETX (1 - disabled)", multipath);
+  cmd.AddValue ("routeCache", "Cache AODV routes from forwarded RREPs and reply to RREQs from the cache (also clears DestinationOnly)", routeCache);
+  cmd.AddValue ("routeHistory", "Start AODV expanding ring search just above the last discovered hop count to the destination", routeHistory);
+  cmd.AddValue ("compactLpp", "Send AODV LPP neighbor list in compact encoding (ETX modules with neighbor list)", compactLpp);
+  cmd.AddValue ("controlScheduler", "Send jittered AODV control packets through one priority queue (RERR > HELLO > RREQ > LPP) drained by a single timer", controlScheduler);
   
   cmd.Parse (argc, argv);
 
+  // AODV metrics, one or more
+  std::vector<std::string> metrics;
+  std::stringstream metricStream (metric);
+  std::string metricName;
+  while (std::getline (metricStream, metricName, ','))
+    {
+      if (metricName != "")
+        {
+          metrics.push_back (metricName);
+        }
+    }
+#ifndef AODV_MULTI_METRIC
+  if (!metrics.empty ())
+    {
+      NS_FATAL_ERROR ("Option --metric needs the aodv-multi-metric module in src/aodv");
+    }
+#endif
+
   // Should be placed after cmd.Parse () because user can overload rng run number with command line option "--currentRngRun"
   RngSeedManager::SetRun (m_rngRun);
 
@@ -585,6 +677,68 @@ RoutingExperiment::Run (int argc, char **argv)
   //---------------------------------------------
   AodvHelper aodv;
   aodv.Set ("EnableHello", BooleanValue (false)); // disable hello packets to prevent large overheads
+  // Compact LPP is in aodv-etx, aodv-light-etx and aodv-multi-metric modules
+  if (compactLpp && !Config::SetDefaultFailSafe ("ns3::aodv::RoutingProtocol::EnableCompactLpp", BooleanValue (true)))
+    {
+      NS_FATAL_ERROR ("AODV module has no compact LPP");
+    }
+#ifdef AODV_MULTI_METRIC
+  // Attributes of the multi-metric module are set only if the option is given,
+  // the per-metric modules don't have them
+  if (adaptiveLpp)
+    {
+      aodv.Set ("EnableAdaptiveLpp", BooleanValue (true));
+    }
+  if (lppPiggyback)
+    {
+      aodv.Set ("EnableLppPiggyback", BooleanValue (true));
+    }
+  if (deltaLpp)
+    {
+      aodv.Set ("EnableDeltaLpp", BooleanValue (true));
+    }
+  if (rreqHoldDown > 0)
+    {
+      aodv.Set ("RreqHoldDown", TimeValue (Seconds (rreqHoldDown)));
+    }
+  if (rerrWindow > 0)
+    {
+      aodv.Set ("RerrAggregationWindow", TimeValue (Seconds (rerrWindow)));
+    }
+  if (localRepair)
+    {
+      aodv.Set ("EnableLocalRepair", BooleanValue (true));
+    }
+  if (multipath > 1)
+    {
+      aodv.Set ("MultipathRoutes", UintegerValue (multipath));
+    }
+  if (routeCache)
+    {
+      aodv.Set ("EnableRouteCache", BooleanValue (true));
+      aodv.Set ("DestinationOnly", BooleanValue (false));
+    }
+  if (routeHistory)
+    {
+      aodv.Set ("EnableRouteHistory", BooleanValue (true));
+    }
+  if (controlScheduler)
+    {
+      aodv.Set ("EnableControlScheduler", BooleanValue (true));
+    }
+#else
+  if (adaptiveLpp || lppPiggyback || deltaLpp || rreqHoldDown > 0 || rerrWindow > 0 || localRepair
+      || multipath > 1 || routeCache || routeHistory || controlScheduler)
+    {
+      NS_FATAL_ERROR ("AODV options of added protocol features need the aodv-multi-metric module in src/aodv");
+    }
+#endif
+#ifdef AODV_MULTI_METRIC
+  if (metrics.size () == 1)
+    {
+      aodv.SetMetric (metrics[0]);
+    }
+#endif
   OlsrHelper olsr;
   DsdvHelper dsdv;
   DsrHelper dsr;
@@ -626,6 +780,50 @@ RoutingExperiment::Run (int argc, char **argv)
       if (routingProtocolName == "")
         {
           protocolName = "AODV";
+          for (uint32_t i = 0; i < metrics.size (); ++i)
+            {
+              protocolName += "-" + metrics[i];
+            }
+          if (adaptiveLpp)
+            {
+              protocolName += "-AdaptiveLpp";
+            }
+          if (lppPiggyback)
+            {
+              protocolName += "-LppPiggyback";
+            }
+          if (deltaLpp)
+            {
+              protocolName += "-DeltaLpp";
+            }
+          if (rreqHoldDown > 0)
+            {
+              protocolName += "-RreqHoldDown";
+            }
+          if (rerrWindow > 0)
+            {
+              protocolName += "-RerrWindow";
+            }
+          if (localRepair)
+            {
+              protocolName += "-LocalRepair";
+            }
+          if (multipath > 1)
+            {
+              protocolName += "-Multipath";
+            }
+          if (routeCache)
+            {
+              protocolName += "-RouteCache";
+            }
+          if (routeHistory)
+            {
+              protocolName += "-RouteHistory";
+            }
+          if (controlScheduler)
+            {
+              protocolName += "-ControlScheduler";
+            }
         }
       else
         {
@@ -663,7 +861,22 @@ RoutingExperiment::Run (int argc, char **argv)
       break;
     }
 
-  if (routingProtocol < 4)
+  if (routingProtocol == 2 && metrics.size () > 1)
+    {
+      // Different AODV metric on each node, every node gets its own routing helper
+      for (uint32_t i = 0; i < vehicles.GetN (); ++i)
+        {
+          AodvHelper nodeAodv = aodv;
+#ifdef AODV_MULTI_METRIC
+          nodeAodv.SetMetric (metrics[i % metrics.size ()]);
+#endif
+          Ipv4ListRoutingHelper nodeList;
+          nodeList.Add (nodeAodv, 100);
+          internet.SetRoutingHelper (nodeList);
+          internet.Install (vehicles.Get (i));
+        }
+    }
+  else if (routingProtocol < 4)
     {
       internet.SetRoutingHelper (list);
       internet.Install (vehicles);
@@ -24,6 +24,7 @@
 #include "ns3/simulator.h"
 #include <cmath>
 #include <stdint.h>
+#include <algorithm>
 
 namespace ns3
 {
@@ -33,7 +34,47 @@ NS_LOG_COMPONENT_DEFINE ("AodvNeighborEtx");
 namespace aodv
 {
 
-NeighborEtx::NeighborEtx () : m_lppTimeStamp (0) {}
+// Number of set bits in the lpp map. Compiles to a single instruction where
+// the target has hardware popcount.
+static inline uint8_t
+PopCount16 (uint16_t map)
+{
+#if defined (__GNUC__)
+  return (uint8_t) __builtin_popcount (map);
+#else
+  uint8_t cnt = 0;
+  for (; map != 0; map &= (uint16_t)(map - 1))
+    {
+      ++cnt;
+    }
+  return cnt;
+#endif
+}
+
+// ETX depends only on the product of both lpp counts, which is at most 10*10,
+// so all regular values are calculated once
+struct EtxTable
+{
+  uint32_t m_etx[101];
+  EtxTable ()
+  {
+    m_etx[0] = NeighborEtx::EtxMaxValue ();
+    for (uint16_t product = 1; product <= 100; ++product)
+      {
+        // 10^4 * 10 * 10 = 10^6, etx is multiplied by 10^4 to obtain resolution of 4 decimal places.
+        // But both lpp counts should be divided by 10 to obtain probability of packet delivery,
+        // so therefore we have to multiply by 10^6.
+        m_etx[product] = (uint32_t) (round (1000000.0 / product));
+      }
+  }
+};
+static const EtxTable g_etxTable;
+
+NeighborEtx::NeighborEtx ()
+  : m_lppTimeStamp (0),
+    m_lppCntMask (CalculateLppCntMask (0))
+{
+}
 
 // ETX time stamp has 12 different values: 0, 1, 2, ..., 11, 0, 1, ...
 // The values of time stamp changes cyclicly but 2 values are not included
@@ -50,12 +91,6 @@ NeighborEtx::CalculateNextLppTimeStamp (uint8_t currTimeStamp)
   return nextTimeStamp;
 }
 
-void
-NeighborEtx::GotoNextLppTimeStamp ()
-{
-  m_lppTimeStamp = CalculateNextLppTimeStamp (m_lppTimeStamp);
-}
-
 // ETX time stamp has 12 different values: 0, 1, 2, ..., 11, 0, 1, ...
 // but 2 values are not included in etx (lpp count):
 // 1. current time stamp, because of jitter introduced in sending lpp packets some nodes 
@@ -64,20 +99,44 @@ NeighborEtx::GotoNextLppTimeStamp ()
 //    would be having higher lpp count by 1)
 // 2. next time stamp, which is the oldest time stamp and will be cleared to prepare for
 //    the next cycle, so it should not be included in calculation of current lpp count.
+// The mask of remaining 10 time stamps changes only when time stamp changes.
+uint16_t
+NeighborEtx::CalculateLppCntMask (uint8_t currTimeStamp)
+{
+  uint16_t excluded = ((uint16_t)0x0001 << currTimeStamp)
+    | ((uint16_t)0x0001 << CalculateNextLppTimeStamp (currTimeStamp)); // bug fixed thanks to Oscar Bautista
+  return (uint16_t)(~excluded & (uint16_t)0x0FFF);
+}
+
+void
+NeighborEtx::GotoNextLppTimeStamp ()
+{
+  m_lppTimeStamp = CalculateNextLppTimeStamp (m_lppTimeStamp);
+  m_lppCntMask = CalculateLppCntMask (m_lppTimeStamp);
+}
 
 uint8_t 
 NeighborEtx::Lpp10bMapToCnt (uint16_t lpp10bMap) const
 {
-  uint8_t lpp = 0;
-  for (int j=0; j<12; ++j)
+  return PopCount16 (lpp10bMap & m_lppCntMask);
+}
+
+std::size_t
+NeighborEtx::FindNeighbor (Ipv4Address addr) const
+{
+  std::vector<Ipv4Address>::const_iterator i = std::lower_bound (m_address.begin (), m_address.end (), addr);
+  if (i != m_address.end () && *i == addr)
     {
-      if ((j!=m_lppTimeStamp) && 
-          (j!=CalculateNextLppTimeStamp(m_lppTimeStamp))) // bug fixed thanks to Oscar Bautista
-        {
-          lpp += (lpp10bMap & ((uint16_t)0x0001 << j)) ? 1 : 0;
-        }
+      return i - m_address.begin ();
     }
-  return lpp;
+  return m_address.size ();
+}
+
+void
+NeighborEtx::UpdateCachedEtx (std::size_t i)
+{
+  m_lppMyCnt[i] = Lpp10bMapToCnt (m_lppMyCnt10bMap[i]);
+  m_etx[i] = CalculateBinaryShiftedEtx (m_lppMyCnt[i], m_lppForward[i]);
 }
 
 // This function prepare for the next time stamp.
@@ -85,47 +144,74 @@ NeighborEtx::Lpp10bMapToCnt (uint16_t lpp10bMap) const
 // The oldest (next, 12th) field is necessary for synchronization. Since delivery of LPPs
 // is not guaranteed we have to clear oldest field when we send next LPP packet and this field
 // is not used in calculation of ETX.
+// All neighbors are processed in one pass, array by array: the bitmaps and lpp counts first
+// and then the cached ETX values.
 void
 NeighborEtx::GotoNextTimeStampAndClearOldest ()
 {
   GotoNextLppTimeStamp (); // go to  next time stamp which becomes current time stamp
-  // Clear oldest time stamp lpp count values, this is next time stamp compared to current
-  //NS_LOG_UNCOND ("ETX: " << Simulator::Now ().GetSeconds () << ", " << (uint16_t)m_lppTimeStamp << ", " << (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_lppTimeStamp))));
-  for (std::map<Ipv4Address, Etx>::iterator i = m_neighborEtx.begin (); i != m_neighborEtx.end (); )
+  // Delete oldest time stamp lpp count (this is next time stamp compared to current)
+  // Only lower 12 bits are used
+  const uint16_t clearOldestMask = (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_lppTimeStamp)) & (uint16_t)0x0FFF);
+  const uint16_t cntMask = m_lppCntMask;
+  const std::size_t n = m_address.size ();
+  uint16_t *map = m_lppMyCnt10bMap.data ();
+  uint8_t *cnt = m_lppMyCnt.data ();
+  bool formerNeighbors = false;
+  for (std::size_t i = 0; i < n; ++i)
     {
-      Etx etx = i->second;
-      uint16_t lppMyCnt10bMap = etx.m_lppMyCnt10bMap;
-      // Delete oldest time stamp lpp count (this is next time stamp compared to current)
-      // Only lower 12 bits are used
-      lppMyCnt10bMap &= (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_lppTimeStamp)) & (uint16_t)0x0FFF);
-      etx.m_lppMyCnt10bMap = lppMyCnt10bMap;
-      i->second = etx;
-      // Clear former neighbors from the list.
-      // These nodes are recognized based on m_lppMyCnt10bMap value.
-      // If this value is 0, then this node did not receive any LPP from former neighbor node (entry for iterator i),
-      // so it is obvious that neighbor node i is no longer a neighbor and should be deleted from
-      // the list to release memory.
-      if ((i->second.m_lppMyCnt10bMap & (uint16_t)0x0FFF) == 0) // not neighbors any more (no LPPs received lately)
-        {
-          i = m_neighborEtx.erase (i);
-        }
-      else // still neighbors, so just continue...
+      map[i] &= clearOldestMask;
+      cnt[i] = PopCount16 (map[i] & cntMask);
+      formerNeighbors |= (map[i] == 0);
+    }
+  uint32_t *etx = m_etx.data ();
+  const uint8_t *fwd = m_lppForward.data ();
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      etx[i] = CalculateBinaryShiftedEtx (cnt[i], fwd[i]);
+    }
+  if (formerNeighbors)
+    {
+      EraseFormerNeighbors ();
+    }
+}
+
+// Clear former neighbors from the list.
+// These nodes are recognized based on m_lppMyCnt10bMap value.
+// If this value is 0, then this node did not receive any LPP from former neighbor node,
+// so it is obvious that the node is no longer a neighbor and should be deleted from
+// the list to release memory. Remaining entries are compacted in place, so the order is kept.
+void
+NeighborEtx::EraseFormerNeighbors ()
+{
+  std::size_t last = 0;
+  for (std::size_t i = 0; i < m_address.size (); ++i)
+    {
+      if (m_lppMyCnt10bMap[i] != 0)
         {
-          i++;
+          m_address[last] = m_address[i];
+          m_lppMyCnt10bMap[last] = m_lppMyCnt10bMap[i];
+          m_lppForward[last] = m_lppForward[i];
+          m_lppMyCnt[last] = m_lppMyCnt[i];
+          m_etx[last] = m_etx[i];
+          ++last;
         }
     }
+  m_address.resize (last);
+  m_lppMyCnt10bMap.resize (last);
+  m_lppForward.resize (last);
+  m_lppMyCnt.resize (last);
+  m_etx.resize (last);
 }
 
 void
 NeighborEtx::FillLppCntData (LppHeader &lppHeader)
 {
-  for (std::map<Ipv4Address, Etx>::const_iterator i = m_neighborEtx.begin (); i != m_neighborEtx.end (); ++i)
+  for (std::size_t i = 0; i < m_address.size (); ++i)
     {
-      uint8_t lpp = Lpp10bMapToCnt (i->second.m_lppMyCnt10bMap);
-      if (lpp > 0)
+      if (m_lppMyCnt[i] > 0)
         {
-          lppHeader.AddToNeighborsList (i->first, lpp);
-          //NS_LOG_UNCOND ("           IP=" << i->first << ", lpp=" << (uint16_t)lpp << ", rev=" << (uint16_t)(i->second.m_lppForward) << ", ETX-bin-shift=" << CalculateBinaryShiftedEtx (i->second));
+          lppHeader.AddToNeighborsList (m_address[i], m_lppMyCnt[i]);
         }
     }
 }
@@ -134,56 +220,55 @@ NeighborEtx::FillLppCntData (LppHeader &lppHeader)
 bool 
 NeighborEtx::UpdateNeighborEtx (Ipv4Address addr, uint8_t lppTimeStamp, uint8_t lppForward)
 {
-  std::map<Ipv4Address, Etx>::iterator i = m_neighborEtx.find (addr);
-  if (i == m_neighborEtx.end ())
+  std::vector<Ipv4Address>::iterator pos = std::lower_bound (m_address.begin (), m_address.end (), addr);
+  std::size_t i = pos - m_address.begin ();
+  if (pos == m_address.end () || !(*pos == addr))
     {
       // No address, insert new entry
-      Etx etx;
-      etx.m_lppForward = lppForward;
-      etx.m_lppMyCnt10bMap = (uint16_t)0x0001 << lppTimeStamp;
-      std::pair<std::map<Ipv4Address, Etx>::iterator, bool> result = m_neighborEtx.insert (std::make_pair (addr, etx));
-      return result.second;
+      m_address.insert (pos, addr);
+      m_lppMyCnt10bMap.insert (m_lppMyCnt10bMap.begin () + i, (uint16_t)0x0001 << lppTimeStamp);
+      m_lppForward.insert (m_lppForward.begin () + i, lppForward);
+      m_lppMyCnt.insert (m_lppMyCnt.begin () + i, 0);
+      m_etx.insert (m_etx.begin () + i, EtxMaxValue ());
+      UpdateCachedEtx (i);
+      return true;
     }
   else
     {
       // Address found, update existing entry
-      i->second.m_lppForward = lppForward;
-      (i->second.m_lppMyCnt10bMap) |= ((uint16_t)0x0001 << lppTimeStamp);
+      uint16_t lppMyCnt10bMap = m_lppMyCnt10bMap[i] | ((uint16_t)0x0001 << lppTimeStamp);
+      if (lppMyCnt10bMap != m_lppMyCnt10bMap[i] || lppForward != m_lppForward[i])
+        {
+          m_lppForward[i] = lppForward;
+          m_lppMyCnt10bMap[i] = lppMyCnt10bMap;
+          UpdateCachedEtx (i);
+        }
       return true;
     }
 }
 
 uint32_t 
-NeighborEtx::CalculateBinaryShiftedEtx (Etx etxStruct) const
+NeighborEtx::CalculateBinaryShiftedEtx (uint8_t lppMyCnt, uint8_t lppForward) const
 {
-  uint32_t etx = EtxMaxValue ();
-  if ((Lpp10bMapToCnt (etxStruct.m_lppMyCnt10bMap)!=0) && (etxStruct.m_lppForward!=0))
+  uint16_t product = (uint16_t)lppMyCnt * lppForward; // 0 if any of the counts is 0
+  if (product <= 100)
     {
-      // 10^4 * 10 * 10 = 10^6, etx is multiplied by 10^4 to obtain resolution of 4 decimal places.
-      // But both lpp counts should be divided by 10 to obtain probability of packet delivery,
-      // so therefore we have to multiply by 10^6.
-      etx = (uint32_t) (round (1000000.0 / (Lpp10bMapToCnt (etxStruct.m_lppMyCnt10bMap) * etxStruct.m_lppForward)));
+      return g_etxTable.m_etx[product];
     }
-  //NS_LOG_UNCOND ("ETX binary: " << etx);
-  return etx;
+  return (uint32_t) (round (1000000.0 / product));
 }
 
 uint32_t 
 NeighborEtx::GetEtxForNeighbor (Ipv4Address addr) const
 {
-  uint32_t etx;
-  std::map<Ipv4Address, Etx>::const_iterator i = m_neighborEtx.find (addr);
-  if (i == m_neighborEtx.end ())
+  std::size_t i = FindNeighbor (addr);
+  if (i == m_address.size ())
     {
       // No address, ETX -> oo (ETX max value)
-      etx = EtxMaxValue ();
-      return etx;
-    }
-  else
-    {
-      // Address found, calculate and return current ETX value
-      return CalculateBinaryShiftedEtx (i->second);
+      return EtxMaxValue ();
     }
+  // Address found, return cached ETX value
+  return m_etx[i];
 }
 
 } // namespace aodv
@@ -28,9 +28,11 @@
  * Modified by: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtic@gmail.com>
  *              Marija Malnar <m.malnar@sf.bg.ac.rs>
  */
+#include <algorithm>
 #include "aodv-packet.h"
 #include "ns3/address-utils.h"
 #include "ns3/packet.h"
+#include "ns3/abort.h"
 
 namespace ns3 {
 namespace aodv {
@@ -699,7 +701,13 @@ operator<< (std::ostream & os, RerrHeader const & h )
 //-----------------------------------------------------------------------------
 // LPP
 //----------------------------------------------------------------------
-LppHeader::LppHeader () {}
+LppHeader::LppHeader ()
+  : m_lppId (0),
+    m_version (LPP_PLAIN),
+    m_originSeqno (0),
+    m_maxLppCnt (0)
+{
+}
 
 NS_OBJECT_ENSURE_REGISTERED (LppHeader);
 
@@ -720,43 +728,186 @@ LppHeader::GetInstanceTypeId () const
   return GetTypeId ();
 }
 
+uint8_t
+LppHeader::GetEncodingVersion () const
+{
+  // Plain encoding has 8 bit number of neighbors, so larger lists fall back to compact encoding
+  if ((m_version == LPP_COMPACT || GetNumberNeighbors () > 255) && m_maxLppCnt <= 0x0F)
+    {
+      return LPP_COMPACT;
+    }
+  return LPP_PLAIN;
+}
+
 uint32_t
 LppHeader::GetSerializedSize () const
 {
-  return (10 + 5 * GetNumberNeighbors ());
+  if (GetEncodingVersion () == LPP_PLAIN)
+    {
+      return (10 + 5 * GetNumberNeighbors ());
+    }
+  // 2B prefix and 2B number of neighbors per group, 2B suffix and half byte count per neighbor
+  uint32_t size = 11;
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j = m_neighborsLppCnt.begin ();
+  while (j != m_neighborsLppCnt.end ())
+    {
+      uint16_t prefix = (uint16_t)(j->first.Get () >> 16);
+      uint32_t m = 0;
+      for (; j != m_neighborsLppCnt.end () && (uint16_t)(j->first.Get () >> 16) == prefix; ++j)
+        {
+          ++m;
+        }
+      size += 4 + 2 * m + (m + 1) / 2;
+    }
+  return size;
 }
 
 void
 LppHeader::Serialize (Buffer::Iterator i ) const
 {
-  i.WriteU8 (m_lppId);
+  uint8_t version = GetEncodingVersion ();
+  i.WriteU8 ((uint8_t)(version << 4) | (m_lppId & 0x0F));
   WriteTo (i, m_originAddr);
   i.WriteHtonU32 (m_originSeqno);
-  i.WriteU8 (GetNumberNeighbors ());
-  std::map<Ipv4Address, uint8_t>::const_iterator j;
-  for (j = m_neighborsLppCnt.begin (); j != m_neighborsLppCnt.end (); ++j)
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j;
+  if (version == LPP_PLAIN)
     {
-      WriteTo (i, (*j).first);
-      i.WriteU8 ((*j).second);
+      NS_ABORT_MSG_IF (GetNumberNeighbors () > 255, "Can't support more than 2^8 - 1 neighbors in plain LPP");
+      i.WriteU8 ((uint8_t)GetNumberNeighbors ());
+      for (j = m_neighborsLppCnt.begin (); j != m_neighborsLppCnt.end (); ++j)
+        {
+          WriteTo (i, (*j).first);
+          i.WriteU8 ((*j).second);
+        }
+      return;
     }
+  i.WriteHtonU16 (GetNumberNeighbors ());
+  j = m_neighborsLppCnt.begin ();
+  while (j != m_neighborsLppCnt.end ())
+    {
+      // List is sorted, so neighbors with the same prefix are adjacent
+      uint16_t prefix = (uint16_t)(j->first.Get () >> 16);
+      std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator end = j;
+      uint16_t m = 0;
+      for (; end != m_neighborsLppCnt.end () && (uint16_t)(end->first.Get () >> 16) == prefix; ++end)
+        {
+          ++m;
+        }
+      i.WriteHtonU16 (prefix);
+      i.WriteHtonU16 (m);
+      for (std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator k = j; k != end; ++k)
+        {
+          i.WriteHtonU16 ((uint16_t)(k->first.Get () & 0xFFFF));
+        }
+      for (std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator k = j; k != end; )
+        {
+          uint8_t counts = (uint8_t)(k->second << 4);
+          if (++k != end)
+            {
+              counts |= k->second & 0x0F;
+              ++k;
+            }
+          i.WriteU8 (counts);
+        }
+      j = end;
+    }
+}
+
+/**
+ * \brief Compare addresses of two neighbor list entries
+ * \param a the first neighbor list entry
+ * \param b the second neighbor list entry
+ * \return true if address of a is less than address of b
+ */
+static bool
+NeighborLppCntAddressLess (const std::pair<Ipv4Address, uint8_t> & a, const std::pair<Ipv4Address, uint8_t> & b)
+{
+  return a.first < b.first;
+}
+
+/**
+ * \brief Check that two neighbor list entries have the same address
+ * \param a the first neighbor list entry
+ * \param b the second neighbor list entry
+ * \return true if the addresses are equal
+ */
+static bool
+NeighborLppCntAddressEqual (const std::pair<Ipv4Address, uint8_t> & a, const std::pair<Ipv4Address, uint8_t> & b)
+{
+  return a.first == b.first;
 }
 
 uint32_t
 LppHeader::Deserialize (Buffer::Iterator start )
 {
   Buffer::Iterator i = start;
-  m_lppId = i.ReadU8 ();
+  uint8_t idAndVersion = i.ReadU8 ();
+  m_lppId = idAndVersion & 0x0F;
+  m_version = idAndVersion >> 4;
   ReadFrom (i, m_originAddr);
   m_originSeqno = i.ReadNtohU32 ();
-  uint8_t numberNeighbors = i.ReadU8 ();
   m_neighborsLppCnt.clear ();
-  Ipv4Address neighborAddr;
-  uint8_t lppCnt;
-  for (uint8_t k = 0; k < numberNeighbors; ++k)
+  m_maxLppCnt = 0;
+  bool sorted = true;
+  if (m_version == LPP_PLAIN)
     {
-      ReadFrom (i, neighborAddr);
-      lppCnt = i.ReadU8 ();
-      m_neighborsLppCnt.insert (std::make_pair (neighborAddr, lppCnt));
+      uint8_t numberNeighbors = i.ReadU8 ();
+      m_neighborsLppCnt.reserve (numberNeighbors);
+      Ipv4Address neighborAddr;
+      uint8_t lppCnt;
+      for (uint8_t k = 0; k < numberNeighbors; ++k)
+        {
+          ReadFrom (i, neighborAddr);
+          lppCnt = i.ReadU8 ();
+          sorted = sorted && (m_neighborsLppCnt.empty () || m_neighborsLppCnt.back ().first < neighborAddr);
+          m_neighborsLppCnt.push_back (std::make_pair (neighborAddr, lppCnt));
+          m_maxLppCnt = std::max (m_maxLppCnt, lppCnt);
+        }
+    }
+  else
+    {
+      NS_ASSERT_MSG (m_version == LPP_COMPACT, "Unknown LPP version " << (uint16_t)m_version);
+      uint16_t numberNeighbors = i.ReadNtohU16 ();
+      m_neighborsLppCnt.reserve (numberNeighbors);
+      while (m_neighborsLppCnt.size () < numberNeighbors)
+        {
+          uint32_t prefix = (uint32_t)i.ReadNtohU16 () << 16;
+          uint16_t m = i.ReadNtohU16 ();
+          std::size_t first = m_neighborsLppCnt.size ();
+          for (uint16_t k = 0; k < m; ++k)
+            {
+              Ipv4Address neighborAddr (prefix | i.ReadNtohU16 ());
+              sorted = sorted && (m_neighborsLppCnt.empty () || m_neighborsLppCnt.back ().first < neighborAddr);
+              m_neighborsLppCnt.push_back (std::make_pair (neighborAddr, 0));
+            }
+          for (uint16_t k = 0; k < m; k += 2)
+            {
+              uint8_t counts = i.ReadU8 ();
+              m_neighborsLppCnt[first + k].second = counts >> 4;
+              if (k + 1 < m)
+                {
+                  m_neighborsLppCnt[first + k + 1].second = counts & 0x0F;
+                }
+              m_maxLppCnt = std::max (m_maxLppCnt, (uint8_t)std::max (counts >> 4, counts & 0x0F));
+            }
+          if (m == 0)
+            {
+              break; // malformed group, avoid endless loop
+            }
+        }
+    }
+  // Sender serializes sorted list, so sorting is needed only for foreign senders
+  if (!sorted)
+    {
+      // Like AddToNeighborsList, the first entry of a duplicated neighbor is kept
+      std::stable_sort (m_neighborsLppCnt.begin (), m_neighborsLppCnt.end (), NeighborLppCntAddressLess);
+      m_neighborsLppCnt.erase (std::unique (m_neighborsLppCnt.begin (), m_neighborsLppCnt.end (), NeighborLppCntAddressEqual),
+                               m_neighborsLppCnt.end ());
+      m_maxLppCnt = 0;
+      for (std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j = m_neighborsLppCnt.begin (); j != m_neighborsLppCnt.end (); ++j)
+        {
+          m_maxLppCnt = std::max (m_maxLppCnt, j->second);
+        }
     }
 
   uint32_t dist = i.GetDistanceFrom (start);
@@ -767,27 +918,46 @@ LppHeader::Deserialize (Buffer::Iterator start )
 void
 LppHeader::Print (std::ostream &os ) const
 {
-  os << "Lpp ID: " << m_lppId << "Originator IP address: " << m_originAddr;
+  os << "Lpp ID: " << m_lppId << "Version: " << (uint16_t)m_version << "Originator IP address: " << m_originAddr;
   os << "Originator Sequence number: " << m_originSeqno;
   os << "Number of neighbors: " <<  (*this).GetNumberNeighbors ();
   os << "Neighbors (ipv4 address, received LPP count): ";
-  std::map<Ipv4Address, uint8_t>::const_iterator j;
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j;
   for (j = m_neighborsLppCnt.begin (); j != m_neighborsLppCnt.end (); ++j)
     {
       os << (*j).first << ", " << (*j).second;
     }
 }
 
+/**
+ * \brief Compare neighbor list entry with IP address
+ * \param entry the neighbor list entry
+ * \param addr the IP address
+ * \return true if entry address is less than addr
+ */
+static bool
+NeighborLppCntLess (const std::pair<Ipv4Address, uint8_t> & entry, Ipv4Address addr)
+{
+  return entry.first < addr;
+}
+
 bool
 LppHeader::AddToNeighborsList (Ipv4Address neighbor, uint8_t lppCnt)
 {
-  if (m_neighborsLppCnt.find (neighbor) != m_neighborsLppCnt.end ())
+  // Neighbors are usually added in increasing order, so append is the common case
+  std::vector<std::pair<Ipv4Address, uint8_t> >::iterator i = m_neighborsLppCnt.end ();
+  if (!m_neighborsLppCnt.empty () && !(m_neighborsLppCnt.back ().first < neighbor))
   {
-     return true;
+    i = std::lower_bound (m_neighborsLppCnt.begin (), m_neighborsLppCnt.end (), neighbor, NeighborLppCntLess);
+    if (i->first == neighbor)
+    {
+      return true;
+    }
   }
 
-  NS_ASSERT_MSG (GetNumberNeighbors () < 255, "Can't support more than 2^8 - 1 neighbors");
-  m_neighborsLppCnt.insert (std::make_pair (neighbor, lppCnt));
+  NS_ASSERT_MSG (GetNumberNeighbors () < 65535, "Can't support more than 2^16 - 1 neighbors");
+  m_neighborsLppCnt.insert (i, std::make_pair (neighbor, lppCnt));
+  m_maxLppCnt = std::max (m_maxLppCnt, lppCnt);
   return true;
 }
 
@@ -799,16 +969,30 @@ LppHeader::RemoveFromNeighborsList (std::pair<Ipv4Address, uint8_t> & un )
     return false;
   }
 
-  std::map<Ipv4Address, uint8_t>::iterator i = m_neighborsLppCnt.begin ();
+  std::vector<std::pair<Ipv4Address, uint8_t> >::iterator i = m_neighborsLppCnt.begin ();
   un = *i;
   m_neighborsLppCnt.erase (i);
   return true;
 }
 
+bool
+LppHeader::FindNeighborLppCnt (Ipv4Address neighbor, uint8_t & lppCnt) const
+{
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator i =
+    std::lower_bound (m_neighborsLppCnt.begin (), m_neighborsLppCnt.end (), neighbor, NeighborLppCntLess);
+  if (i == m_neighborsLppCnt.end () || i->first != neighbor)
+  {
+    return false;
+  }
+  lppCnt = i->second;
+  return true;
+}
+
 void
 LppHeader::ClearNeighborsList ()
 {
   m_neighborsLppCnt.clear ();
+  m_maxLppCnt = 0;
 }
 
 bool
@@ -819,9 +1003,9 @@ LppHeader::operator== (LppHeader const & o ) const
     return false;
   }  
 
-  std::map<Ipv4Address, uint8_t>::const_iterator j = m_neighborsLppCnt.begin ();
-  std::map<Ipv4Address, uint8_t>::const_iterator k = o.m_neighborsLppCnt.begin ();
-  for (uint8_t i = 0; i < GetNumberNeighbors (); ++i)
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j = m_neighborsLppCnt.begin ();
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator k = o.m_neighborsLppCnt.begin ();
+  for (uint16_t i = 0; i < GetNumberNeighbors (); ++i)
     {
       if ((j->first != k->first) || (j->second != k->second))
       {
@@ -176,6 +176,7 @@ RoutingProtocol::RoutingProtocol ()
     m_rerrCount (0),
     m_enableEtx (true), /*etx*/
     m_lppInterval (Seconds (1)),
+    m_enableCompactLpp (false),
     m_lppTimer (Timer::CANCEL_ON_DESTROY),
     m_htimer (Timer::CANCEL_ON_DESTROY),
     m_rreqRateLimitTimer (Timer::CANCEL_ON_DESTROY),
@@ -311,6 +312,10 @@ RoutingProtocol::GetTypeId (void)
                    TimeValue (Seconds (1)),
                    MakeTimeAccessor (&RoutingProtocol::m_lppInterval),
                    MakeTimeChecker ())
+    .AddAttribute ("EnableCompactLpp", "Send neighbor list of LPP in compact encoding (version 1).", /*etx*/
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_enableCompactLpp),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Tx", "A new routing protocol packet is created and is sent", // trace
                      MakeTraceSourceAccessor (&RoutingProtocol::m_txTrace),
                      "ns3::Packet::TracedCallback")
@@ -1221,6 +1226,7 @@ void
 RoutingProtocol::UpdateRouteToNeighbor (Ipv4Address sender, Ipv4Address receiver)
 {
   NS_LOG_FUNCTION (this << "sender " << sender << " receiver " << receiver);
+  uint32_t etx = m_nbEtx.GetEtxForNeighbor (sender); // cached link ETX, looked up once
   RoutingTableEntry toNeighbor;
   if (!m_routingTable.LookupRoute (sender, toNeighbor))
     {
@@ -1228,7 +1234,7 @@ RoutingProtocol::UpdateRouteToNeighbor (Ipv4Address sender, Ipv4Address receiver
       RoutingTableEntry newEntry (/*device=*/ dev, /*dst=*/ sender, /*know seqno=*/ false, /*seqno=*/ 0,
                                   /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),
                                   /*hops=*/ 1, /*next hop=*/ sender, /*lifetime=*/ m_activeRouteTimeout,
-                                  /*etx=*/ m_nbEtx.GetEtxForNeighbor (sender));
+                                  /*etx=*/ etx);
       m_routingTable.AddRoute (newEntry);
     }
   else
@@ -1237,7 +1243,7 @@ RoutingProtocol::UpdateRouteToNeighbor (Ipv4Address sender, Ipv4Address receiver
       if (toNeighbor.GetValidSeqNo () && (toNeighbor.GetHop () == 1) && (toNeighbor.GetOutputDevice () == dev))
         {
           toNeighbor.SetLifeTime (std::max (m_activeRouteTimeout, toNeighbor.GetLifeTime ()));
-          toNeighbor.SetEtx (m_nbEtx.GetEtxForNeighbor (sender));
+          toNeighbor.SetEtx (etx);
           m_routingTable.Update (toNeighbor); // this was missing in original AODV implementation
         }
       else
@@ -1246,7 +1252,7 @@ RoutingProtocol::UpdateRouteToNeighbor (Ipv4Address sender, Ipv4Address receiver
                                       /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),
                                       /*hops=*/ 1, /*next hop=*/ sender,
                                       /*lifetime=*/ std::max (m_activeRouteTimeout, toNeighbor.GetLifeTime ()),
-                                      /*etx=*/ m_nbEtx.GetEtxForNeighbor (sender));
+                                      /*etx=*/ etx);
           m_routingTable.Update (newEntry);
         }
     }
@@ -1264,24 +1270,15 @@ RoutingProtocol::RecvLpp (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
   Ipv4Address origin = lppHeader.GetOriginAddress ();
   NS_ASSERT (origin == src); // Neighbor from which the packet is received is always originator of LPP packet
   uint8_t lppTimeStamp = lppHeader.GetLppId ();
-  uint16_t numNeighbors = lppHeader.GetNumberNeighbors ();
-  std::pair<Ipv4Address, uint8_t> un;
 
   // Search for my IP address in LPP packet header
   uint8_t lppForward = 0; // if there is no my address in the packet header lpp forward should be 0
-  for (uint16_t j=0; j<numNeighbors; ++j)
-    {
-      lppHeader.RemoveFromNeighborsList (un);
-      if (un.first == receiver) // is it my IP address?
-        {
-          lppForward = un.second;
-          break;
-        }
-    }
+  lppHeader.FindNeighborLppCnt (receiver, lppForward);
   // Add new or update existing etx entry for neighbor with IP address "src".
   // LPP count is updated based on lppTime stamp received in packet header.
   // LPP forward count is updated from list provided in LPP packet header.
   m_nbEtx.UpdateNeighborEtx (src, lppTimeStamp, lppForward); /*etx*/
+  uint32_t etx = m_nbEtx.GetEtxForNeighbor (src); /*etx*/
   // Since ETX is changed we should update route entry for neighbor
   // LPP is used as HELLO so it should be updated as if HELLO message is received
   // We use LPP as HELLO message, so we do the same as in ProcessHello (), but with ETX metric
@@ -1294,7 +1291,7 @@ RoutingProtocol::RecvLpp (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
                                   /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),
                                   /*hop=*/ 1, /*nextHop=*/ src,
                                   /*lifeTime=*/ Time (m_allowedHelloLoss * m_helloInterval),
-                                  /*etx*/ m_nbEtx.GetEtxForNeighbor (src));
+                                  /*etx*/ etx);
       m_routingTable.AddRoute (newEntry);
     }
   else
@@ -1307,7 +1304,7 @@ RoutingProtocol::RecvLpp (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
       toNeighbor.SetInterface (m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0));
       toNeighbor.SetHop (1);
       toNeighbor.SetNextHop (src);
-      toNeighbor.SetEtx (m_nbEtx.GetEtxForNeighbor (src)); /*etx*/
+      toNeighbor.SetEtx (etx); /*etx*/
       m_routingTable.Update (toNeighbor);
     }
 
@@ -2078,6 +2075,7 @@ RoutingProtocol::SendLpp ()
       LppHeader lppHeader;
       //set fields of LPP header
       lppHeader.SetLppId (m_nbEtx.GetLppTimeStamp ());
+      lppHeader.SetVersion (m_enableCompactLpp ? LppHeader::LPP_COMPACT : LppHeader::LPP_PLAIN);
       lppHeader.SetOriginAddress (iface.GetLocal ());
       lppHeader.SetOriginSeqno (m_seqNo);
       //NS_LOG_DEBUG ("LPP send: time=" << Simulator::Now ().GetSeconds () << " s, " << "source=" << iface.GetLocal ());
@@ -37,7 +37,8 @@ NS_LOG_COMPONENT_DEFINE ("AodvNeighbors");
 
 namespace aodv {
 Neighbors::Neighbors (Time delay)
-  : m_ntimer (Timer::CANCEL_ON_DESTROY)
+  : m_ntimer (Timer::CANCEL_ON_DESTROY),
+    m_lastArpHit (0)
 {
   m_ntimer.SetDelay (delay);
   m_ntimer.SetFunction (&Neighbors::Purge, this);
@@ -47,29 +48,19 @@ Neighbors::Neighbors (Time delay)
 bool
 Neighbors::IsNeighbor (Ipv4Address addr)
 {
-  Purge ();
-  for (std::vector<Neighbor>::const_iterator i = m_nb.begin ();
-       i != m_nb.end (); ++i)
-    {
-      if (i->m_neighborAddress == addr)
-        {
-          return true;
-        }
-    }
-  return false;
+  std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::const_iterator i = m_nb.find (addr);
+  return (i != m_nb.end () && !i->second.close
+          && i->second.m_expireTime >= Simulator::Now ());
 }
 
 Time
 Neighbors::GetExpireTime (Ipv4Address addr)
 {
-  Purge ();
-  for (std::vector<Neighbor>::const_iterator i = m_nb.begin (); i
-       != m_nb.end (); ++i)
+  std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::const_iterator i = m_nb.find (addr);
+  if (i != m_nb.end () && !i->second.close
+      && i->second.m_expireTime >= Simulator::Now ())
     {
-      if (i->m_neighborAddress == addr)
-        {
-          return (i->m_expireTime - Simulator::Now ());
-        }
+      return (i->second.m_expireTime - Simulator::Now ());
     }
   return Seconds (0);
 }
@@ -77,73 +68,67 @@ Neighbors::GetExpireTime (Ipv4Address addr)
 void
 Neighbors::Update (Ipv4Address addr, Time expire)
 {
-  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+  std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i = m_nb.find (addr);
+  if (i != m_nb.end ())
     {
-      if (i->m_neighborAddress == addr)
+      Neighbor & nb = i->second;
+      if (expire + Simulator::Now () > nb.m_expireTime)
         {
-          i->m_expireTime
-            = std::max (expire + Simulator::Now (), i->m_expireTime);
-          if (i->m_hardwareAddress == Mac48Address ())
-            {
-              i->m_hardwareAddress = LookupMacAddress (i->m_neighborAddress);
-            }
-          return;
+          // Extending the expire time of the earliest entry moves the earliest one later,
+          // but the timer is not rescheduled here: it may fire early, then Purge finds
+          // nothing expired and reschedules it to the new earliest expire time.
+          m_expiry.erase (nb.m_expiryPos);
+          nb.m_expireTime = expire + Simulator::Now ();
+          nb.m_expiryPos = m_expiry.insert (std::make_pair (nb.m_expireTime, addr));
         }
+      // Unresolved MAC address is looked up again only on TX error, see ProcessTxError
+      return;
     }
 
   NS_LOG_LOGIC ("Open link to " << addr);
   Neighbor neighbor (addr, LookupMacAddress (addr), expire + Simulator::Now ());
-  m_nb.push_back (neighbor);
-  Purge ();
+  neighbor.m_expiryPos = m_expiry.insert (std::make_pair (neighbor.m_expireTime, addr));
+  m_nb.insert (std::make_pair (addr, neighbor));
+  if (neighbor.m_expiryPos == m_expiry.begin ())
+    {
+      ScheduleTimer ();
+    }
 }
 
-/**
- * \brief CloseNeighbor structure
- */
-struct CloseNeighbor
-{
-  /**
-   * Check if the entry is expired
-   *
-   * \param nb Neighbors::Neighbor entry
-   * \return true if expired, false otherwise
-   */
-  bool operator() (const Neighbors::Neighbor & nb) const
-  {
-    return ((nb.m_expireTime < Simulator::Now ()) || nb.close);
-  }
-};
-
 void
-Neighbors::Purge ()
+Neighbors::CloseLink (std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i)
 {
-  if (m_nb.empty ())
+  Ipv4Address addr = i->first;
+  m_expiry.erase (i->second.m_expiryPos);
+  m_nb.erase (i);
+  NS_LOG_LOGIC ("Close link to " << addr);
+  if (!m_handleLinkFailure.IsNull ())
     {
-      return;
+      m_handleLinkFailure (addr);
     }
+}
 
-  CloseNeighbor pred;
-  if (!m_handleLinkFailure.IsNull ())
+void
+Neighbors::Purge ()
+{
+  // Entry is expired when its expire time is in the past
+  while (!m_expiry.empty () && m_expiry.begin ()->first < Simulator::Now ())
     {
-      for (std::vector<Neighbor>::iterator j = m_nb.begin (); j != m_nb.end (); ++j)
-        {
-          if (pred (*j))
-            {
-              NS_LOG_LOGIC ("Close link to " << j->m_neighborAddress);
-              m_handleLinkFailure (j->m_neighborAddress);
-            }
-        }
+      CloseLink (m_nb.find (m_expiry.begin ()->second));
     }
-  m_nb.erase (std::remove_if (m_nb.begin (), m_nb.end (), pred), m_nb.end ());
-  m_ntimer.Cancel ();
-  m_ntimer.Schedule ();
+  ScheduleTimer ();
 }
 
 void
 Neighbors::ScheduleTimer ()
 {
   m_ntimer.Cancel ();
-  m_ntimer.Schedule ();
+  if (m_expiry.empty ())
+    {
+      return;
+    }
+  Time delay = m_expiry.begin ()->first - Simulator::Now () + TimeStep (1);
+  m_ntimer.Schedule (std::max (delay, Time (0)));
 }
 
 void
@@ -156,19 +141,21 @@ void
 Neighbors::DelArpCache (Ptr<ArpCache> a)
 {
   m_arp.erase (std::remove (m_arp.begin (), m_arp.end (), a), m_arp.end ());
+  m_lastArpHit = 0;
 }
 
 Mac48Address
 Neighbors::LookupMacAddress (Ipv4Address addr)
 {
   Mac48Address hwaddr;
-  for (std::vector<Ptr<ArpCache> >::const_iterator i = m_arp.begin ();
-       i != m_arp.end (); ++i)
+  for (uint32_t k = 0; k < m_arp.size (); ++k)
     {
-      ArpCache::Entry * entry = (*i)->Lookup (addr);
+      uint32_t idx = (m_lastArpHit + k) % m_arp.size ();
+      ArpCache::Entry * entry = m_arp[idx]->Lookup (addr);
       if (entry != 0 && (entry->IsAlive () || entry->IsPermanent ()) && !entry->IsExpired ())
         {
           hwaddr = Mac48Address::ConvertFrom (entry->GetMacAddress ());
+          m_lastArpHit = idx;
           break;
         }
     }
@@ -180,11 +167,30 @@ Neighbors::ProcessTxError (WifiMacHeader const & hdr)
 {
   Mac48Address addr = hdr.GetAddr1 ();
 
-  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+  std::vector<Ipv4Address> closed;
+  for (std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i = m_nb.begin ();
+       i != m_nb.end (); ++i)
+    {
+      if (i->second.m_hardwareAddress == Mac48Address ())
+        {
+          i->second.m_hardwareAddress = LookupMacAddress (i->first);
+        }
+      if (i->second.m_hardwareAddress == addr)
+        {
+          i->second.close = true;
+          closed.push_back (i->first);
+        }
+    }
+  if (closed.empty ())
+    {
+      return;
+    }
+  for (std::vector<Ipv4Address>::const_iterator j = closed.begin (); j != closed.end (); ++j)
     {
-      if (i->m_hardwareAddress == addr)
+      std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i = m_nb.find (*j);
+      if (i != m_nb.end ())
         {
-          i->close = true;
+          CloseLink (i);
         }
     }
   Purge ();
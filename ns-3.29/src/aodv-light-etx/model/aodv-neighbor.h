@@ -30,6 +30,8 @@
 #define AODVNEIGHBOR_H
 
 #include <vector>
+#include <map>
+#include <unordered_map>
 #include "ns3/simulator.h"
 #include "ns3/timer.h"
 #include "ns3/ipv4-address.h"
@@ -47,6 +49,10 @@ class RoutingProtocol;
 /**
  * \ingroup aodv
  * \brief maintain list of active neighbors
+ *
+ * Neighbors are indexed by IP address in a hash table. Expire times are
+ * additionally kept in a time ordered index, so a single timer fires at the
+ * earliest expire time instead of the whole list being purged on every query.
  */
 class Neighbors
 {
@@ -56,6 +62,8 @@ public:
    * \param delay the delay time for purging the list of neighbors
    */
   Neighbors (Time delay);
+  /// Time ordered index of neighbor expire times
+  typedef std::multimap<Time, Ipv4Address> ExpiryIndex;
   /// Neighbor description
   struct Neighbor
   {
@@ -67,6 +75,8 @@ public:
     Time m_expireTime;
     /// Neighbor close indicator
     bool close;
+    /// Position of this neighbor in the expiry index
+    ExpiryIndex::iterator m_expiryPos;
 
     /**
      * \brief Neighbor structure constructor
@@ -103,12 +113,14 @@ public:
   void Update (Ipv4Address addr, Time expire);
   /// Remove all expired entries
   void Purge ();
-  /// Schedule m_ntimer.
+  /// Schedule m_ntimer at the earliest neighbor expire time.
   void ScheduleTimer ();
   /// Remove all entries
   void Clear ()
   {
     m_nb.clear ();
+    m_expiry.clear ();
+    m_ntimer.Cancel ();
   }
 
   /**
@@ -154,13 +166,24 @@ private:
   Callback<void, WifiMacHeader const &> m_txErrorCallback;
   /// Timer for neighbor's list. Schedule Purge().
   Timer m_ntimer;
-  /// vector of entries
-  std::vector<Neighbor> m_nb;
+  /// neighbors indexed by IP address
+  std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash> m_nb;
+  /// neighbor expire times in increasing order
+  ExpiryIndex m_expiry;
   /// list of ARP cached to be used for layer 2 notifications processing
   std::vector<Ptr<ArpCache> > m_arp;
+  /// index in m_arp of the ARP cache which resolved the last address
+  uint32_t m_lastArpHit;
+
+  /**
+   * Remove neighbor from the table and notify about link failure
+   * \param i the neighbor to remove
+   */
+  void CloseLink (std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i);
 
   /**
-   * Find MAC address by IP using list of ARP caches
+   * Find MAC address by IP using list of ARP caches. The cache which
+   * answered the previous lookup is tried first.
    * 
    * \param addr the IP address to lookup
    * \returns the MAC address for the IP address
@@ -36,6 +36,7 @@
 #include "ns3/enum.h"
 #include "ns3/ipv4-address.h"
 #include <map>
+#include <vector>
 #include "ns3/nstime.h"
 
 namespace ns3 {
@@ -700,10 +701,43 @@ std::ostream & operator<< (std::ostream & os, RerrHeader const &);
   | LPP cnt (2)   | xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx   |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
    \endverbatim
+  Upper 4 bits of LPP ID field carry encoding version. Format above is version 0
+  (LPP_PLAIN). Version 1 (LPP_COMPACT) has 16 bit number of neighbors and groups
+  neighbors sharing the same /16 prefix. Each neighbor takes 2 byte host suffix
+  and 4 bit LPP count (counts are 1..10). Version 0 is sent instead whenever some
+  count doesn't fit in 4 bits.
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |Ver=1 |LPP ID  |     xxxxxxxxxxxxxxxxxxxxx     |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                   Originator IP Address                       |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                 Originator Sequence Number                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |    Number of Neighbors (n)    |       /16 Prefix (1)          |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  | Neighbors with Prefix (1) (m) |       Host Suffix (1)         |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                        ...                                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |       Host Suffix (m)         |cnt (1)|cnt (2)|  ...  |cnt (m)|
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |       /16 Prefix (2)          |              ...              |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   \endverbatim
 */
 class LppHeader : public Header 
 {
 public:
+  /// LPP encoding versions
+  enum LppVersion
+  {
+    LPP_PLAIN = 0,   //!< full IP address and 1 byte count per neighbor, at most 255 neighbors
+    LPP_COMPACT = 1  //!< neighbors grouped by /16 prefix, 2 byte host suffix and 4 bit count
+  };
+
   /// constructor
   LppHeader ();
 
@@ -748,23 +782,52 @@ public:
   
   uint16_t GetNumberNeighbors () const 
   {
-	  return (uint8_t)m_neighborsLppCnt.size ();
+	  return (uint16_t)m_neighborsLppCnt.size ();
+  }
+
+  /**
+   * Set requested encoding version, LPP_PLAIN is used anyway if some count doesn't fit in 4 bits,
+   * and LPP_COMPACT is used instead of LPP_PLAIN for more than 255 neighbors
+   * \param version the LppVersion
+   */
+  void SetVersion (uint8_t version)
+  {
+	  m_version = version;
+  }
+
+  /// \returns requested (or received) encoding version
+  uint8_t GetVersion () const
+  {
+	  return m_version;
   }
 
   /// Control neighbors list
   bool AddToNeighborsList (Ipv4Address neighbor, uint8_t lppCnt);
   bool RemoveFromNeighborsList (std::pair<Ipv4Address, uint8_t> & un);
   void ClearNeighborsList ();
+  /**
+   * Look up LPP count reported for a neighbor (binary search over sorted list)
+   * \param neighbor the IP address of the neighbor
+   * \param lppCnt the LPP count, set only if the neighbor is in the list
+   * \returns true if the neighbor is in the list
+   */
+  bool FindNeighborLppCnt (Ipv4Address neighbor, uint8_t & lppCnt) const;
 
   bool operator== (LppHeader const & o) const;
 
 private:
   uint8_t       m_lppId;          ///< LPP ID
+  uint8_t       m_version;        ///< Encoding version
   Ipv4Address   m_originAddr;     ///< Originator IP Address
   uint32_t      m_originSeqno;    ///< Originator Sequential number
+  uint8_t       m_maxLppCnt;      ///< Upper bound of LPP counts in the list
+
+  /// \returns version used for serialization
+  uint8_t GetEncodingVersion () const;
 
-  /// List of neighbors: IP addresses and number of LLP count in last check period
-  std::map<Ipv4Address, uint8_t> m_neighborsLppCnt;
+  /// List of neighbors: IP addresses and number of LLP count in last check period,
+  /// kept sorted by IP address
+  std::vector<std::pair<Ipv4Address, uint8_t> > m_neighborsLppCnt;
 };
 
 std::ostream & operator<< (std::ostream & os, LppHeader const &);
@@ -403,6 +403,8 @@ private:
   bool m_enableEtx; /*etx*/
   /// LPP interval
   Time m_lppInterval; /*etx*/
+  /// Send LPP neighbor list in compact encoding
+  bool m_enableCompactLpp; /*etx*/
   /// Link probe packet timer
   Timer m_lppTimer; /*etx*/
   /// Schedule next send of link probe packet
@@ -21,9 +21,11 @@
  
 #include "aodv-neighbor-etx.h"
 #include "ns3/log.h"
+#include "ns3/assert.h"
 #include "ns3/simulator.h"
 #include <cmath>
 #include <stdint.h>
+#include <algorithm>
 
 namespace ns3
 {
@@ -33,7 +35,50 @@ NS_LOG_COMPONENT_DEFINE ("AodvNeighborEtx");
 namespace aodv
 {
 
-NeighborEtx::NeighborEtx () : m_lppTimeStamp (0) {}
+// Number of set bits in the lpp map. Compiles to a single instruction where
+// the target has hardware popcount.
+static inline uint8_t
+PopCount16 (uint16_t map)
+{
+#if defined (__GNUC__)
+  return (uint8_t) __builtin_popcount (map);
+#else
+  uint8_t cnt = 0;
+  for (; map != 0; map &= (uint16_t)(map - 1))
+    {
+      ++cnt;
+    }
+  return cnt;
+#endif
+}
+
+// LR-ETX depends only on my lpp count, which is at most 10,
+// so all values are calculated once
+struct EtxTable
+{
+  uint8_t m_etx[11];
+  EtxTable ()
+  {
+    m_etx[0] = NeighborEtx::EtxMaxValue ();
+    for (uint16_t cnt = 1; cnt <= 10; ++cnt)
+      {
+        m_etx[cnt] = NeighborEtx::EtxMaxValue ();
+        double b = 60.0;
+        double etxd = std::round (b * std::log10 (10.0 / (double)cnt));
+        if (etxd < NeighborEtx::EtxMaxValue ())
+          {
+            m_etx[cnt] = (uint8_t) etxd;
+          }
+      }
+  }
+};
+static const EtxTable g_etxTable;
+
+NeighborEtx::NeighborEtx ()
+  : m_lppTimeStamp (0),
+    m_lppCntMask (CalculateLppCntMask (0))
+{
+}
 
 // ETX time stamp has 12 different values: 0, 1, 2, ..., 11, 0, 1, ...
 // The values of time stamp changes cyclicly but 2 values are not included
@@ -50,12 +95,6 @@ NeighborEtx::CalculateNextLppTimeStamp (uint8_t currTimeStamp)
   return nextTimeStamp;
 }
 
-void
-NeighborEtx::GotoNextLppTimeStamp ()
-{
-  m_lppTimeStamp = CalculateNextLppTimeStamp (m_lppTimeStamp);
-}
-
 // ETX time stamp has 12 different values: 0, 1, 2, ..., 11, 0, 1, ...
 // but 2 values are not included in etx (lpp count):
 // 1. current time stamp, because of jitter introduced in sending lpp packets some nodes 
@@ -64,20 +103,44 @@ NeighborEtx::GotoNextLppTimeStamp ()
 //    would be having higher lpp count by 1)
 // 2. next time stamp, which is the oldest time stamp and will be cleared to prepare for
 //    the next cycle, so it should not be included in calculation of current lpp count.
+// The mask of remaining 10 time stamps changes only when time stamp changes.
+uint16_t
+NeighborEtx::CalculateLppCntMask (uint8_t currTimeStamp)
+{
+  uint16_t excluded = ((uint16_t)0x0001 << currTimeStamp)
+    | ((uint16_t)0x0001 << CalculateNextLppTimeStamp (currTimeStamp)); // bug fixed thanks to Oscar Bautista
+  return (uint16_t)(~excluded & (uint16_t)0x0FFF);
+}
+
+void
+NeighborEtx::GotoNextLppTimeStamp ()
+{
+  m_lppTimeStamp = CalculateNextLppTimeStamp (m_lppTimeStamp);
+  m_lppCntMask = CalculateLppCntMask (m_lppTimeStamp);
+}
 
 uint8_t 
 NeighborEtx::Lpp10bMapToCnt (uint16_t lpp10bMap) const
 {
-  uint8_t lpp = 0;
-  for (int j=0; j<12; ++j)
+  return PopCount16 (lpp10bMap & m_lppCntMask);
+}
+
+std::size_t
+NeighborEtx::FindNeighbor (Ipv4Address addr) const
+{
+  std::vector<Ipv4Address>::const_iterator i = std::lower_bound (m_address.begin (), m_address.end (), addr);
+  if (i != m_address.end () && *i == addr)
     {
-      if ((j!=m_lppTimeStamp) && 
-          (j!=CalculateNextLppTimeStamp(m_lppTimeStamp))) // bug fixed thanks to Oscar Bautista
-        {
-          lpp += (lpp10bMap & ((uint16_t)0x0001 << j)) ? 1 : 0;
-        }
+      return i - m_address.begin ();
     }
-  return lpp;
+  return m_address.size ();
+}
+
+void
+NeighborEtx::UpdateCachedEtx (std::size_t i)
+{
+  m_lppMyCnt[i] = Lpp10bMapToCnt (m_lppMyCnt10bMap[i]);
+  m_etx[i] = CalculateBinaryShiftedEtx (m_lppMyCnt[i]);
 }
 
 // This function prepare for the next time stamp.
@@ -85,91 +148,110 @@ NeighborEtx::Lpp10bMapToCnt (uint16_t lpp10bMap) const
 // The oldest (next, 12th) field is necessary for synchronization. Since delivery of LPPs
 // is not guaranteed we have to clear oldest field when we send next LPP packet and this field
 // is not used in calculation of ETX.
+// All neighbors are processed in one pass, array by array: the bitmaps and lpp counts first
+// and then the cached ETX values.
 void
 NeighborEtx::GotoNextTimeStampAndClearOldest ()
 {
   GotoNextLppTimeStamp (); // go to  next time stamp which becomes current time stamp
-  // Clear oldest time stamp lpp count values, this is next time stamp compared to current
-  //NS_LOG_UNCOND ("ETX: " << Simulator::Now ().GetSeconds () << ", " << (uint16_t)m_lppTimeStamp << ", " << (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_lppTimeStamp))));
-  for (std::map<Ipv4Address, Etx>::iterator i = m_neighborEtx.begin (); i != m_neighborEtx.end (); )
+  // Delete oldest time stamp lpp count (this is next time stamp compared to current)
+  // Only lower 12 bits are used
+  const uint16_t clearOldestMask = (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_lppTimeStamp)) & (uint16_t)0x0FFF);
+  const uint16_t cntMask = m_lppCntMask;
+  const std::size_t n = m_address.size ();
+  uint16_t *map = m_lppMyCnt10bMap.data ();
+  uint8_t *cnt = m_lppMyCnt.data ();
+  bool formerNeighbors = false;
+  for (std::size_t i = 0; i < n; ++i)
     {
-      Etx etx = i->second;
-      uint16_t lppMyCnt10bMap = etx.m_lppMyCnt10bMap;
-      // Delete oldest time stamp lpp count (this is next time stamp compared to current)
-      // Only lower 12 bits are used
-      lppMyCnt10bMap &= (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_lppTimeStamp)) & (uint16_t)0x0FFF);
-      etx.m_lppMyCnt10bMap = lppMyCnt10bMap;
-      i->second = etx;
-      // Clear former neighbors from the list.
-      // These nodes are recognized based on m_lppMyCnt10bMap value.
-      // If this value is 0, then this node did not receive any LPP from former neighbor node (entry for iterator i),
-      // so it is obvious that neighbor node i is no longer a neighbor and should be deleted from
-      // the list to release memory.
-      if ((i->second.m_lppMyCnt10bMap & (uint16_t)0x0FFF) == 0) // not neighbors any more (no LPPs received lately)
-        {
-          i = m_neighborEtx.erase (i);
-        }
-      else // still neighbors, so just continue...
+      map[i] &= clearOldestMask;
+      cnt[i] = PopCount16 (map[i] & cntMask);
+      formerNeighbors |= (map[i] == 0);
+    }
+  uint8_t *etx = m_etx.data ();
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      etx[i] = CalculateBinaryShiftedEtx (cnt[i]);
+    }
+  if (formerNeighbors)
+    {
+      EraseFormerNeighbors ();
+    }
+}
+
+// Clear former neighbors from the list.
+// These nodes are recognized based on m_lppMyCnt10bMap value.
+// If this value is 0, then this node did not receive any LPP from former neighbor node,
+// so it is obvious that the node is no longer a neighbor and should be deleted from
+// the list to release memory. Remaining entries are compacted in place, so the order is kept.
+void
+NeighborEtx::EraseFormerNeighbors ()
+{
+  std::size_t last = 0;
+  for (std::size_t i = 0; i < m_address.size (); ++i)
+    {
+      if (m_lppMyCnt10bMap[i] != 0)
         {
-          i++;
+          m_address[last] = m_address[i];
+          m_lppMyCnt10bMap[last] = m_lppMyCnt10bMap[i];
+          m_lppMyCnt[last] = m_lppMyCnt[i];
+          m_etx[last] = m_etx[i];
+          ++last;
         }
     }
+  m_address.resize (last);
+  m_lppMyCnt10bMap.resize (last);
+  m_lppMyCnt.resize (last);
+  m_etx.resize (last);
 }
 
 // This function is called by RoutingProtocol::RecvLpp when LPP packet is received
 bool 
 NeighborEtx::UpdateNeighborEtx (Ipv4Address addr, uint8_t lppTimeStamp)
 {
-  std::map<Ipv4Address, Etx>::iterator i = m_neighborEtx.find (addr);
-  if (i == m_neighborEtx.end ())
+  std::vector<Ipv4Address>::iterator pos = std::lower_bound (m_address.begin (), m_address.end (), addr);
+  std::size_t i = pos - m_address.begin ();
+  if (pos == m_address.end () || !(*pos == addr))
     {
       // No address, insert new entry
-      Etx etx;
-      etx.m_lppMyCnt10bMap = (uint16_t)0x0001 << lppTimeStamp;
-      std::pair<std::map<Ipv4Address, Etx>::iterator, bool> result = m_neighborEtx.insert (std::make_pair (addr, etx));
-      return result.second;
+      m_address.insert (pos, addr);
+      m_lppMyCnt10bMap.insert (m_lppMyCnt10bMap.begin () + i, (uint16_t)0x0001 << lppTimeStamp);
+      m_lppMyCnt.insert (m_lppMyCnt.begin () + i, 0);
+      m_etx.insert (m_etx.begin () + i, EtxMaxValue ());
+      UpdateCachedEtx (i);
+      return true;
     }
   else
     {
       // Address found, update existing entry
-      (i->second.m_lppMyCnt10bMap) |= ((uint16_t)0x0001 << lppTimeStamp);
+      uint16_t lppMyCnt10bMap = m_lppMyCnt10bMap[i] | ((uint16_t)0x0001 << lppTimeStamp);
+      if (lppMyCnt10bMap != m_lppMyCnt10bMap[i])
+        {
+          m_lppMyCnt10bMap[i] = lppMyCnt10bMap;
+          UpdateCachedEtx (i);
+        }
       return true;
     }
 }
 
 uint8_t
-NeighborEtx::CalculateBinaryShiftedEtx (Etx etxStruct) const
+NeighborEtx::CalculateBinaryShiftedEtx (uint8_t lppMyCnt) const
 {
-  uint8_t etx = EtxMaxValue ();
-  if (Lpp10bMapToCnt (etxStruct.m_lppMyCnt10bMap)!=0)
-    {
-      double b = 60.0;
-      double etxd = std::round (b * std::log10 (10.0 / (double)Lpp10bMapToCnt (etxStruct.m_lppMyCnt10bMap) ));
-      if (etxd < EtxMaxValue ())
-        {
-          etx = (uint8_t) etxd;
-        }
-    }
-  //NS_LOG_UNCOND ("ETX binary: " << etx);
-  return etx;
+  NS_ASSERT (lppMyCnt <= 10);
+  return g_etxTable.m_etx[lppMyCnt];
 }
 
 uint8_t
 NeighborEtx::GetEtxForNeighbor (Ipv4Address addr) const
 {
-  uint8_t etx;
-  std::map<Ipv4Address, Etx>::const_iterator i = m_neighborEtx.find (addr);
-  if (i == m_neighborEtx.end ())
+  std::size_t i = FindNeighbor (addr);
+  if (i == m_address.size ())
     {
       // No address, ETX -> oo (ETX max value)
-      etx = EtxMaxValue ();
-      return etx;
-    }
-  else
-    {
-      // Address found, calculate and return current ETX value
-      return CalculateBinaryShiftedEtx (i->second);
+      return EtxMaxValue ();
     }
+  // Address found, return cached ETX value
+  return m_etx[i];
 }
 
 } // namespace aodv
@@ -22,7 +22,7 @@
 #ifndef AODVNEIGHBORETX_H
 #define AODVNEIGHBORETX_H
 
-#include <map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 #include "ns3/aodv-packet.h"
 
@@ -35,12 +35,6 @@ class NeighborEtx
 {
 public:
   NeighborEtx ();
-  struct Etx
-  {
-    uint16_t m_lppMyCnt10bMap;
-    Etx () : m_lppMyCnt10bMap (0) {}
-  };
-  
   // Returns current time stamp (it is needed for sending LPP packet; it is used as LPP ID)
   uint8_t GetLppTimeStamp () const {return m_lppTimeStamp; }
   // This function is used to prepare for new cycle of sending LPP packets.
@@ -59,16 +53,33 @@ public:
   // Clear ETX for all neighbors.
   void Clear ()
   {
-    m_neighborEtx.clear ();
+    m_address.clear ();
+    m_lppMyCnt10bMap.clear ();
+    m_lppMyCnt.clear ();
+    m_etx.clear ();
   }
 private:
-  std::map<Ipv4Address, Etx> m_neighborEtx;
+  // Neighbor data is kept in structure of arrays layout. All arrays are indexed alike and
+  // sorted by neighbor IP address. Per time stamp processing runs over one array at a time,
+  // so these loops can be vectorised by the compiler.
+  std::vector<Ipv4Address> m_address;
+  std::vector<uint16_t> m_lppMyCnt10bMap;
+  std::vector<uint8_t> m_lppMyCnt; // cached lpp count over the last 10 time stamps
+  std::vector<uint8_t> m_etx;  // cached ETX, read directly by route discovery
   uint8_t m_lppTimeStamp; // has to be incremented every lpp time period; holds last 10 events  
+  uint16_t m_lppCntMask;  // time stamps included in lpp count (all except current and next)
   
-  uint8_t CalculateBinaryShiftedEtx (struct Etx etxStruct) const;
+  uint8_t CalculateBinaryShiftedEtx (uint8_t lppMyCnt) const;
   uint8_t Lpp10bMapToCnt (uint16_t lpp10bMap) const;
   void GotoNextLppTimeStamp ();
   static uint8_t CalculateNextLppTimeStamp (uint8_t currTimeStamp);
+  static uint16_t CalculateLppCntMask (uint8_t currTimeStamp);
+  // Recalculates cached lpp count and ETX of the neighbor at index i
+  void UpdateCachedEtx (std::size_t i);
+  // Removes neighbors from which no LPP is received in the last 11 time stamps
+  void EraseFormerNeighbors ();
+  // Returns index of the neighbor, or number of neighbors if there is no such neighbor
+  std::size_t FindNeighbor (Ipv4Address addr) const;
 };
 
 } // namespace aodv
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtc@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include "aodv-metric.h"
+
+namespace ns3
+{
+namespace aodv
+{
+
+EtxMetric::Table::Table ()
+{
+  m_etx[0] = EtxMaxValue ();
+  for (uint16_t product = 1; product <= 100; ++product)
+    {
+      // 10^4 * 10 * 10 = 10^6, etx is multiplied by 10^4 to obtain resolution of 4 decimal places.
+      // But both lpp counts should be divided by 10 to obtain probability of packet delivery,
+      // so therefore we have to multiply by 10^6.
+      m_etx[product] = (uint32_t) (std::round (1000000.0 / product));
+    }
+}
+const EtxMetric::Table EtxMetric::s_table;
+
+LightEtxMetric::EtxType
+LightEtxMetric::CalculateLightEtx (uint16_t product)
+{
+  EtxType etx = EtxMaxValue ();
+  double b = 60.0;
+  double etxd = std::round (b * std::log10 (100.0 / product));
+  if (etxd < EtxMaxValue ())
+    {
+      etx = (EtxType) etxd;
+    }
+  return etx;
+}
+
+LightEtxMetric::Table::Table ()
+{
+  m_etx[0] = EtxMaxValue ();
+  for (uint16_t product = 1; product <= 100; ++product)
+    {
+      m_etx[product] = CalculateLightEtx (product);
+    }
+}
+const LightEtxMetric::Table LightEtxMetric::s_table;
+
+LightReverseEtxMetric::Table::Table ()
+{
+  m_etx[0] = EtxMaxValue ();
+  for (uint16_t cnt = 1; cnt <= 10; ++cnt)
+    {
+      m_etx[cnt] = EtxMaxValue ();
+      double b = 60.0;
+      double etxd = std::round (b * std::log10 (10.0 / (double)cnt));
+      if (etxd < EtxMaxValue ())
+        {
+          m_etx[cnt] = (EtxType) etxd;
+        }
+    }
+}
+const LightReverseEtxMetric::Table LightReverseEtxMetric::s_table;
+
+} // namespace aodv
+} // namespace ns3
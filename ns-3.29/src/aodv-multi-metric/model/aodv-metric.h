@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtc@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef AODVMETRIC_H
+#define AODVMETRIC_H
+
+#include <stdint.h>
+#include <cmath>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/aodv-packet.h"
+
+namespace ns3
+{
+namespace aodv
+{
+
+// Link metric policies of MetricRoutingProtocol and NeighborEtx.
+// Metric is chosen at compile time, so ETX calculation, RREQ/RREP ETX accumulation and
+// encoding are inlined into the routing protocol. Every policy provides:
+//   EtxType         - type of cached link ETX
+//   LINK_PROBES     - LPP packets are sent and received
+//   NEIGHBOR_LIST   - LPP carries list of neighbors, so forward LPP count is used
+//   RX_POWER        - rx power of received LPP is used
+//   ETX_ENCODING    - ETX field encoding in RREQ and RREP (EtxEncoding)
+//   GetTypeName ()  - TypeId name of the routing protocol using this metric
+//   EtxMaxValue ()  - ETX of unreachable neighbor, ETX -> oo
+//   SelfEtx ()      - ETX of routes to own interfaces
+//   AddLinkEtx ()   - ETX of route extended by one link
+//   CalculateEtx () - link ETX from lpp counts (and rx power factor and beta for PLR-ETX)
+//   LinkLoss ()     - quality loss of a link with the given ETX in [0, 1], 0 for perfect link
+//                     and 1 for link with delivery ratio 0.5 (in both directions) or worse
+
+// Original AODV, every link costs 1 and ETX of the route is hop count
+struct HopCountMetric
+{
+  typedef uint8_t EtxType;
+  static const bool LINK_PROBES = false;
+  static const bool NEIGHBOR_LIST = false;
+  static const bool RX_POWER = false;
+  static const uint8_t ETX_ENCODING = ETX_ENCODING_NONE;
+
+  static const char * GetTypeName () { return "ns3::aodv::HopCountRoutingProtocol"; }
+  static EtxType EtxMaxValue () { return UINT8_MAX; }
+  static uint32_t SelfEtx () { return 0; }
+  static uint32_t AddLinkEtx (uint32_t routeEtx, uint32_t linkEtx)
+  {
+    return routeEtx + linkEtx < EtxMaxValue () ? routeEtx + linkEtx : EtxMaxValue ();
+  }
+  static EtxType CalculateEtx (uint8_t lppMyCnt, uint8_t lppForward, double rxPowerFactor, double b)
+  {
+    return 1;
+  }
+  static double LinkLoss (uint32_t linkEtx)
+  {
+    return 1.0; // link quality is unknown
+  }
+};
+
+// ETX = 1 / (LPPf/10 * LPPr/10), multiplied by 10^4, 4B in RREQ and RREP
+struct EtxMetric
+{
+  typedef uint32_t EtxType;
+  static const bool LINK_PROBES = true;
+  static const bool NEIGHBOR_LIST = true;
+  static const bool RX_POWER = false;
+  static const uint8_t ETX_ENCODING = ETX_ENCODING_32BIT;
+
+  static const char * GetTypeName () { return "ns3::aodv::EtxRoutingProtocol"; }
+  static EtxType EtxMaxValue () { return UINT32_MAX; }
+  static uint32_t SelfEtx () { return 10000; }
+  static uint32_t AddLinkEtx (uint32_t routeEtx, uint32_t linkEtx)
+  {
+    if (linkEtx == EtxMaxValue ())
+      { // this should never happen because neighbor has limited ETX, but it is better to check!
+        return linkEtx;
+      }
+    return routeEtx + linkEtx;
+  }
+  static EtxType CalculateEtx (uint8_t lppMyCnt, uint8_t lppForward, double rxPowerFactor, double b)
+  {
+    uint16_t product = (uint16_t)lppMyCnt * lppForward; // 0 if any of the counts is 0
+    if (product <= 100)
+      {
+        return s_table.m_etx[product];
+      }
+    return (uint32_t) (std::round (1000000.0 / product));
+  }
+  static double LinkLoss (uint32_t linkEtx)
+  {
+    // ETX 1 is perfect, ETX 4 is delivery ratio 0.5 in both directions
+    return linkEtx <= 10000 ? 0.0 : std::min (1.0, (linkEtx - 10000) / 30000.0);
+  }
+
+  // ETX depends only on the product of both lpp counts, which is at most 10*10,
+  // so all regular values are calculated once
+  struct Table
+  {
+    Table ();
+    uint32_t m_etx[101];
+  };
+  static const Table s_table;
+};
+
+// L-ETX = 60*log10 (100 / (LPPf * LPPr)), 1B in RREQ and RREP
+struct LightEtxMetric
+{
+  typedef uint8_t EtxType;
+  static const bool LINK_PROBES = true;
+  static const bool NEIGHBOR_LIST = true;
+  static const bool RX_POWER = false;
+  static const uint8_t ETX_ENCODING = ETX_ENCODING_8BIT;
+
+  static const char * GetTypeName () { return "ns3::aodv::LightEtxRoutingProtocol"; }
+  static EtxType EtxMaxValue () { return UINT8_MAX; }
+  static uint32_t SelfEtx () { return 0; }
+  static uint32_t AddLinkEtx (uint32_t routeEtx, uint32_t linkEtx)
+  {
+    return routeEtx + linkEtx < EtxMaxValue () ? routeEtx + linkEtx : EtxMaxValue ();
+  }
+  static EtxType CalculateEtx (uint8_t lppMyCnt, uint8_t lppForward, double rxPowerFactor, double b)
+  {
+    uint16_t product = (uint16_t)lppMyCnt * lppForward; // 0 if any of the counts is 0
+    if (product <= 100)
+      {
+        return s_table.m_etx[product];
+      }
+    return CalculateLightEtx (product);
+  }
+  static double LinkLoss (uint32_t linkEtx)
+  {
+    return std::min (1.0, linkEtx / 36.0); // 60*log10 (4)
+  }
+  static EtxType CalculateLightEtx (uint16_t product);
+
+  // L-ETX depends only on the product of both lpp counts, which is at most 10*10,
+  // so all regular values are calculated once
+  struct Table
+  {
+    Table ();
+    uint8_t m_etx[101];
+  };
+  static const Table s_table;
+};
+
+// LR-ETX = 60*log10 (10 / LPPr), only reverse LPP count is used so LPP has no neighbor list
+struct LightReverseEtxMetric
+{
+  typedef uint8_t EtxType;
+  static const bool LINK_PROBES = true;
+  static const bool NEIGHBOR_LIST = false;
+  static const bool RX_POWER = false;
+  static const uint8_t ETX_ENCODING = ETX_ENCODING_8BIT;
+
+  static const char * GetTypeName () { return "ns3::aodv::LightReverseEtxRoutingProtocol"; }
+  static EtxType EtxMaxValue () { return UINT8_MAX; }
+  static uint32_t SelfEtx () { return 0; }
+  static uint32_t AddLinkEtx (uint32_t routeEtx, uint32_t linkEtx)
+  {
+    return routeEtx + linkEtx < EtxMaxValue () ? routeEtx + linkEtx : EtxMaxValue ();
+  }
+  static EtxType CalculateEtx (uint8_t lppMyCnt, uint8_t lppForward, double rxPowerFactor, double b)
+  {
+    NS_ASSERT (lppMyCnt <= 10);
+    return s_table.m_etx[lppMyCnt];
+  }
+  static double LinkLoss (uint32_t linkEtx)
+  {
+    return std::min (1.0, linkEtx / 18.0); // 60*log10 (2)
+  }
+
+  // LR-ETX depends only on my lpp count, which is at most 10,
+  // so all values are calculated once
+  struct Table
+  {
+    Table ();
+    uint8_t m_etx[11];
+  };
+  static const Table s_table;
+};
+
+// PLR-ETX = beta*log10 (10 / LPPr * (1 + alpha*|Prx|)), Prx is rx power of LPP in dBm
+struct PowerLightReverseEtxMetric
+{
+  typedef uint8_t EtxType;
+  static const bool LINK_PROBES = true;
+  static const bool NEIGHBOR_LIST = false;
+  static const bool RX_POWER = true;
+  static const uint8_t ETX_ENCODING = ETX_ENCODING_8BIT;
+
+  static const char * GetTypeName () { return "ns3::aodv::PowerLightReverseEtxRoutingProtocol"; }
+  static EtxType EtxMaxValue () { return UINT8_MAX; }
+  static uint32_t SelfEtx () { return 0; }
+  static uint32_t AddLinkEtx (uint32_t routeEtx, uint32_t linkEtx)
+  {
+    return routeEtx + linkEtx < EtxMaxValue () ? routeEtx + linkEtx : EtxMaxValue ();
+  }
+  static EtxType CalculateEtx (uint8_t lppMyCnt, uint8_t lppForward, double rxPowerFactor, double b)
+  {
+    EtxType etx = EtxMaxValue ();
+    if (lppMyCnt != 0)
+      {
+        double etxd = std::round (b * std::log10 (10.0 / (double)lppMyCnt * rxPowerFactor));
+        if (etxd < EtxMaxValue ())
+          {
+            etx = (EtxType) etxd;
+          }
+      }
+    return etx;
+  }
+  static double LinkLoss (uint32_t linkEtx)
+  {
+    return std::min (1.0, linkEtx / 18.0); // rx power part is counted as loss as well
+  }
+};
+
+} // namespace aodv
+} // namespace ns3
+
+#endif /* AODVMETRIC_H */
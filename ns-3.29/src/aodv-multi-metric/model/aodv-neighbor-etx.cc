@@ -0,0 +1,610 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtc@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include "aodv-neighbor-etx.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <cmath>
+#include <stdint.h>
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("AodvNeighborEtx");
+
+namespace aodv
+{
+
+// Number of set bits in the lpp map. Compiles to a single instruction where
+// the target has hardware popcount.
+static inline uint8_t
+PopCount16 (uint16_t map)
+{
+#if defined (__GNUC__)
+  return (uint8_t) __builtin_popcount (map);
+#else
+  uint8_t cnt = 0;
+  for (; map != 0; map &= (uint16_t)(map - 1))
+    {
+      ++cnt;
+    }
+  return cnt;
+#endif
+}
+
+template <class Metric>
+NeighborEtx<Metric>::NeighborEtx ()
+  : m_lppTimeStamp (0),
+    m_lppCntMask (CalculateLppCntMask (0)),
+    m_a (0.05),
+    m_b (60.0),
+    m_variableSlots (false),
+    m_defaultPeriod (Seconds (1)),
+    m_neighborChanges (0),
+    m_etxChanges (0)
+{
+}
+
+template <class Metric>
+void
+NeighborEtx<Metric>::SetCoeficients (double a, double b)
+{
+  m_a = a;
+  m_b = b;
+  if (!Metric::RX_POWER)
+    {
+      return;
+    }
+  // Power factor depends on a, so it is recalculated from recorded rx power
+  for (std::size_t i = 0; i < m_address.size (); ++i)
+    {
+      m_rxPowerFactor[i] = CalculateRxPowerFactor (m_rxPowers[i]);
+      UpdateCachedEtx (i);
+    }
+}
+
+template <class Metric>
+void
+NeighborEtx<Metric>::SetVariableSlots (bool enable, Time defaultPeriod)
+{
+  NS_ASSERT (defaultPeriod.IsStrictlyPositive ());
+  m_defaultPeriod = defaultPeriod;
+  if (enable == m_variableSlots)
+    {
+      return;
+    }
+  // Lpp counts of the two modes are not comparable, so start from scratch
+  m_neighborChanges += m_address.size ();
+  Clear ();
+  m_variableSlots = enable;
+}
+
+template <class Metric>
+void
+NeighborEtx<Metric>::GetAndResetChanges (uint32_t &neighborChanges, uint32_t &etxChanges)
+{
+  neighborChanges = m_neighborChanges;
+  etxChanges = m_etxChanges;
+  m_neighborChanges = 0;
+  m_etxChanges = 0;
+}
+
+// ETX time stamp has 12 different values: 0, 1, 2, ..., 11, 0, 1, ...
+// The values of time stamp changes cyclicly but 2 values are not included
+// in etx (lpp count): current and next (since this is the oldest value and must be
+// cleared to prepare for the next cycle)
+template <class Metric>
+uint8_t
+NeighborEtx<Metric>::CalculateNextLppTimeStamp (uint8_t currTimeStamp)
+{
+  uint8_t nextTimeStamp = currTimeStamp + 1;
+  if (nextTimeStamp > 11)
+    {
+      nextTimeStamp = 0;
+    }
+  return nextTimeStamp;
+}
+
+// ETX time stamp has 12 different values: 0, 1, 2, ..., 11, 0, 1, ...
+// but 2 values are not included in etx (lpp count):
+// 1. current time stamp, because of jitter introduced in sending lpp packets some nodes
+//    where transmitted lpp before this node and some nodes will transmit lpp after,
+//    so lpp packet count would not be fair (nodes that have transmitted lpp before
+//    would be having higher lpp count by 1)
+// 2. next time stamp, which is the oldest time stamp and will be cleared to prepare for
+//    the next cycle, so it should not be included in calculation of current lpp count.
+// The mask of remaining 10 time stamps changes only when time stamp changes.
+template <class Metric>
+uint16_t
+NeighborEtx<Metric>::CalculateLppCntMask (uint8_t currTimeStamp)
+{
+  uint16_t excluded = ((uint16_t)0x0001 << currTimeStamp)
+    | ((uint16_t)0x0001 << CalculateNextLppTimeStamp (currTimeStamp)); // bug fixed thanks to Oscar Bautista
+  return (uint16_t)(~excluded & (uint16_t)0x0FFF);
+}
+
+template <class Metric>
+void
+NeighborEtx<Metric>::GotoNextLppTimeStamp ()
+{
+  m_lppTimeStamp = CalculateNextLppTimeStamp (m_lppTimeStamp);
+  m_lppCntMask = CalculateLppCntMask (m_lppTimeStamp);
+}
+
+template <class Metric>
+uint8_t
+NeighborEtx<Metric>::Lpp10bMapToCnt (uint16_t lpp10bMap) const
+{
+  return PopCount16 (lpp10bMap & m_lppCntMask);
+}
+
+template <class Metric>
+std::size_t
+NeighborEtx<Metric>::FindNeighbor (Ipv4Address addr) const
+{
+  std::vector<Ipv4Address>::const_iterator i = std::lower_bound (m_address.begin (), m_address.end (), addr);
+  if (i != m_address.end () && *i == addr)
+    {
+      return i - m_address.begin ();
+    }
+  return m_address.size ();
+}
+
+template <class Metric>
+void
+NeighborEtx<Metric>::UpdateCachedEtx (std::size_t i)
+{
+  if (m_variableSlots)
+    {
+      m_lppMyCnt[i] = PopCount16 (m_lppMyCnt10bMap[i] & CalculateLppCntMask (m_currLppTimeStamp[i]));
+    }
+  else
+    {
+      m_lppMyCnt[i] = Lpp10bMapToCnt (m_lppMyCnt10bMap[i]);
+    }
+  EtxType etx = Metric::CalculateEtx (m_lppMyCnt[i],
+                                      Metric::NEIGHBOR_LIST ? m_lppForward[i] : 0,
+                                      Metric::RX_POWER ? m_rxPowerFactor[i] : 1.0,
+                                      m_b);
+  if (etx != m_etx[i])
+    {
+      m_etx[i] = etx;
+      ++m_etxChanges;
+    }
+}
+
+// Every step moves current time stamp of the neighbor to the next one, and clears the
+// slot following it, which is the oldest one (the same as GotoNextTimeStampAndClearOldest
+// does for all neighbors when slots are not variable).
+template <class Metric>
+void
+NeighborEtx<Metric>::AdvanceNeighborTimeStamp (std::size_t i, uint8_t slots)
+{
+  if (slots >= 12)
+    {
+      // Whole window has passed
+      m_lppMyCnt10bMap[i] = 0;
+      m_currLppTimeStamp[i] = (m_currLppTimeStamp[i] + slots) % 12;
+      return;
+    }
+  for (uint8_t s = 0; s < slots; ++s)
+    {
+      m_currLppTimeStamp[i] = CalculateNextLppTimeStamp (m_currLppTimeStamp[i]);
+      m_lppMyCnt10bMap[i] &= (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_currLppTimeStamp[i])) & (uint16_t)0x0FFF);
+    }
+}
+
+// Neighbor sends LPP with the next time stamp every period, so its current time stamp
+// is estimated from the time stamp and reception time of the last LPP. Advertised period
+// is the time until the next LPP of the neighbor, so the estimate holds until the neighbor
+// changes its interval, and it is corrected by the next received LPP.
+template <class Metric>
+void
+NeighborEtx<Metric>::AdvanceNeighborTimeStampTo (std::size_t i, Time now)
+{
+  int64_t steps = (now - m_lastLppTime[i]).GetInteger () / m_lppPeriod[i].GetInteger ();
+  if (steps >= 12)
+    {
+      AdvanceNeighborTimeStamp (i, 12);
+      return;
+    }
+  uint8_t target = (m_lastLppTimeStamp[i] + steps) % 12;
+  uint8_t slots = (target + 12 - m_currLppTimeStamp[i]) % 12;
+  AdvanceNeighborTimeStamp (i, slots);
+}
+
+// This function prepare for the next time stamp.
+// It is called by RoutingProtocol::SendLpp () every second ie. when the LPP packet is sent.
+// The oldest (next, 12th) field is necessary for synchronization. Since delivery of LPPs
+// is not guaranteed we have to clear oldest field when we send next LPP packet and this field
+// is not used in calculation of ETX.
+// All neighbors are processed in one pass, array by array: the bitmaps and lpp counts first
+// and then the cached ETX values.
+template <class Metric>
+void
+NeighborEtx<Metric>::GotoNextTimeStampAndClearOldest ()
+{
+  GotoNextLppTimeStamp (); // go to  next time stamp which becomes current time stamp
+  if (m_variableSlots)
+    {
+      // Every neighbor has its own slots, so its time stamp is moved to the current one
+      Time now = Simulator::Now ();
+      bool formerNeighbors = false;
+      for (std::size_t i = 0; i < m_address.size (); ++i)
+        {
+          AdvanceNeighborTimeStampTo (i, now);
+          UpdateCachedEtx (i);
+          formerNeighbors |= (m_lppMyCnt10bMap[i] == 0);
+        }
+      if (formerNeighbors)
+        {
+          EraseFormerNeighbors ();
+        }
+      return;
+    }
+  // Delete oldest time stamp lpp count (this is next time stamp compared to current)
+  // Only lower 12 bits are used
+  const uint16_t clearOldestMask = (uint16_t)(~((uint16_t)0x0001 << CalculateNextLppTimeStamp (m_lppTimeStamp)) & (uint16_t)0x0FFF);
+  const uint16_t cntMask = m_lppCntMask;
+  const std::size_t n = m_address.size ();
+  uint16_t *map = m_lppMyCnt10bMap.data ();
+  uint8_t *cnt = m_lppMyCnt.data ();
+  bool formerNeighbors = false;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      map[i] &= clearOldestMask;
+      cnt[i] = PopCount16 (map[i] & cntMask);
+      formerNeighbors |= (map[i] == 0);
+    }
+  EtxType *etx = m_etx.data ();
+  const uint8_t *fwd = m_lppForward.data ();
+  const double *factor = m_rxPowerFactor.data ();
+  uint32_t etxChanges = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      EtxType e = Metric::CalculateEtx (cnt[i],
+                                        Metric::NEIGHBOR_LIST ? fwd[i] : 0,
+                                        Metric::RX_POWER ? factor[i] : 1.0,
+                                        m_b);
+      etxChanges += (e != etx[i]);
+      etx[i] = e;
+    }
+  m_etxChanges += etxChanges;
+  if (formerNeighbors)
+    {
+      EraseFormerNeighbors ();
+    }
+}
+
+// Clear former neighbors from the list.
+// These nodes are recognized based on m_lppMyCnt10bMap value.
+// If this value is 0, then this node did not receive any LPP from former neighbor node,
+// so it is obvious that the node is no longer a neighbor and should be deleted from
+// the list to release memory. Remaining entries are compacted in place, so the order is kept.
+template <class Metric>
+void
+NeighborEtx<Metric>::EraseFormerNeighbors ()
+{
+  std::size_t last = 0;
+  for (std::size_t i = 0; i < m_address.size (); ++i)
+    {
+      if (m_lppMyCnt10bMap[i] != 0)
+        {
+          m_address[last] = m_address[i];
+          m_lppMyCnt10bMap[last] = m_lppMyCnt10bMap[i];
+          if (Metric::NEIGHBOR_LIST)
+            {
+              m_lppForward[last] = m_lppForward[i];
+              m_lppAdvertisedCnt[last] = m_lppAdvertisedCnt[i];
+              m_lppListSeqNo[last] = m_lppListSeqNo[i];
+            }
+          if (Metric::RX_POWER)
+            {
+              m_rxPowers[last] = m_rxPowers[i];
+              m_rxPowerFactor[last] = m_rxPowerFactor[i];
+            }
+          m_lppMyCnt[last] = m_lppMyCnt[i];
+          m_etx[last] = m_etx[i];
+          if (m_variableSlots)
+            {
+              m_lppPeriod[last] = m_lppPeriod[i];
+              m_lastLppTime[last] = m_lastLppTime[i];
+              m_lastLppTimeStamp[last] = m_lastLppTimeStamp[i];
+              m_currLppTimeStamp[last] = m_currLppTimeStamp[i];
+            }
+          ++last;
+        }
+      else if (Metric::NEIGHBOR_LIST && m_lppAdvertisedCnt[i] > 0)
+        {
+          // Neighbors have to be told that the count has dropped to 0
+          m_lppRemoved.push_back (m_address[i]);
+        }
+    }
+  m_neighborChanges += m_address.size () - last;
+  m_address.resize (last);
+  m_lppMyCnt10bMap.resize (last);
+  if (Metric::NEIGHBOR_LIST)
+    {
+      m_lppForward.resize (last);
+      m_lppAdvertisedCnt.resize (last);
+      m_lppListSeqNo.resize (last);
+    }
+  if (Metric::RX_POWER)
+    {
+      m_rxPowers.resize (last);
+      m_rxPowerFactor.resize (last);
+    }
+  m_lppMyCnt.resize (last);
+  m_etx.resize (last);
+  if (m_variableSlots)
+    {
+      m_lppPeriod.resize (last);
+      m_lastLppTime.resize (last);
+      m_lastLppTimeStamp.resize (last);
+      m_currLppTimeStamp.resize (last);
+    }
+}
+
+template <class Metric>
+void
+NeighborEtx<Metric>::FillLppCntData (LppHeader &lppHeader)
+{
+  if (!Metric::NEIGHBOR_LIST)
+    {
+      return;
+    }
+  for (std::size_t i = 0; i < m_address.size (); ++i)
+    {
+      if (m_lppMyCnt[i] > 0)
+        {
+          lppHeader.AddToNeighborsList (m_address[i], m_lppMyCnt[i]);
+        }
+      m_lppAdvertisedCnt[i] = m_lppMyCnt[i];
+    }
+  // Full list is the new base for delta lists
+  m_lppRemoved.clear ();
+}
+
+template <class Metric>
+void
+NeighborEtx<Metric>::FillLppCntDelta (LppHeader &lppHeader)
+{
+  if (!Metric::NEIGHBOR_LIST)
+    {
+      return;
+    }
+  for (std::size_t i = 0; i < m_address.size (); ++i)
+    {
+      if (m_lppMyCnt[i] != m_lppAdvertisedCnt[i])
+        {
+          lppHeader.AddToNeighborsList (m_address[i], m_lppMyCnt[i]);
+          m_lppAdvertisedCnt[i] = m_lppMyCnt[i];
+        }
+    }
+  for (std::vector<Ipv4Address>::const_iterator j = m_lppRemoved.begin (); j != m_lppRemoved.end (); ++j)
+    {
+      // Removed neighbor may be back already, then its count is in the list
+      lppHeader.AddToNeighborsList (*j, 0);
+    }
+  m_lppRemoved.clear ();
+}
+
+template <class Metric>
+bool
+NeighborEtx<Metric>::FindDeltaLppForward (Ipv4Address addr, Ipv4Address receiver, const LppHeader &lppHeader,
+                                          uint8_t &lppForward) const
+{
+  NS_ASSERT (Metric::NEIGHBOR_LIST && !lppHeader.IsFullList ());
+  std::size_t i = FindNeighbor (addr);
+  lppForward = 0;
+  if (i == m_address.size ())
+    {
+      // Nothing is known about the neighbor before its first full list
+      return false;
+    }
+  lppForward = m_lppForward[i];
+  if (m_lppListSeqNo[i] == LPP_LIST_NOT_SYNCHRONIZED
+      || lppHeader.GetListSeqNo () != ((m_lppListSeqNo[i] + 1) & 0x3F))
+    {
+      return false;
+    }
+  lppHeader.FindNeighborLppCnt (receiver, lppForward);
+  return true;
+}
+
+template <class Metric>
+void
+NeighborEtx<Metric>::SetLppListSeqNo (Ipv4Address addr, uint8_t listSeqNo)
+{
+  if (!Metric::NEIGHBOR_LIST)
+    {
+      return;
+    }
+  std::size_t i = FindNeighbor (addr);
+  if (i != m_address.size ())
+    {
+      m_lppListSeqNo[i] = listSeqNo;
+    }
+}
+
+// This function is called by RoutingProtocol::RecvLpp when LPP packet is received
+template <class Metric>
+bool
+NeighborEtx<Metric>::UpdateNeighborEtx (Ipv4Address addr, uint8_t lppTimeStamp, uint8_t lppForward, double power,
+                                        Time period)
+{
+  if (m_variableSlots)
+    {
+      return UpdateNeighborEtxVariableSlots (addr, lppTimeStamp, lppForward, power, period);
+    }
+  std::vector<Ipv4Address>::iterator pos = std::lower_bound (m_address.begin (), m_address.end (), addr);
+  std::size_t i = pos - m_address.begin ();
+  if (pos == m_address.end () || !(*pos == addr))
+    {
+      // No address, insert new entry
+      m_address.insert (pos, addr);
+      m_lppMyCnt10bMap.insert (m_lppMyCnt10bMap.begin () + i, (uint16_t)0x0001 << lppTimeStamp);
+      if (Metric::NEIGHBOR_LIST)
+        {
+          m_lppForward.insert (m_lppForward.begin () + i, lppForward);
+          m_lppAdvertisedCnt.insert (m_lppAdvertisedCnt.begin () + i, 0);
+          m_lppListSeqNo.insert (m_lppListSeqNo.begin () + i, LPP_LIST_NOT_SYNCHRONIZED);
+        }
+      if (Metric::RX_POWER)
+        {
+          m_rxPowers.insert (m_rxPowers.begin () + i, power);
+          m_rxPowerFactor.insert (m_rxPowerFactor.begin () + i, CalculateRxPowerFactor (power));
+        }
+      m_lppMyCnt.insert (m_lppMyCnt.begin () + i, 0);
+      m_etx.insert (m_etx.begin () + i, EtxMaxValue ());
+      ++m_neighborChanges;
+      UpdateCachedEtx (i);
+      return true;
+    }
+  else
+    {
+      // Address found, update existing entry
+      uint16_t lppMyCnt10bMap = m_lppMyCnt10bMap[i] | ((uint16_t)0x0001 << lppTimeStamp);
+      bool changed = lppMyCnt10bMap != m_lppMyCnt10bMap[i];
+      if (Metric::NEIGHBOR_LIST && lppForward != m_lppForward[i])
+        {
+          m_lppForward[i] = lppForward;
+          changed = true;
+        }
+      if (Metric::RX_POWER && power != m_rxPowers[i])
+        {
+          m_rxPowers[i] = power;
+          m_rxPowerFactor[i] = CalculateRxPowerFactor (power);
+          changed = true;
+        }
+      if (changed)
+        {
+          m_lppMyCnt10bMap[i] = lppMyCnt10bMap;
+          UpdateCachedEtx (i);
+        }
+      return true;
+    }
+}
+
+// With variable slots time stamp of the LPP is the current time stamp of the neighbor,
+// so the estimated one is corrected. Time stamps up to 6 slots ahead are reached by
+// moving forward (LPPs of the neighbor were lost), otherwise the estimate went too far
+// (neighbor has prolonged its interval and the LPP announcing it was lost), and it is moved
+// back. Slots between are already cleared, since they were the oldest ones.
+template <class Metric>
+bool
+NeighborEtx<Metric>::UpdateNeighborEtxVariableSlots (Ipv4Address addr, uint8_t lppTimeStamp, uint8_t lppForward,
+                                                     double power, Time period)
+{
+  Time now = Simulator::Now ();
+  if (!period.IsStrictlyPositive ())
+    {
+      period = m_defaultPeriod;
+    }
+  std::vector<Ipv4Address>::iterator pos = std::lower_bound (m_address.begin (), m_address.end (), addr);
+  std::size_t i = pos - m_address.begin ();
+  if (pos == m_address.end () || !(*pos == addr))
+    {
+      // No address, insert new entry
+      m_address.insert (pos, addr);
+      m_lppMyCnt10bMap.insert (m_lppMyCnt10bMap.begin () + i, 0);
+      if (Metric::NEIGHBOR_LIST)
+        {
+          m_lppForward.insert (m_lppForward.begin () + i, lppForward);
+          m_lppAdvertisedCnt.insert (m_lppAdvertisedCnt.begin () + i, 0);
+          m_lppListSeqNo.insert (m_lppListSeqNo.begin () + i, LPP_LIST_NOT_SYNCHRONIZED);
+        }
+      if (Metric::RX_POWER)
+        {
+          m_rxPowers.insert (m_rxPowers.begin () + i, power);
+          m_rxPowerFactor.insert (m_rxPowerFactor.begin () + i, CalculateRxPowerFactor (power));
+        }
+      m_lppMyCnt.insert (m_lppMyCnt.begin () + i, 0);
+      m_etx.insert (m_etx.begin () + i, EtxMaxValue ());
+      m_lppPeriod.insert (m_lppPeriod.begin () + i, period);
+      m_lastLppTime.insert (m_lastLppTime.begin () + i, now);
+      m_lastLppTimeStamp.insert (m_lastLppTimeStamp.begin () + i, lppTimeStamp);
+      m_currLppTimeStamp.insert (m_currLppTimeStamp.begin () + i, lppTimeStamp);
+      ++m_neighborChanges;
+    }
+  else
+    {
+      // Address found, synchronize time stamp of the neighbor
+      AdvanceNeighborTimeStampTo (i, now);
+      uint8_t slots = (lppTimeStamp + 12 - m_currLppTimeStamp[i]) % 12;
+      if (slots <= 6)
+        {
+          AdvanceNeighborTimeStamp (i, slots);
+        }
+      else
+        {
+          m_currLppTimeStamp[i] = lppTimeStamp;
+        }
+      m_lppPeriod[i] = period;
+      m_lastLppTime[i] = now;
+      m_lastLppTimeStamp[i] = lppTimeStamp;
+      if (Metric::NEIGHBOR_LIST)
+        {
+          m_lppForward[i] = lppForward;
+        }
+      if (Metric::RX_POWER && power != m_rxPowers[i])
+        {
+          m_rxPowers[i] = power;
+          m_rxPowerFactor[i] = CalculateRxPowerFactor (power);
+        }
+    }
+  m_lppMyCnt10bMap[i] |= (uint16_t)0x0001 << lppTimeStamp;
+  UpdateCachedEtx (i);
+  return true;
+}
+
+template <class Metric>
+double
+NeighborEtx<Metric>::CalculateRxPowerFactor (double rxPower) const
+{
+  double x;
+  if (rxPower <= -100)
+  {
+    x = 100.0;
+  }
+  else if (rxPower >= 0)
+  {
+    x = 0.0;
+  }
+  else
+  {
+    x = std::abs (rxPower);
+  }
+  return 1.0+m_a*x;
+}
+
+template <class Metric>
+const uint8_t NeighborEtx<Metric>::LPP_LIST_NOT_SYNCHRONIZED;
+
+template class NeighborEtx<HopCountMetric>;
+template class NeighborEtx<EtxMetric>;
+template class NeighborEtx<LightEtxMetric>;
+template class NeighborEtx<LightReverseEtxMetric>;
+template class NeighborEtx<PowerLightReverseEtxMetric>;
+
+} // namespace aodv
+} // namespace ns3
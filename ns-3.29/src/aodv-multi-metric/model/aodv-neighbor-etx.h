@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtc@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef AODVNEIGHBORETX_H
+#define AODVNEIGHBORETX_H
+
+#include <vector>
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/aodv-packet.h"
+#include "ns3/aodv-metric.h"
+
+namespace ns3
+{
+namespace aodv
+{
+
+// Link ETX of neighbors for the metric policy Metric (see aodv-metric.h).
+// It is explicitly instantiated for all metrics in aodv-neighbor-etx.cc.
+template <class Metric>
+class NeighborEtx
+{
+public:
+  typedef typename Metric::EtxType EtxType;
+
+  NeighborEtx ();
+  // Returns current time stamp (it is needed for sending LPP packet; it is used as LPP ID)
+  uint8_t GetLppTimeStamp () const {return m_lppTimeStamp; }
+  // This function is used to prepare for new cycle of sending LPP packets.
+  // It clears oldest LPP count data and moves to the new time stamp.
+  // These two, the oldest and this new current time stamp are not used for
+  // calculation of ETX metric (previous 10 time stamps is used for ETX calculations)
+  void GotoNextTimeStampAndClearOldest ();
+  // Fills all ETX data from the neighbors map in the LPP packet header,
+  // does nothing if the metric doesn't use neighbor list
+  void FillLppCntData (LppHeader &lppHeader);
+  // Fills only lpp counts changed since the last filled LPP (count 0 for removed neighbors)
+  // in the LPP packet header, does nothing if the metric doesn't use neighbor list
+  void FillLppCntDelta (LppHeader &lppHeader);
+  // Forward lpp count of the neighbor from LPP with delta list (not full list). It is taken
+  // from the list if the neighbor has not missed any delta since its last full list,
+  // otherwise (or if my count is not changed) the last known count is used. Returns false
+  // if some delta is missed, and then the neighbor list is not synchronized until the next
+  // full list.
+  bool FindDeltaLppForward (Ipv4Address addr, Ipv4Address receiver, const LppHeader &lppHeader,
+                            uint8_t &lppForward) const;
+  // Stores list sequence number of the last LPP with delta list received from the neighbor,
+  // LPP_LIST_NOT_SYNCHRONIZED if delta is missed. Call after UpdateNeighborEtx.
+  void SetLppListSeqNo (Ipv4Address addr, uint8_t listSeqNo);
+  static const uint8_t LPP_LIST_NOT_SYNCHRONIZED = 0xFF;
+  // When node receive LPP from a neighbor node it updates my lpp count for that neighbor.
+  // Forward count (read from the neighbor list of the LPP) and rx power of the LPP
+  // are stored only if the metric uses them. Period is LPP interval advertised by the
+  // neighbor, it is used only with variable slots (zero if not advertised).
+  bool UpdateNeighborEtx (Ipv4Address addr, uint8_t lppTimeStamp, uint8_t lppForward, double power,
+                          Time period = Time (0));
+  // Look for neighbor and return its ETX, return etx ->oo (EtxMaxValue) if there
+  // is no neighbor in the map (this is unlikely since it will receive at least
+  // one LPP packet from this neighbor and therefore neighbor will be in the map).
+  // Metrics without link probes return 1 for every neighbor.
+  uint32_t GetEtxForNeighbor (Ipv4Address addr) const
+  {
+    if (!Metric::LINK_PROBES)
+      {
+        return 1;
+      }
+    std::size_t i = FindNeighbor (addr);
+    if (i == m_address.size ())
+      {
+        // No address, ETX -> oo (ETX max value)
+        return EtxMaxValue ();
+      }
+    // Address found, return cached ETX value
+    return m_etx[i];
+  }
+  // Return max possible ETX value of the metric
+  static EtxType EtxMaxValue () { return Metric::EtxMaxValue (); };
+  // Sets PLR-ETX metric parameters, cached ETX of all neighbors is recalculated
+  void SetCoeficients (double a, double b);
+  // With variable slots every neighbor has its own time stamp slots, as long as its own
+  // LPP interval. Current time stamp of the neighbor is estimated from the last received
+  // time stamp and elapsed time, so LPP count is still count of the last 10 LPPs of the
+  // neighbor (excluding current and next). Without variable slots all nodes are assumed
+  // to send LPPs with the same interval, and my time stamp is used for all neighbors.
+  // Default period is used for neighbors which don't advertise their LPP interval.
+  void SetVariableSlots (bool enable, Time defaultPeriod);
+  // Number of neighbors
+  uint32_t GetNNeighbors () const { return m_address.size (); }
+  // Returns number of added and removed neighbors and number of changes of cached
+  // neighbor ETX since the last call
+  void GetAndResetChanges (uint32_t &neighborChanges, uint32_t &etxChanges);
+  // Clear ETX for all neighbors
+  void Clear ()
+  {
+    m_address.clear ();
+    m_lppMyCnt10bMap.clear ();
+    m_lppForward.clear ();
+    m_lppAdvertisedCnt.clear ();
+    m_lppListSeqNo.clear ();
+    m_lppRemoved.clear ();
+    m_rxPowers.clear ();
+    m_rxPowerFactor.clear ();
+    m_lppMyCnt.clear ();
+    m_etx.clear ();
+    m_lppPeriod.clear ();
+    m_lastLppTime.clear ();
+    m_lastLppTimeStamp.clear ();
+    m_currLppTimeStamp.clear ();
+  }
+private:
+  // Neighbor data is kept in structure of arrays layout. All arrays are indexed alike and
+  // sorted by neighbor IP address. Per time stamp processing runs over one array at a time,
+  // so these loops can be vectorised by the compiler.
+  // Forward counts and rx powers are kept only by metrics which use them, otherwise these
+  // arrays are empty.
+  std::vector<Ipv4Address> m_address;
+  std::vector<uint16_t> m_lppMyCnt10bMap;
+  std::vector<uint8_t> m_lppForward;
+  std::vector<uint8_t> m_lppAdvertisedCnt; // my lpp count in the last LPP I have sent
+  std::vector<uint8_t> m_lppListSeqNo; // sequence number of the last delta list of the neighbor
+  std::vector<Ipv4Address> m_lppRemoved; // removed neighbors with advertised lpp count > 0
+  std::vector<double> m_rxPowers;
+  std::vector<double> m_rxPowerFactor; // (1 + a*x) part of PLR-ETX, changes only with rx power
+  std::vector<uint8_t> m_lppMyCnt; // cached lpp count over the last 10 time stamps
+  std::vector<EtxType> m_etx; // cached ETX, read directly by route discovery
+  // Variable slots only, otherwise these arrays are empty
+  std::vector<Time> m_lppPeriod;              // LPP interval of the neighbor
+  std::vector<Time> m_lastLppTime;            // reception time of the last LPP
+  std::vector<uint8_t> m_lastLppTimeStamp;    // time stamp of the last LPP
+  std::vector<uint8_t> m_currLppTimeStamp;    // estimated current time stamp of the neighbor
+  uint8_t m_lppTimeStamp; // has to be incremented every lpp time period; holds last 10 events
+  uint16_t m_lppCntMask;  // time stamps included in lpp count (all except current and next)
+  double m_a, m_b; // PLR-ETX metric parameters
+  bool m_variableSlots;
+  Time m_defaultPeriod;
+  uint32_t m_neighborChanges; // added and removed neighbors
+  uint32_t m_etxChanges;      // changes of cached ETX
+
+  uint8_t Lpp10bMapToCnt (uint16_t lpp10bMap) const;
+  void GotoNextLppTimeStamp ();
+  static uint8_t CalculateNextLppTimeStamp (uint8_t currTimeStamp);
+  static uint16_t CalculateLppCntMask (uint8_t currTimeStamp);
+  double CalculateRxPowerFactor (double rxPower) const;
+  // Recalculates cached lpp count and ETX of the neighbor at index i
+  void UpdateCachedEtx (std::size_t i);
+  // Variable slots: moves current time stamp of the neighbor at index i by the given number
+  // of slots and clears the oldest slot after each move
+  void AdvanceNeighborTimeStamp (std::size_t i, uint8_t slots);
+  // Variable slots: moves current time stamp of the neighbor at index i to the time stamp
+  // estimated for the time now
+  void AdvanceNeighborTimeStampTo (std::size_t i, Time now);
+  // UpdateNeighborEtx with variable slots
+  bool UpdateNeighborEtxVariableSlots (Ipv4Address addr, uint8_t lppTimeStamp, uint8_t lppForward,
+                                       double power, Time period);
+  // Removes neighbors from which no LPP is received in the last 11 time stamps
+  void EraseFormerNeighbors ();
+  // Returns index of the neighbor, or number of neighbors if there is no such neighbor
+  std::size_t FindNeighbor (Ipv4Address addr) const;
+};
+
+extern template class NeighborEtx<HopCountMetric>;
+extern template class NeighborEtx<EtxMetric>;
+extern template class NeighborEtx<LightEtxMetric>;
+extern template class NeighborEtx<LightReverseEtxMetric>;
+extern template class NeighborEtx<PowerLightReverseEtxMetric>;
+
+} // namespace aodv
+} // namespace ns3
+
+
+#endif /* AODVNEIGHBORETX_H */
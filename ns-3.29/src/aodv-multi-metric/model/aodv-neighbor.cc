@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 IITP RAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Based on
+ *      NS-2 AODV model developed by the CMU/MONARCH group and optimized and
+ *      tuned by Samir Das and Mahesh Marina, University of Cincinnati;
+ *
+ *      AODV-UU implementation by Erik Nordström of Uppsala University
+ *      http://core.it.uu.se/core/index.php/AODV-UU
+ *
+ * Authors: Elena Buchatskaia <borovkovaes@iitp.ru>
+ *          Pavel Boyko <boyko@iitp.ru>
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/wifi-mac-header.h"
+#include "aodv-neighbor.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AodvNeighbors");
+
+namespace aodv {
+Neighbors::Neighbors (Time delay)
+  : m_ntimer (Timer::CANCEL_ON_DESTROY),
+    m_lastArpHit (0)
+{
+  m_ntimer.SetDelay (delay);
+  m_ntimer.SetFunction (&Neighbors::Purge, this);
+  m_txErrorCallback = MakeCallback (&Neighbors::ProcessTxError, this);
+}
+
+bool
+Neighbors::IsNeighbor (Ipv4Address addr)
+{
+  std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::const_iterator i = m_nb.find (addr);
+  return (i != m_nb.end () && !i->second.close
+          && i->second.m_expireTime >= Simulator::Now ());
+}
+
+Time
+Neighbors::GetExpireTime (Ipv4Address addr)
+{
+  std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::const_iterator i = m_nb.find (addr);
+  if (i != m_nb.end () && !i->second.close
+      && i->second.m_expireTime >= Simulator::Now ())
+    {
+      return (i->second.m_expireTime - Simulator::Now ());
+    }
+  return Seconds (0);
+}
+
+void
+Neighbors::Update (Ipv4Address addr, Time expire)
+{
+  std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i = m_nb.find (addr);
+  if (i != m_nb.end ())
+    {
+      Neighbor & nb = i->second;
+      if (expire + Simulator::Now () > nb.m_expireTime)
+        {
+          // Extending the expire time of the earliest entry moves the earliest one later,
+          // but the timer is not rescheduled here: it may fire early, then Purge finds
+          // nothing expired and reschedules it to the new earliest expire time.
+          m_expiry.erase (nb.m_expiryPos);
+          nb.m_expireTime = expire + Simulator::Now ();
+          nb.m_expiryPos = m_expiry.insert (std::make_pair (nb.m_expireTime, addr));
+        }
+      // Unresolved MAC address is looked up again only on TX error, see ProcessTxError
+      return;
+    }
+
+  NS_LOG_LOGIC ("Open link to " << addr);
+  Neighbor neighbor (addr, LookupMacAddress (addr), expire + Simulator::Now ());
+  neighbor.m_expiryPos = m_expiry.insert (std::make_pair (neighbor.m_expireTime, addr));
+  m_nb.insert (std::make_pair (addr, neighbor));
+  if (neighbor.m_expiryPos == m_expiry.begin ())
+    {
+      ScheduleTimer ();
+    }
+}
+
+void
+Neighbors::CloseLink (std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i)
+{
+  Ipv4Address addr = i->first;
+  m_expiry.erase (i->second.m_expiryPos);
+  m_nb.erase (i);
+  NS_LOG_LOGIC ("Close link to " << addr);
+  if (!m_handleLinkFailure.IsNull ())
+    {
+      m_handleLinkFailure (addr);
+    }
+}
+
+void
+Neighbors::Purge ()
+{
+  // Entry is expired when its expire time is in the past
+  while (!m_expiry.empty () && m_expiry.begin ()->first < Simulator::Now ())
+    {
+      CloseLink (m_nb.find (m_expiry.begin ()->second));
+    }
+  ScheduleTimer ();
+}
+
+void
+Neighbors::ScheduleTimer ()
+{
+  m_ntimer.Cancel ();
+  if (m_expiry.empty ())
+    {
+      return;
+    }
+  Time delay = m_expiry.begin ()->first - Simulator::Now () + TimeStep (1);
+  m_ntimer.Schedule (std::max (delay, Time (0)));
+}
+
+void
+Neighbors::AddArpCache (Ptr<ArpCache> a)
+{
+  m_arp.push_back (a);
+}
+
+void
+Neighbors::DelArpCache (Ptr<ArpCache> a)
+{
+  m_arp.erase (std::remove (m_arp.begin (), m_arp.end (), a), m_arp.end ());
+  m_lastArpHit = 0;
+}
+
+Mac48Address
+Neighbors::LookupMacAddress (Ipv4Address addr)
+{
+  Mac48Address hwaddr;
+  for (uint32_t k = 0; k < m_arp.size (); ++k)
+    {
+      uint32_t idx = (m_lastArpHit + k) % m_arp.size ();
+      ArpCache::Entry * entry = m_arp[idx]->Lookup (addr);
+      if (entry != 0 && (entry->IsAlive () || entry->IsPermanent ()) && !entry->IsExpired ())
+        {
+          hwaddr = Mac48Address::ConvertFrom (entry->GetMacAddress ());
+          m_lastArpHit = idx;
+          break;
+        }
+    }
+  return hwaddr;
+}
+
+void
+Neighbors::ProcessTxError (WifiMacHeader const & hdr)
+{
+  Mac48Address addr = hdr.GetAddr1 ();
+
+  std::vector<Ipv4Address> closed;
+  for (std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i = m_nb.begin ();
+       i != m_nb.end (); ++i)
+    {
+      if (i->second.m_hardwareAddress == Mac48Address ())
+        {
+          i->second.m_hardwareAddress = LookupMacAddress (i->first);
+        }
+      if (i->second.m_hardwareAddress == addr)
+        {
+          i->second.close = true;
+          closed.push_back (i->first);
+        }
+    }
+  if (closed.empty ())
+    {
+      return;
+    }
+  for (std::vector<Ipv4Address>::const_iterator j = closed.begin (); j != closed.end (); ++j)
+    {
+      std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i = m_nb.find (*j);
+      if (i != m_nb.end ())
+        {
+          CloseLink (i);
+        }
+    }
+  Purge ();
+}
+
+}  // namespace aodv
+}  // namespace ns3
+
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 IITP RAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Based on
+ *      NS-2 AODV model developed by the CMU/MONARCH group and optimized and
+ *      tuned by Samir Das and Mahesh Marina, University of Cincinnati;
+ *
+ *      AODV-UU implementation by Erik Nordström of Uppsala University
+ *      http://core.it.uu.se/core/index.php/AODV-UU
+ *
+ * Authors: Elena Buchatskaia <borovkovaes@iitp.ru>
+ *          Pavel Boyko <boyko@iitp.ru>
+ */
+
+#ifndef AODVNEIGHBOR_H
+#define AODVNEIGHBOR_H
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "ns3/simulator.h"
+#include "ns3/timer.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/callback.h"
+#include "ns3/arp-cache.h"
+
+namespace ns3 {
+
+class WifiMacHeader;
+
+namespace aodv {
+
+class RoutingProtocol;
+
+/**
+ * \ingroup aodv
+ * \brief maintain list of active neighbors
+ *
+ * Neighbors are indexed by IP address in a hash table. Expire times are
+ * additionally kept in a time ordered index, so a single timer fires at the
+ * earliest expire time instead of the whole list being purged on every query.
+ */
+class Neighbors
+{
+public:
+  /**
+   * constructor
+   * \param delay the delay time for purging the list of neighbors
+   */
+  Neighbors (Time delay);
+  /// Time ordered index of neighbor expire times
+  typedef std::multimap<Time, Ipv4Address> ExpiryIndex;
+  /// Neighbor description
+  struct Neighbor
+  {
+    /// Neighbor IPv4 address
+    Ipv4Address m_neighborAddress;
+    /// Neighbor MAC address
+    Mac48Address m_hardwareAddress;
+    /// Neighbor expire time
+    Time m_expireTime;
+    /// Neighbor close indicator
+    bool close;
+    /// Position of this neighbor in the expiry index
+    ExpiryIndex::iterator m_expiryPos;
+
+    /**
+     * \brief Neighbor structure constructor
+     *
+     * \param ip Ipv4Address entry
+     * \param mac Mac48Address entry
+     * \param t Time expire time
+     */
+    Neighbor (Ipv4Address ip, Mac48Address mac, Time t)
+      : m_neighborAddress (ip),
+        m_hardwareAddress (mac),
+        m_expireTime (t),
+        close (false)
+    {
+    }
+  };
+  /**
+   * Return expire time for neighbor node with address addr, if exists, else return 0.
+   * \param addr the IP address of the neighbor node
+   * \returns the expire time for the neighbor node
+   */
+  Time GetExpireTime (Ipv4Address addr);
+  /**
+   * Check that node with address addr is neighbor
+   * \param addr the IP address to check
+   * \returns true if the node with IP address is a neighbor
+   */
+  bool IsNeighbor (Ipv4Address addr);
+  /**
+   * Update expire time for entry with address addr, if it exists, else add new entry
+   * \param addr the IP address to check
+   * \param expire the expire time for the address
+   */
+  void Update (Ipv4Address addr, Time expire);
+  /// Remove all expired entries
+  void Purge ();
+  /// Schedule m_ntimer at the earliest neighbor expire time.
+  void ScheduleTimer ();
+  /// Remove all entries
+  void Clear ()
+  {
+    m_nb.clear ();
+    m_expiry.clear ();
+    m_ntimer.Cancel ();
+  }
+
+  /**
+   * Add ARP cache to be used to allow layer 2 notifications processing
+   * \param a pointer to the ARP cache to add
+   */
+  void AddArpCache (Ptr<ArpCache> a);
+  /**
+   * Don't use given ARP cache any more (interface is down)
+   * \param a pointer to the ARP cache to delete
+   */
+  void DelArpCache (Ptr<ArpCache> a);
+  /**
+   * Get callback to ProcessTxError
+   * \returns the callback function
+   */
+  Callback<void, WifiMacHeader const &> GetTxErrorCallback () const
+  {
+    return m_txErrorCallback;
+  }
+
+  /**
+   * Set link failure callback
+   * \param cb the callback function
+   */
+  void SetCallback (Callback<void, Ipv4Address> cb)
+  {
+    m_handleLinkFailure = cb;
+  }
+  /**
+   * Get link failure callback
+   * \returns the link failure callback
+   */
+  Callback<void, Ipv4Address> GetCallback () const
+  {
+    return m_handleLinkFailure;
+  }
+
+private:
+  /// link failure callback
+  Callback<void, Ipv4Address> m_handleLinkFailure;
+  /// TX error callback
+  Callback<void, WifiMacHeader const &> m_txErrorCallback;
+  /// Timer for neighbor's list. Schedule Purge().
+  Timer m_ntimer;
+  /// neighbors indexed by IP address
+  std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash> m_nb;
+  /// neighbor expire times in increasing order
+  ExpiryIndex m_expiry;
+  /// list of ARP cached to be used for layer 2 notifications processing
+  std::vector<Ptr<ArpCache> > m_arp;
+  /// index in m_arp of the ARP cache which resolved the last address
+  uint32_t m_lastArpHit;
+
+  /**
+   * Remove neighbor from the table and notify about link failure
+   * \param i the neighbor to remove
+   */
+  void CloseLink (std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash>::iterator i);
+
+  /**
+   * Find MAC address by IP using list of ARP caches. The cache which
+   * answered the previous lookup is tried first.
+   * 
+   * \param addr the IP address to lookup
+   * \returns the MAC address for the IP address
+   */
+  Mac48Address LookupMacAddress (Ipv4Address addr);
+  /// Process layer 2 TX error notification
+  void ProcessTxError (WifiMacHeader const &);
+};
+
+}  // namespace aodv
+}  // namespace ns3
+
+#endif /* AODVNEIGHBOR_H */
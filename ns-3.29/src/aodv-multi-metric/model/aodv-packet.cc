@@ -0,0 +1,1197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Based on
+ *      NS-2 AODV model developed by the CMU/MONARCH group and optimized and
+ *      tuned by Samir Das and Mahesh Marina, University of Cincinnati;
+ * 
+ *      AODV-UU implementation by Erik Nordström of Uppsala University
+ *      http://core.it.uu.se/core/index.php/AODV-UU
+ *
+ * Authors: Elena Buchatskaia <borovkovaes@iitp.ru>
+ *          Pavel Boyko <boyko@iitp.ru>
+ *
+ * Modified by: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtic@gmail.com>
+ *              Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+#include <algorithm>
+#include "aodv-packet.h"
+#include "ns3/address-utils.h"
+#include "ns3/packet.h"
+#include "ns3/abort.h"
+
+namespace ns3 {
+namespace aodv {
+
+NS_OBJECT_ENSURE_REGISTERED (TypeHeader);
+
+TypeHeader::TypeHeader (MessageType t)
+  : m_type (t),
+    m_valid (true)
+{
+}
+
+TypeId
+TypeHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::TypeHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<TypeHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+TypeHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+TypeHeader::GetSerializedSize () const
+{
+  return 1;
+}
+
+void
+TypeHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteU8 ((uint8_t) m_type);
+}
+
+uint32_t
+TypeHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  uint8_t type = i.ReadU8 ();
+  m_valid = true;
+  switch (type)
+    {
+    case AODVTYPE_RREQ:
+    case AODVTYPE_RREP:
+    case AODVTYPE_RERR:
+    case AODVTYPE_RREP_ACK:
+    case AODVTYPE_LPP:
+      {
+        m_type = (MessageType) type;
+        break;
+      }
+    default:
+      m_valid = false;
+    }
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+TypeHeader::Print (std::ostream &os) const
+{
+  switch (m_type)
+    {
+    case AODVTYPE_RREQ:
+      {
+        os << "RREQ";
+        break;
+      }
+    case AODVTYPE_RREP:
+      {
+        os << "RREP";
+        break;
+      }
+    case AODVTYPE_RERR:
+      {
+        os << "RERR";
+        break;
+      }
+    case AODVTYPE_RREP_ACK:
+      {
+        os << "RREP_ACK";
+        break;
+      }    
+    case AODVTYPE_LPP:
+      {
+        os << "LPP";
+        break;
+      }
+    default:
+      os << "UNKNOWN_TYPE";
+    }
+}
+
+bool
+TypeHeader::operator== (TypeHeader const & o) const
+{
+  return (m_type == o.m_type && m_valid == o.m_valid);
+}
+
+std::ostream &
+operator<< (std::ostream & os, TypeHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
+//-----------------------------------------------------------------------------
+// RREQ
+//-----------------------------------------------------------------------------
+RreqHeader::RreqHeader (uint8_t flags, uint8_t reserved, uint8_t hopCount, uint32_t requestID, Ipv4Address dst,
+                        uint32_t dstSeqNo, Ipv4Address origin, uint32_t originSeqNo, uint32_t etxMetric)
+  : m_flags (flags),
+    m_reserved (reserved),
+    m_hopCount (hopCount),
+    m_requestID (requestID),
+    m_dst (dst),
+    m_dstSeqNo (dstSeqNo),
+    m_origin (origin),
+    m_originSeqNo (originSeqNo),
+    m_etxMetric (etxMetric)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (RreqHeader);
+
+TypeId
+RreqHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::RreqHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<RreqHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RreqHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RreqHeader::GetSerializedSize () const
+{
+  if (GetEtxEncoding () == ETX_ENCODING_32BIT)
+    {
+      return (23+4); // ETX field is 4B
+    }
+  return (23); // 1B ETX field is embedded in reserved flag bits, or there is no ETX field
+}
+
+void
+RreqHeader::Serialize (Buffer::Iterator i) const
+{
+  uint8_t encoding = GetEtxEncoding ();
+  i.WriteU8 (m_flags);
+  if (encoding == ETX_ENCODING_8BIT)
+    {
+      NS_ASSERT_MSG (m_etxMetric <= UINT8_MAX, "ETX doesn't fit in 1B ETX field");
+      i.WriteU8 ((uint8_t)m_etxMetric); // ETX field is embedded in reserved flag bits
+    }
+  else
+    {
+      i.WriteU8 (m_reserved);
+    }
+  i.WriteU8 (m_hopCount);
+  i.WriteHtonU32 (m_requestID);
+  WriteTo (i, m_dst);
+  i.WriteHtonU32 (m_dstSeqNo);
+  WriteTo (i, m_origin);
+  i.WriteHtonU32 (m_originSeqNo);
+  if (encoding == ETX_ENCODING_32BIT)
+    {
+      i.WriteHtonU32 (m_etxMetric);
+    }
+}
+
+uint32_t
+RreqHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_flags = i.ReadU8 ();
+  uint8_t encoding = GetEtxEncoding ();
+  m_reserved = 0;
+  if (encoding == ETX_ENCODING_8BIT)
+    {
+      m_etxMetric = i.ReadU8 ();
+    }
+  else
+    {
+      m_reserved = i.ReadU8 ();
+    }
+  m_hopCount = i.ReadU8 ();
+  m_requestID = i.ReadNtohU32 ();
+  ReadFrom (i, m_dst);
+  m_dstSeqNo = i.ReadNtohU32 ();
+  ReadFrom (i, m_origin);
+  m_originSeqNo = i.ReadNtohU32 ();
+  if (encoding == ETX_ENCODING_32BIT)
+    {
+      m_etxMetric = i.ReadNtohU32 ();
+    }
+  else if (encoding == ETX_ENCODING_NONE)
+    {
+      m_etxMetric = m_hopCount; // hop count metric
+    }
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+RreqHeader::Print (std::ostream &os) const
+{
+  os << "RREQ ID " << m_requestID << " destination: ipv4 " << m_dst
+     << " sequence number " << m_dstSeqNo << " source: ipv4 "
+     << m_origin << " sequence number " << m_originSeqNo
+     << " ETX metric " << m_etxMetric
+     << " flags:" << " Gratuitous RREP " << (*this).GetGratuitousRrep ()
+     << " Destination only " << (*this).GetDestinationOnly ()
+     << " Unknown sequence number " << (*this).GetUnknownSeqno ();
+}
+
+std::ostream &
+operator<< (std::ostream & os, RreqHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
+void
+RreqHeader::SetGratuitousRrep (bool f)
+{
+  if (f)
+    {
+      m_flags |= (1 << 5);
+    }
+  else
+    {
+      m_flags &= ~(1 << 5);
+    }
+}
+
+bool
+RreqHeader::GetGratuitousRrep () const
+{
+  return (m_flags & (1 << 5));
+}
+
+void
+RreqHeader::SetDestinationOnly (bool f)
+{
+  if (f)
+    {
+      m_flags |= (1 << 4);
+    }
+  else
+    {
+      m_flags &= ~(1 << 4);
+    }
+}
+
+bool
+RreqHeader::GetDestinationOnly () const
+{
+  return (m_flags & (1 << 4));
+}
+
+void
+RreqHeader::SetUnknownSeqno (bool f)
+{
+  if (f)
+    {
+      m_flags |= (1 << 3);
+    }
+  else
+    {
+      m_flags &= ~(1 << 3);
+    }
+}
+
+bool
+RreqHeader::GetUnknownSeqno () const
+{
+  return (m_flags & (1 << 3));
+}
+
+void
+RreqHeader::SetEtxEncoding (uint8_t encoding)
+{
+  m_flags = (uint8_t)((m_flags & ~0x03) | (encoding & 0x03));
+}
+
+uint8_t
+RreqHeader::GetEtxEncoding () const
+{
+  return (m_flags & 0x03);
+}
+
+bool
+RreqHeader::operator== (RreqHeader const & o) const
+{
+  return (m_flags == o.m_flags && m_reserved == o.m_reserved
+          && m_hopCount == o.m_hopCount && m_requestID == o.m_requestID
+          && m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo
+          && m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo
+          && m_etxMetric == o.m_etxMetric);
+}
+
+//-----------------------------------------------------------------------------
+// RREP
+//-----------------------------------------------------------------------------
+
+RrepHeader::RrepHeader (uint8_t prefixSize, uint8_t hopCount, Ipv4Address dst,
+                        uint32_t dstSeqNo, Ipv4Address origin, Time lifeTime, uint32_t etxMetric)
+  : m_flags (0),
+    m_prefixSize (prefixSize),
+    m_hopCount (hopCount),
+    m_dst (dst),
+    m_dstSeqNo (dstSeqNo),
+    m_origin (origin),
+    m_etxMetric (etxMetric)
+{
+  m_lifeTime = uint32_t (lifeTime.GetMilliSeconds ());
+}
+
+NS_OBJECT_ENSURE_REGISTERED (RrepHeader);
+
+TypeId
+RrepHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::RrepHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<RrepHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RrepHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RrepHeader::GetSerializedSize () const
+{
+  switch (GetEtxEncoding ())
+    {
+    case ETX_ENCODING_32BIT:
+      return 19+4; // ETX field is 4B added at the end of RREP
+    case ETX_ENCODING_8BIT:
+      return 19+1; // ETX field is 1B added at the end of RREP
+    default:
+      return 19;
+    }
+}
+
+void
+RrepHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteU8 (m_flags);
+  i.WriteU8 (m_prefixSize);
+  i.WriteU8 (m_hopCount);
+  WriteTo (i, m_dst);
+  i.WriteHtonU32 (m_dstSeqNo);
+  WriteTo (i, m_origin);
+  i.WriteHtonU32 (m_lifeTime);
+  uint8_t encoding = GetEtxEncoding ();
+  if (encoding == ETX_ENCODING_32BIT)
+    {
+      i.WriteHtonU32 (m_etxMetric);
+    }
+  else if (encoding == ETX_ENCODING_8BIT)
+    {
+      NS_ASSERT_MSG (m_etxMetric <= UINT8_MAX, "ETX doesn't fit in 1B ETX field");
+      i.WriteU8 ((uint8_t)m_etxMetric);
+    }
+}
+
+uint32_t
+RrepHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  m_flags = i.ReadU8 ();
+  m_prefixSize = i.ReadU8 ();
+  m_hopCount = i.ReadU8 ();
+  ReadFrom (i, m_dst);
+  m_dstSeqNo = i.ReadNtohU32 ();
+  ReadFrom (i, m_origin);
+  m_lifeTime = i.ReadNtohU32 ();
+  uint8_t encoding = GetEtxEncoding ();
+  if (encoding == ETX_ENCODING_32BIT)
+    {
+      m_etxMetric = i.ReadNtohU32 ();
+    }
+  else if (encoding == ETX_ENCODING_8BIT)
+    {
+      m_etxMetric = i.ReadU8 ();
+    }
+  else
+    {
+      m_etxMetric = m_hopCount; // hop count metric
+    }
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+RrepHeader::Print (std::ostream &os) const
+{
+  os << "destination: ipv4 " << m_dst << " sequence number " << m_dstSeqNo;
+  if (m_prefixSize != 0)
+    {
+      os << " prefix size " << m_prefixSize;
+    }
+  os << " source ipv4 " << m_origin << " lifetime " << m_lifeTime
+     << " ETX metric " << m_etxMetric
+     << " acknowledgment required flag " << (*this).GetAckRequired ()
+     << " gratuitous flag " << (*this).GetGratuitous ();
+}
+
+void
+RrepHeader::SetLifeTime (Time t)
+{
+  m_lifeTime = t.GetMilliSeconds ();
+}
+
+Time
+RrepHeader::GetLifeTime () const
+{
+  Time t (MilliSeconds (m_lifeTime));
+  return t;
+}
+
+void
+RrepHeader::SetAckRequired (bool f)
+{
+  if (f)
+    {
+      m_flags |= (1 << 6);
+    }
+  else
+    {
+      m_flags &= ~(1 << 6);
+    }
+}
+
+bool
+RrepHeader::GetAckRequired () const
+{
+  return (m_flags & (1 << 6));
+}
+
+void
+RrepHeader::SetGratuitous (bool f)
+{
+  if (f)
+    {
+      m_flags |= (1 << 5);
+    }
+  else
+    {
+      m_flags &= ~(1 << 5);
+    }
+}
+
+bool
+RrepHeader::GetGratuitous () const
+{
+  return (m_flags & (1 << 5));
+}
+
+void
+RrepHeader::SetPrefixSize (uint8_t sz)
+{
+  m_prefixSize = sz;
+}
+
+uint8_t
+RrepHeader::GetPrefixSize () const
+{
+  return m_prefixSize;
+}
+
+void
+RrepHeader::SetEtxEncoding (uint8_t encoding)
+{
+  m_flags = (uint8_t)((m_flags & ~0x03) | (encoding & 0x03));
+}
+
+uint8_t
+RrepHeader::GetEtxEncoding () const
+{
+  return (m_flags & 0x03);
+}
+
+bool
+RrepHeader::operator== (RrepHeader const & o) const
+{
+  return (m_flags == o.m_flags && m_prefixSize == o.m_prefixSize
+          && m_hopCount == o.m_hopCount && m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo
+          && m_origin == o.m_origin && m_lifeTime == o.m_lifeTime
+          && m_etxMetric == o.m_etxMetric);
+}
+
+void
+RrepHeader::SetHello (Ipv4Address origin, uint32_t srcSeqNo, Time lifetime)
+{
+  m_flags &= 0x03; // keep ETX encoding
+  m_prefixSize = 0;
+  m_hopCount = 0;
+  m_dst = origin;
+  m_dstSeqNo = srcSeqNo;
+  m_origin = origin;
+  m_lifeTime = lifetime.GetMilliSeconds ();
+  m_etxMetric = 0;
+}
+
+std::ostream &
+operator<< (std::ostream & os, RrepHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
+//-----------------------------------------------------------------------------
+// RREP-ACK
+//-----------------------------------------------------------------------------
+
+RrepAckHeader::RrepAckHeader ()
+  : m_reserved (0)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (RrepAckHeader);
+
+TypeId
+RrepAckHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::RrepAckHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<RrepAckHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RrepAckHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RrepAckHeader::GetSerializedSize () const
+{
+  return 1;
+}
+
+void
+RrepAckHeader::Serialize (Buffer::Iterator i ) const
+{
+  i.WriteU8 (m_reserved);
+}
+
+uint32_t
+RrepAckHeader::Deserialize (Buffer::Iterator start )
+{
+  Buffer::Iterator i = start;
+  m_reserved = i.ReadU8 ();
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+RrepAckHeader::Print (std::ostream &os ) const
+{
+}
+
+bool
+RrepAckHeader::operator== (RrepAckHeader const & o ) const
+{
+  return m_reserved == o.m_reserved;
+}
+
+std::ostream &
+operator<< (std::ostream & os, RrepAckHeader const & h )
+{
+  h.Print (os);
+  return os;
+}
+
+//-----------------------------------------------------------------------------
+// RERR
+//-----------------------------------------------------------------------------
+RerrHeader::RerrHeader ()
+  : m_flag (0),
+    m_reserved (0)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (RerrHeader);
+
+TypeId
+RerrHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::RerrHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<RerrHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RerrHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RerrHeader::GetSerializedSize () const
+{
+  return (3 + 8 * GetDestCount ());
+}
+
+void
+RerrHeader::Serialize (Buffer::Iterator i ) const
+{
+  i.WriteU8 (m_flag);
+  i.WriteU8 (m_reserved);
+  i.WriteU8 (GetDestCount ());
+  std::map<Ipv4Address, uint32_t>::const_iterator j;
+  for (j = m_unreachableDstSeqNo.begin (); j != m_unreachableDstSeqNo.end (); ++j)
+    {
+      WriteTo (i, (*j).first);
+      i.WriteHtonU32 ((*j).second);
+    }
+}
+
+uint32_t
+RerrHeader::Deserialize (Buffer::Iterator start )
+{
+  Buffer::Iterator i = start;
+  m_flag = i.ReadU8 ();
+  m_reserved = i.ReadU8 ();
+  uint8_t dest = i.ReadU8 ();
+  m_unreachableDstSeqNo.clear ();
+  Ipv4Address address;
+  uint32_t seqNo;
+  for (uint8_t k = 0; k < dest; ++k)
+    {
+      ReadFrom (i, address);
+      seqNo = i.ReadNtohU32 ();
+      m_unreachableDstSeqNo.insert (std::make_pair (address, seqNo));
+    }
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+RerrHeader::Print (std::ostream &os ) const
+{
+  os << "Unreachable destination (ipv4 address, seq. number):";
+  std::map<Ipv4Address, uint32_t>::const_iterator j;
+  for (j = m_unreachableDstSeqNo.begin (); j != m_unreachableDstSeqNo.end (); ++j)
+    {
+      os << (*j).first << ", " << (*j).second;
+    }
+  os << "No delete flag " << (*this).GetNoDelete ();
+}
+
+void
+RerrHeader::SetNoDelete (bool f )
+{
+  if (f)
+    {
+      m_flag |= (1 << 7); // BUG: bit 7, not bit 0 like it was in original implementation
+    }
+  else
+    {
+      m_flag &= ~(1 << 7); // BUG: bit 7, not bit 0 like it was in original implementation
+    }
+}
+
+bool
+RerrHeader::GetNoDelete () const
+{
+  return (m_flag & (1 << 7)); // BUG: bit 7, not bit 0 like it was in original implementation
+}
+
+bool
+RerrHeader::AddUnDestination (Ipv4Address dst, uint32_t seqNo )
+{
+  if (m_unreachableDstSeqNo.find (dst) != m_unreachableDstSeqNo.end ())
+    {
+      return true;
+    }
+
+  NS_ASSERT (GetDestCount () < 255); // can't support more than 255 destinations in single RERR
+  m_unreachableDstSeqNo.insert (std::make_pair (dst, seqNo));
+  return true;
+}
+
+bool
+RerrHeader::RemoveUnDestination (std::pair<Ipv4Address, uint32_t> & un )
+{
+  if (m_unreachableDstSeqNo.empty ())
+    {
+      return false;
+    }
+  std::map<Ipv4Address, uint32_t>::iterator i = m_unreachableDstSeqNo.begin ();
+  un = *i;
+  m_unreachableDstSeqNo.erase (i);
+  return true;
+}
+
+void
+RerrHeader::Clear ()
+{
+  m_unreachableDstSeqNo.clear ();
+  m_flag = 0;
+  m_reserved = 0;
+}
+
+bool
+RerrHeader::operator== (RerrHeader const & o ) const
+{
+  if (m_flag != o.m_flag || m_reserved != o.m_reserved || GetDestCount () != o.GetDestCount ())
+    {
+      return false;
+    }
+
+  std::map<Ipv4Address, uint32_t>::const_iterator j = m_unreachableDstSeqNo.begin ();
+  std::map<Ipv4Address, uint32_t>::const_iterator k = o.m_unreachableDstSeqNo.begin ();
+  for (uint8_t i = 0; i < GetDestCount (); ++i)
+    {
+      if ((j->first != k->first) || (j->second != k->second))
+        {
+          return false;
+        }
+
+      j++;
+      k++;
+    }
+  return true;
+}
+
+std::ostream &
+operator<< (std::ostream & os, RerrHeader const & h )
+{
+  h.Print (os);
+  return os;
+}
+//-----------------------------------------------------------------------------
+// LPP
+//----------------------------------------------------------------------
+LppHeader::LppHeader ()
+  : m_lppId (0),
+    m_version (LPP_PLAIN),
+    m_originSeqno (0),
+    m_maxLppCnt (0),
+    m_lppInterval (0),
+    m_listSeqNo (0),
+    m_fullList (true),
+    m_fullListRequest (false)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (LppHeader);
+
+TypeId
+LppHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::LppHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Aodv")
+    .AddConstructor<LppHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+LppHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint8_t
+LppHeader::GetEncodingVersion () const
+{
+  if (m_version == LPP_NO_LIST || m_version == LPP_DELTA)
+    {
+      return m_version;
+    }
+  // Plain encoding has 8 bit number of neighbors, so larger lists fall back to compact encoding
+  if ((m_version == LPP_COMPACT || GetNumberNeighbors () > 255) && m_maxLppCnt <= 0x0F)
+    {
+      return LPP_COMPACT;
+    }
+  return LPP_PLAIN;
+}
+
+void
+LppHeader::SetLppInterval (Time interval)
+{
+  int64_t units = (interval.GetMilliSeconds () + 50) / 100;
+  m_lppInterval = (uint8_t)std::min<int64_t> (std::max<int64_t> (units, 0), 255);
+  if (m_lppInterval == 0 && interval.IsStrictlyPositive ())
+    {
+      m_lppInterval = 1;
+    }
+}
+
+Time
+LppHeader::GetLppInterval () const
+{
+  return MilliSeconds (100 * (uint32_t)m_lppInterval);
+}
+
+uint32_t
+LppHeader::GetSerializedSize () const
+{
+  uint32_t intervalSize = (m_lppInterval != 0) ? 1 : 0;
+  if (GetEncodingVersion () == LPP_NO_LIST)
+    {
+      return (9 + intervalSize);
+    }
+  if (GetEncodingVersion () == LPP_PLAIN)
+    {
+      return (10 + intervalSize + 5 * GetNumberNeighbors ());
+    }
+  // 2B prefix and 2B number of neighbors per group, 2B suffix and half byte count per neighbor
+  uint32_t size = 11 + intervalSize;
+  if (GetEncodingVersion () == LPP_DELTA)
+    {
+      size += 1; // flags and list sequence number
+    }
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j = m_neighborsLppCnt.begin ();
+  while (j != m_neighborsLppCnt.end ())
+    {
+      uint16_t prefix = (uint16_t)(j->first.Get () >> 16);
+      uint32_t m = 0;
+      for (; j != m_neighborsLppCnt.end () && (uint16_t)(j->first.Get () >> 16) == prefix; ++j)
+        {
+          ++m;
+        }
+      size += 4 + 2 * m + (m + 1) / 2;
+    }
+  return size;
+}
+
+void
+LppHeader::Serialize (Buffer::Iterator i ) const
+{
+  uint8_t version = GetEncodingVersion ();
+  uint8_t intervalFlag = (m_lppInterval != 0) ? 0x80 : 0x00;
+  i.WriteU8 (intervalFlag | (uint8_t)(version << 4) | (m_lppId & 0x0F));
+  WriteTo (i, m_originAddr);
+  i.WriteHtonU32 (m_originSeqno);
+  if (intervalFlag)
+    {
+      i.WriteU8 (m_lppInterval);
+    }
+  if (version == LPP_NO_LIST)
+    {
+      return;
+    }
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j;
+  if (version == LPP_PLAIN)
+    {
+      NS_ABORT_MSG_IF (GetNumberNeighbors () > 255, "Can't support more than 2^8 - 1 neighbors in plain LPP");
+      i.WriteU8 ((uint8_t)GetNumberNeighbors ());
+      for (j = m_neighborsLppCnt.begin (); j != m_neighborsLppCnt.end (); ++j)
+        {
+          WriteTo (i, (*j).first);
+          i.WriteU8 ((*j).second);
+        }
+      return;
+    }
+  if (version == LPP_DELTA)
+    {
+      NS_ASSERT_MSG (m_maxLppCnt <= 0x0F, "Delta LPP supports only 4 bit LPP counts");
+      i.WriteU8 ((m_fullList ? 0x80 : 0x00) | (m_fullListRequest ? 0x40 : 0x00) | (m_listSeqNo & 0x3F));
+    }
+  i.WriteHtonU16 (GetNumberNeighbors ());
+  j = m_neighborsLppCnt.begin ();
+  while (j != m_neighborsLppCnt.end ())
+    {
+      // List is sorted, so neighbors with the same prefix are adjacent
+      uint16_t prefix = (uint16_t)(j->first.Get () >> 16);
+      std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator end = j;
+      uint16_t m = 0;
+      for (; end != m_neighborsLppCnt.end () && (uint16_t)(end->first.Get () >> 16) == prefix; ++end)
+        {
+          ++m;
+        }
+      i.WriteHtonU16 (prefix);
+      i.WriteHtonU16 (m);
+      for (std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator k = j; k != end; ++k)
+        {
+          i.WriteHtonU16 ((uint16_t)(k->first.Get () & 0xFFFF));
+        }
+      for (std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator k = j; k != end; )
+        {
+          uint8_t counts = (uint8_t)(k->second << 4);
+          if (++k != end)
+            {
+              counts |= k->second & 0x0F;
+              ++k;
+            }
+          i.WriteU8 (counts);
+        }
+      j = end;
+    }
+}
+
+/**
+ * \brief Compare addresses of two neighbor list entries
+ * \param a the first neighbor list entry
+ * \param b the second neighbor list entry
+ * \return true if address of a is less than address of b
+ */
+static bool
+NeighborLppCntAddressLess (const std::pair<Ipv4Address, uint8_t> & a, const std::pair<Ipv4Address, uint8_t> & b)
+{
+  return a.first < b.first;
+}
+
+/**
+ * \brief Check that two neighbor list entries have the same address
+ * \param a the first neighbor list entry
+ * \param b the second neighbor list entry
+ * \return true if the addresses are equal
+ */
+static bool
+NeighborLppCntAddressEqual (const std::pair<Ipv4Address, uint8_t> & a, const std::pair<Ipv4Address, uint8_t> & b)
+{
+  return a.first == b.first;
+}
+
+uint32_t
+LppHeader::Deserialize (Buffer::Iterator start )
+{
+  Buffer::Iterator i = start;
+  uint8_t idAndVersion = i.ReadU8 ();
+  m_lppId = idAndVersion & 0x0F;
+  m_version = (idAndVersion >> 4) & 0x07;
+  ReadFrom (i, m_originAddr);
+  m_originSeqno = i.ReadNtohU32 ();
+  m_lppInterval = (idAndVersion & 0x80) ? i.ReadU8 () : 0;
+  m_neighborsLppCnt.clear ();
+  m_maxLppCnt = 0;
+  bool sorted = true;
+  if (m_version == LPP_NO_LIST)
+    {
+      // only reverse LPP count is used, there is no list of neighbors
+    }
+  else if (m_version == LPP_PLAIN)
+    {
+      uint8_t numberNeighbors = i.ReadU8 ();
+      m_neighborsLppCnt.reserve (numberNeighbors);
+      Ipv4Address neighborAddr;
+      uint8_t lppCnt;
+      for (uint8_t k = 0; k < numberNeighbors; ++k)
+        {
+          ReadFrom (i, neighborAddr);
+          lppCnt = i.ReadU8 ();
+          sorted = sorted && (m_neighborsLppCnt.empty () || m_neighborsLppCnt.back ().first < neighborAddr);
+          m_neighborsLppCnt.push_back (std::make_pair (neighborAddr, lppCnt));
+          m_maxLppCnt = std::max (m_maxLppCnt, lppCnt);
+        }
+    }
+  else
+    {
+      NS_ASSERT_MSG (m_version == LPP_COMPACT || m_version == LPP_DELTA, "Unknown LPP version " << (uint16_t)m_version);
+      if (m_version == LPP_DELTA)
+        {
+          uint8_t flags = i.ReadU8 ();
+          m_fullList = (flags & 0x80) != 0;
+          m_fullListRequest = (flags & 0x40) != 0;
+          m_listSeqNo = flags & 0x3F;
+        }
+      uint16_t numberNeighbors = i.ReadNtohU16 ();
+      m_neighborsLppCnt.reserve (numberNeighbors);
+      while (m_neighborsLppCnt.size () < numberNeighbors)
+        {
+          uint32_t prefix = (uint32_t)i.ReadNtohU16 () << 16;
+          uint16_t m = i.ReadNtohU16 ();
+          std::size_t first = m_neighborsLppCnt.size ();
+          for (uint16_t k = 0; k < m; ++k)
+            {
+              Ipv4Address neighborAddr (prefix | i.ReadNtohU16 ());
+              sorted = sorted && (m_neighborsLppCnt.empty () || m_neighborsLppCnt.back ().first < neighborAddr);
+              m_neighborsLppCnt.push_back (std::make_pair (neighborAddr, 0));
+            }
+          for (uint16_t k = 0; k < m; k += 2)
+            {
+              uint8_t counts = i.ReadU8 ();
+              m_neighborsLppCnt[first + k].second = counts >> 4;
+              if (k + 1 < m)
+                {
+                  m_neighborsLppCnt[first + k + 1].second = counts & 0x0F;
+                }
+              m_maxLppCnt = std::max (m_maxLppCnt, (uint8_t)std::max (counts >> 4, counts & 0x0F));
+            }
+          if (m == 0)
+            {
+              break; // malformed group, avoid endless loop
+            }
+        }
+    }
+  // Sender serializes sorted list, so sorting is needed only for foreign senders
+  if (!sorted)
+    {
+      // Like AddToNeighborsList, the first entry of a duplicated neighbor is kept
+      std::stable_sort (m_neighborsLppCnt.begin (), m_neighborsLppCnt.end (), NeighborLppCntAddressLess);
+      m_neighborsLppCnt.erase (std::unique (m_neighborsLppCnt.begin (), m_neighborsLppCnt.end (), NeighborLppCntAddressEqual),
+                               m_neighborsLppCnt.end ());
+      m_maxLppCnt = 0;
+      for (std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j = m_neighborsLppCnt.begin (); j != m_neighborsLppCnt.end (); ++j)
+        {
+          m_maxLppCnt = std::max (m_maxLppCnt, j->second);
+        }
+    }
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+LppHeader::Print (std::ostream &os ) const
+{
+  os << "Lpp ID: " << m_lppId << "Version: " << (uint16_t)m_version << "Originator IP address: " << m_originAddr;
+  os << "Originator Sequence number: " << m_originSeqno;
+  os << "LPP interval: " << GetLppInterval ().GetSeconds ();
+  os << "Number of neighbors: " <<  (*this).GetNumberNeighbors ();
+  os << "Neighbors (ipv4 address, received LPP count): ";
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j;
+  for (j = m_neighborsLppCnt.begin (); j != m_neighborsLppCnt.end (); ++j)
+    {
+      os << (*j).first << ", " << (*j).second;
+    }
+}
+
+/**
+ * \brief Compare neighbor list entry with IP address
+ * \param entry the neighbor list entry
+ * \param addr the IP address
+ * \return true if entry address is less than addr
+ */
+static bool
+NeighborLppCntLess (const std::pair<Ipv4Address, uint8_t> & entry, Ipv4Address addr)
+{
+  return entry.first < addr;
+}
+
+bool
+LppHeader::AddToNeighborsList (Ipv4Address neighbor, uint8_t lppCnt)
+{
+  // Neighbors are usually added in increasing order, so append is the common case
+  std::vector<std::pair<Ipv4Address, uint8_t> >::iterator i = m_neighborsLppCnt.end ();
+  if (!m_neighborsLppCnt.empty () && !(m_neighborsLppCnt.back ().first < neighbor))
+  {
+    i = std::lower_bound (m_neighborsLppCnt.begin (), m_neighborsLppCnt.end (), neighbor, NeighborLppCntLess);
+    if (i->first == neighbor)
+    {
+      return true;
+    }
+  }
+
+  NS_ASSERT_MSG (GetNumberNeighbors () < 65535, "Can't support more than 2^16 - 1 neighbors");
+  m_neighborsLppCnt.insert (i, std::make_pair (neighbor, lppCnt));
+  m_maxLppCnt = std::max (m_maxLppCnt, lppCnt);
+  return true;
+}
+
+bool
+LppHeader::RemoveFromNeighborsList (std::pair<Ipv4Address, uint8_t> & un )
+{
+  if (m_neighborsLppCnt.empty ())
+  {
+    return false;
+  }
+
+  std::vector<std::pair<Ipv4Address, uint8_t> >::iterator i = m_neighborsLppCnt.begin ();
+  un = *i;
+  m_neighborsLppCnt.erase (i);
+  return true;
+}
+
+bool
+LppHeader::FindNeighborLppCnt (Ipv4Address neighbor, uint8_t & lppCnt) const
+{
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator i =
+    std::lower_bound (m_neighborsLppCnt.begin (), m_neighborsLppCnt.end (), neighbor, NeighborLppCntLess);
+  if (i == m_neighborsLppCnt.end () || i->first != neighbor)
+  {
+    return false;
+  }
+  lppCnt = i->second;
+  return true;
+}
+
+void
+LppHeader::ClearNeighborsList ()
+{
+  m_neighborsLppCnt.clear ();
+  m_maxLppCnt = 0;
+}
+
+bool
+LppHeader::operator== (LppHeader const & o ) const
+{
+  if (m_lppId != o.m_lppId || m_originAddr != o.m_originAddr || m_originSeqno != o.m_originSeqno || m_lppInterval != o.m_lppInterval || GetNumberNeighbors () != o.GetNumberNeighbors ()
+      || IsFullList () != o.IsFullList () || IsFullListRequested () != o.IsFullListRequested ()
+      || (m_version == LPP_DELTA && m_listSeqNo != o.m_listSeqNo))
+  {
+    return false;
+  }  
+
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator j = m_neighborsLppCnt.begin ();
+  std::vector<std::pair<Ipv4Address, uint8_t> >::const_iterator k = o.m_neighborsLppCnt.begin ();
+  for (uint16_t i = 0; i < GetNumberNeighbors (); ++i)
+    {
+      if ((j->first != k->first) || (j->second != k->second))
+      {
+        return false;
+      }
+      j++;
+      k++;
+    }
+  return true;
+}
+
+std::ostream &
+operator<< (std::ostream & os, LppHeader const & h )
+{
+  h.Print (os);
+  return os;
+}
+
+
+} // aodv namspace
+} // ns3 namespace
@@ -0,0 +1,956 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Based on
+ *      NS-2 AODV model developed by the CMU/MONARCH group and optimized and
+ *      tuned by Samir Das and Mahesh Marina, University of Cincinnati;
+ *
+ *      AODV-UU implementation by Erik Nordström of Uppsala University
+ *      http://core.it.uu.se/core/index.php/AODV-UU
+ *
+ * Authors: Elena Buchatskaia <borovkovaes@iitp.ru>
+ *          Pavel Boyko <boyko@iitp.ru>
+ *
+ * Modified by: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtic@gmail.com>
+ *              Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+#ifndef AODVPACKET_H
+#define AODVPACKET_H
+
+#include <iostream>
+#include "ns3/header.h"
+#include "ns3/enum.h"
+#include "ns3/ipv4-address.h"
+#include <map>
+#include <vector>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+* \ingroup aodv
+* \brief MessageType enumeration
+*/
+enum MessageType
+{
+  AODVTYPE_RREQ  = 1,    //!< AODVTYPE_RREQ
+  AODVTYPE_RREP  = 2,    //!< AODVTYPE_RREP
+  AODVTYPE_RERR  = 3,    //!< AODVTYPE_RERR
+  AODVTYPE_RREP_ACK = 4, //!< AODVTYPE_RREP_ACK
+  AODVTYPE_LPP = 5       //!< AODVTYPE_LPP
+};
+
+/**
+* \ingroup aodv
+* \brief AODV types
+*/
+class TypeHeader : public Header
+{
+public:
+  /**
+   * constructor
+   * \param t the AODV RREQ type
+   */
+  TypeHeader (MessageType t = AODVTYPE_RREQ);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * \returns the type
+   */
+  MessageType Get () const
+  {
+    return m_type;
+  }
+  /**
+   * Check that type if valid
+   * \returns true if the type is valid
+   */
+  bool IsValid () const
+  {
+    return m_valid;
+  }
+  /**
+   * \brief Comparison operator
+   * \param o header to compare
+   * \return true if the headers are equal
+   */
+  bool operator== (TypeHeader const & o) const;
+private:
+  MessageType m_type; ///< type of the message
+  bool m_valid; ///< Indicates if the message is valid
+};
+
+/**
+  * \brief Stream output operator
+  * \param os output stream
+  * \return updated stream
+  */
+std::ostream & operator<< (std::ostream & os, TypeHeader const & h);
+
+/**
+* \ingroup aodv
+* \brief ETX field encodings of RREQ and RREP
+*
+* Encoding is carried in the lowest 2 bits of RREQ and RREP flags, so nodes
+* running different metrics can parse each other's route discovery packets.
+*/
+enum EtxEncoding
+{
+  ETX_ENCODING_NONE = 0,  //!< no ETX field, ETX is equal to hop count (original AODV format)
+  ETX_ENCODING_8BIT = 1,  //!< 1 byte ETX (L-ETX, LR-ETX, PLR-ETX)
+  ETX_ENCODING_32BIT = 2  //!< 4 byte ETX appended at the end (ETX)
+};
+
+/**
+* \ingroup aodv
+* \brief   Route Request (RREQ) Message Format
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |J|R|G|D|U|-|Enc|   Reserved    |   Hop Count   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                            RREQ ID                            |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                    Destination IP Address                     |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                  Destination Sequence Number                  |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                    Originator IP Address                      |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                  Originator Sequence Number                   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                          ETX metric                           |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+ 
+  \endverbatim
+  Format above is ETX_ENCODING_32BIT. With ETX_ENCODING_8BIT the ETX field
+  takes the place of the reserved byte and the last 4 bytes are not sent.
+  With ETX_ENCODING_NONE there is no ETX field at all, and hop count is used
+  as ETX on reception.
+*/
+class RreqHeader : public Header
+{
+public:
+  /**
+   * constructor
+   *
+   * \param flags the message flags (0)
+   * \param reserved the reserved bits (0)
+   * \param hopCount the hop count
+   * \param requestID the request ID
+   * \param dst the destination IP address
+   * \param dstSeqNo the destination sequence number
+   * \param origin the origin IP address
+   * \param originSeqNo the origin sequence number
+   * \param etxMetric the ETX metric 
+   */
+   RreqHeader (uint8_t flags = 0, uint8_t reserved = 0, uint8_t hopCount = 0,
+              uint32_t requestID = 0, Ipv4Address dst = Ipv4Address (),
+              uint32_t dstSeqNo = 0, Ipv4Address origin = Ipv4Address (),
+              uint32_t originSeqNo = 0, uint32_t etxMetric = 0);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  // Fields
+  /**
+   * \brief Set the hop count
+   * \param count the hop count
+   */
+  void SetHopCount (uint8_t count)
+  {
+    m_hopCount = count;
+  }
+  /**
+   * \brief Get the hop count
+   * \return the hop count
+   */
+  uint8_t GetHopCount () const
+  {
+    return m_hopCount;
+  }
+  /**
+   * \brief Set the request ID
+   * \param id the request ID
+   */
+  void SetId (uint32_t id)
+  {
+    m_requestID = id;
+  }
+  /**
+   * \brief Get the request ID
+   * \return the request ID
+   */
+  uint32_t GetId () const
+  {
+    return m_requestID;
+  }
+  /**
+   * \brief Set the destination address
+   * \param a the destination address
+   */
+  void SetDst (Ipv4Address a)
+  {
+    m_dst = a;
+  }
+  /**
+   * \brief Get the destination address
+   * \return the destination address
+   */
+  Ipv4Address GetDst () const
+  {
+    return m_dst;
+  }
+  /**
+   * \brief Set the destination sequence number
+   * \param s the destination sequence number
+   */
+  void SetDstSeqno (uint32_t s)
+  {
+    m_dstSeqNo = s;
+  }
+  /**
+   * \brief Get the destination sequence number
+   * \return the destination sequence number
+   */
+  uint32_t GetDstSeqno () const
+  {
+    return m_dstSeqNo;
+  }
+  /**
+   * \brief Set the origin address
+   * \param a the origin address
+   */
+  void SetOrigin (Ipv4Address a)
+  {
+    m_origin = a;
+  }
+  /**
+   * \brief Get the origin address
+   * \return the origin address
+   */
+  Ipv4Address GetOrigin () const
+  {
+    return m_origin;
+  }
+
+  /**
+   * \brief Set the origin sequence number
+   * \param s the origin sequence number
+   */
+  void SetOriginSeqno (uint32_t s)
+  {
+    m_originSeqNo = s;
+  }
+
+  /**
+   * \brief Get the origin sequence number
+   * \return the origin sequence number
+   */
+  uint32_t GetOriginSeqno () const
+  {
+    return m_originSeqNo;
+  }
+
+  /**
+   * \brief Set the ETX metric
+   * \param the ETX metric
+   */ 
+  void SetEtx (uint32_t s) 
+  {
+	  m_etxMetric = s; 
+  }
+
+  /**
+   * \brief Get the ETX metric
+   * \return the ETX metric
+   */ 
+  uint32_t GetEtx () const 
+  { 
+     return m_etxMetric; 
+  }
+  /**
+   * \brief Set the encoding of the ETX field
+   * \param encoding the EtxEncoding
+   */
+  void SetEtxEncoding (uint8_t encoding);
+  /**
+   * \brief Get the encoding of the ETX field
+   * \return the EtxEncoding
+   */
+  uint8_t GetEtxEncoding () const;
+
+  // Flags
+  /**
+   * \brief Set the gratuitous RREP flag
+   * \param f the gratuitous RREP flag
+   */
+  void SetGratuitousRrep (bool f);
+  /**
+   * \brief Get the gratuitous RREP flag
+   * \return the gratuitous RREP flag
+   */
+  bool GetGratuitousRrep () const;
+  /**
+   * \brief Set the Destination only flag
+   * \param f the Destination only flag
+   */
+  void SetDestinationOnly (bool f);
+  /**
+   * \brief Get the Destination only flag
+   * \return the Destination only flag
+   */
+  bool GetDestinationOnly () const;
+  /**
+   * \brief Set the unknown sequence number flag
+   * \param f the unknown sequence number flag
+   */
+  void SetUnknownSeqno (bool f);
+  /**
+   * \brief Get the unknown sequence number flag
+   * \return the unknown sequence number flag
+   */
+  bool GetUnknownSeqno () const;
+
+  /**
+   * \brief Comparison operator
+   * \param o RREQ header to compare
+   * \return true if the RREQ headers are equal
+   */
+  bool operator== (RreqHeader const & o) const;
+private:
+  uint8_t        m_flags;          ///< |J|R|G|D|U| bit flags, see RFC, and ETX encoding
+  uint8_t        m_reserved;       ///< Not used (must be 0)
+  uint8_t        m_hopCount;       ///< Hop Count
+  uint32_t       m_requestID;      ///< RREQ ID
+  Ipv4Address    m_dst;            ///< Destination IP Address
+  uint32_t       m_dstSeqNo;       ///< Destination Sequence Number
+  Ipv4Address    m_origin;         ///< Originator IP Address
+  uint32_t       m_originSeqNo;    ///< Source Sequence Number
+  uint32_t       m_etxMetric;      ///< ETX metric
+};
+
+/**
+  * \brief Stream output operator
+  * \param os output stream
+  * \return updated stream
+  */
+std::ostream & operator<< (std::ostream & os, RreqHeader const &);
+
+/**
+* \ingroup aodv
+* \brief Route Reply (RREP) Message Format
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |R|A|Res|Enc|Reserved |Prefix Sz|   Hop Count   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                     Destination IP address                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                  Destination Sequence Number                  |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                    Originator IP address                      |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                           Lifetime                            |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                          ETX metric                           |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+  Format above is ETX_ENCODING_32BIT. With ETX_ENCODING_8BIT only 1 byte of
+  ETX is appended, and with ETX_ENCODING_NONE there is no ETX field at all.
+*/
+class RrepHeader : public Header
+{
+public:
+  /**
+   * constructor
+   *
+   * \param prefixSize the prefix size (0)
+   * \param hopCount the hop count (0)
+   * \param dst the destination IP address
+   * \param dstSeqNo the destination sequence number
+   * \param origin the origin IP address
+   * \param lifetime the lifetime
+   * \param the ETX metric
+   */
+  RrepHeader (uint8_t prefixSize = 0, uint8_t hopCount = 0, Ipv4Address dst =
+                Ipv4Address (), uint32_t dstSeqNo = 0, Ipv4Address origin =
+                Ipv4Address (), Time lifetime = MilliSeconds (0), uint32_t etxMetric = 0);
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  // Fields
+  /**
+   * \brief Set the hop count
+   * \param count the hop count
+   */
+  void SetHopCount (uint8_t count)
+  {
+    m_hopCount = count;
+  }
+  /**
+   * \brief Get the hop count
+   * \return the hop count
+   */
+  uint8_t GetHopCount () const
+  {
+    return m_hopCount;
+  }
+  /**
+   * \brief Set the destination address
+   * \param a the destination address
+   */
+  void SetDst (Ipv4Address a)
+  {
+    m_dst = a;
+  }
+  /**
+   * \brief Get the destination address
+   * \return the destination address
+   */
+  Ipv4Address GetDst () const
+  {
+    return m_dst;
+  }
+  /**
+   * \brief Set the destination sequence number
+   * \param s the destination sequence number
+   */
+  void SetDstSeqno (uint32_t s)
+  {
+    m_dstSeqNo = s;
+  }
+  /**
+   * \brief Get the destination sequence number
+   * \return the destination sequence number
+   */
+  uint32_t GetDstSeqno () const
+  {
+    return m_dstSeqNo;
+  }
+  /**
+   * \brief Set the origin address
+   * \param a the origin address
+   */
+  void SetOrigin (Ipv4Address a)
+  {
+    m_origin = a;
+  }
+  /**
+   * \brief Get the origin address
+   * \return the origin address
+   */
+  Ipv4Address GetOrigin () const
+  {
+    return m_origin;
+  }
+  /**
+   * \brief Set the lifetime
+   * \param t the lifetime
+   */
+  void SetLifeTime (Time t);
+  /**
+   * \brief Get the lifetime
+   * \return the lifetime
+   */
+  Time GetLifeTime () const;
+
+  /**
+   * \brief Set the ETX metric
+   * \param s ETX metric
+   */
+  void SetEtx (uint32_t s) 
+  {
+	  m_etxMetric = s; 
+  }
+  /**
+   * \brief Get the ETX metric
+   * \return the ETX metric
+   */
+  uint32_t GetEtx () const 
+  {
+    return m_etxMetric; 
+  }
+  /**
+   * \brief Set the encoding of the ETX field
+   * \param encoding the EtxEncoding
+   */
+  void SetEtxEncoding (uint8_t encoding);
+  /**
+   * \brief Get the encoding of the ETX field
+   * \return the EtxEncoding
+   */
+  uint8_t GetEtxEncoding () const;
+
+  // Flags
+  /**
+   * \brief Set the ack required flag
+   * \param f the ack required flag
+   */
+  void SetAckRequired (bool f);
+  /**
+   * \brief get the ack required flag
+   * \return the ack required flag
+   */
+  bool GetAckRequired () const;
+  /**
+   * \brief Set the gratuitous flag, which marks a gratuitous RREP sent to the RREQ destination
+   * by an intermediate node (reserved bit 5)
+   * \param f the gratuitous flag
+   */
+  void SetGratuitous (bool f);
+  /**
+   * \brief Get the gratuitous flag
+   * \return the gratuitous flag
+   */
+  bool GetGratuitous () const;
+  /**
+   * \brief Set the prefix size
+   * \param sz the prefix size
+   */
+  void SetPrefixSize (uint8_t sz);
+  /**
+   * \brief Set the pefix size
+   * \return the prefix size
+   */
+  uint8_t GetPrefixSize () const;
+
+  /**
+   * Configure RREP to be a Hello message
+   *
+   * \param src the source IP address
+   * \param srcSeqNo the source sequence number
+   * \param lifetime the lifetime of the message
+   */
+  void SetHello (Ipv4Address src, uint32_t srcSeqNo, Time lifetime);
+
+  /**
+   * \brief Comparison operator
+   * \param o RREP header to compare
+   * \return true if the RREP headers are equal
+   */
+  bool operator== (RrepHeader const & o) const;
+private:
+  uint8_t       m_flags;            ///< A - acknowledgement required flag and ETX encoding
+  uint8_t       m_prefixSize;       ///< Prefix Size
+  uint8_t       m_hopCount;         ///< Hop Count
+  Ipv4Address   m_dst;              ///< Destination IP Address
+  uint32_t      m_dstSeqNo;         ///< Destination Sequence Number
+  Ipv4Address   m_origin;           ///< Source IP Address
+  uint32_t      m_lifeTime;         ///< Lifetime (in milliseconds)
+  uint32_t       m_etxMetric;        ///< ETX metric
+};
+
+/**
+  * \brief Stream output operator
+  * \param os output stream
+  * \return updated stream
+  */
+std::ostream & operator<< (std::ostream & os, RrepHeader const &);
+
+/**
+* \ingroup aodv
+* \brief Route Reply Acknowledgement (RREP-ACK) Message Format
+  \verbatim
+  0                   1
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |   Reserved    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+*/
+class RrepAckHeader : public Header
+{
+public:
+  /// constructor
+  RrepAckHeader ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * \brief Comparison operator
+   * \param o RREP header to compare
+   * \return true if the RREQ headers are equal
+   */
+  bool operator== (RrepAckHeader const & o) const;
+private:
+  uint8_t       m_reserved; ///< Not used (must be 0)
+};
+
+/**
+  * \brief Stream output operator
+  * \param os output stream
+  * \return updated stream
+  */
+std::ostream & operator<< (std::ostream & os, RrepAckHeader const &);
+
+
+/**
+* \ingroup aodv
+* \brief Route Error (RERR) Message Format
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |N|          Reserved           |   DestCount   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |            Unreachable Destination IP Address (1)             |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |         Unreachable Destination Sequence Number (1)           |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-|
+  |  Additional Unreachable Destination IP Addresses (if needed)  |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |Additional Unreachable Destination Sequence Numbers (if needed)|
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+*/
+class RerrHeader : public Header
+{
+public:
+  /// constructor
+  RerrHeader ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator i) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  // No delete flag
+  /**
+   * \brief Set the no delete flag
+   * \param f the no delete flag
+   */
+  void SetNoDelete (bool f);
+  /**
+   * \brief Get the no delete flag
+   * \return the no delete flag
+   */
+  bool GetNoDelete () const;
+
+  /**
+   * \brief Add unreachable node address and its sequence number in RERR header
+   * \param dst unreachable IPv4 address
+   * \param seqNo unreachable sequence number
+   * \return false if we already added maximum possible number of unreachable destinations
+   */
+  bool AddUnDestination (Ipv4Address dst, uint32_t seqNo);
+  /**
+   * \brief Delete pair (address + sequence number) from REER header, if the number of unreachable destinations > 0
+   * \param un unreachable pair (address + sequence number)
+   * \return true on success
+   */
+  bool RemoveUnDestination (std::pair<Ipv4Address, uint32_t> & un);
+  /// Clear header
+  void Clear ();
+  /**
+   * \returns number of unreachable destinations in RERR message
+   */
+  uint8_t GetDestCount () const
+  {
+    return (uint8_t)m_unreachableDstSeqNo.size ();
+  }
+
+  /**
+   * \brief Comparison operator
+   * \param o RERR header to compare
+   * \return true if the RERR headers are equal
+   */
+  bool operator== (RerrHeader const & o) const;
+private:
+  uint8_t m_flag;            ///< No delete flag
+  uint8_t m_reserved;        ///< Not used (must be 0)
+
+  /// List of Unreachable destination: IP addresses and sequence numbers
+  std::map<Ipv4Address, uint32_t> m_unreachableDstSeqNo;
+};
+
+/**
+  * \brief Stream output operator
+  * \param os output stream
+  * \return updated stream
+  */
+std::ostream & operator<< (std::ostream & os, RerrHeader const &);
+
+/**
+* \ingroup aodv
+* \brief   Link probe packet (LPP) Message Format
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |     LPP ID    |     xxxxxxxxxxxxxxxxxxxxx     |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                   Originator IP Address                       |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                 Originator Sequence Number                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |Num. Neigh. (n)|    xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx     |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                 Neighbor IP Address (1)                      |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  | LPP cnt (1) |   xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                        ...                                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                 Neighbor IP Address (n)                      |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  | LPP cnt (2)   | xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   \endverbatim
+  Upper 4 bits of LPP ID field carry encoding version. Format above is version 0
+  (LPP_PLAIN). Version 1 (LPP_COMPACT) has 16 bit number of neighbors and groups
+  neighbors sharing the same /16 prefix. Each neighbor takes 2 byte host suffix
+  and 4 bit LPP count (counts are 1..10). Version 0 is sent instead whenever some
+  count doesn't fit in 4 bits. Version 2 (LPP_NO_LIST) is used by metrics based only
+  on reverse LPP count (LR-ETX, PLR-ETX), it ends after Originator Sequence Number.
+  Version 3 (LPP_DELTA) has the list of version 1, preceded by 1 byte field: full list
+  flag (F), full list request flag (R) and 6 bit list sequence number. If F is not set
+  the list holds only neighbors whose counts have changed since the previous LPP, count 0
+  means that the neighbor is removed from the list. R asks neighbors to send full list.
+  Highest bit of the LPP ID field (I) is set when the sender advertises its LPP interval,
+  the time until its next LPP, which is then carried in 1 byte field (in units of 100 ms)
+  after Originator Sequence Number, and the version takes only 3 bits:
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |I|Ver|LPP ID |     xxxxxxxxxxxxxxxxxxxxx     |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                   Originator IP Address                       |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                 Originator Sequence Number                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  | LPP Interval  |F|R| List Seq. |  neighbors list (version 3)   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |Ver=1 |LPP ID  |     xxxxxxxxxxxxxxxxxxxxx     |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                   Originator IP Address                       |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                 Originator Sequence Number                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |    Number of Neighbors (n)    |       /16 Prefix (1)          |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  | Neighbors with Prefix (1) (m) |       Host Suffix (1)         |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                        ...                                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |       Host Suffix (m)         |cnt (1)|cnt (2)|  ...  |cnt (m)|
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |       /16 Prefix (2)          |              ...              |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   \endverbatim
+*/
+class LppHeader : public Header 
+{
+public:
+  /// LPP encoding versions
+  enum LppVersion
+  {
+    LPP_PLAIN = 0,   //!< full IP address and 1 byte count per neighbor, at most 255 neighbors
+    LPP_COMPACT = 1, //!< neighbors grouped by /16 prefix, 2 byte host suffix and 4 bit count
+    LPP_NO_LIST = 2, //!< no list of neighbors, only ID, originator address and sequence number
+    LPP_DELTA = 3    //!< list of version 1 with changed counts only, or full list
+  };
+
+  /// constructor
+  LppHeader ();
+
+  // Header serialization/deserialization
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  // Fields
+  void SetLppId (uint8_t count) 
+  {
+	  m_lppId = count;
+  }
+  
+  uint8_t GetLppId () const
+  {
+	  return m_lppId;
+  }
+  
+  void SetOriginAddress (Ipv4Address a)
+  {
+	  m_originAddr = a;
+  }
+  
+  Ipv4Address GetOriginAddress () const
+  {
+	  return m_originAddr;
+  }
+  
+  void SetOriginSeqno (uint32_t seqno) 
+  {
+	  m_originSeqno = seqno;
+  }
+  
+  uint32_t GetOriginSeqno () const 
+  {
+	  return m_originSeqno;
+  }
+  
+  /**
+   * Set advertised LPP interval, zero if the interval is not advertised
+   * \param interval the time until the next LPP, rounded to the nearest 100 ms (at most 25.5 s)
+   */
+  void SetLppInterval (Time interval);
+  /// \returns advertised LPP interval, zero if the interval is not advertised
+  Time GetLppInterval () const;
+
+  uint16_t GetNumberNeighbors () const 
+  {
+	  return (uint16_t)m_neighborsLppCnt.size ();
+  }
+
+  /**
+   * Set requested encoding version, LPP_PLAIN is used anyway if some count doesn't fit in 4 bits,
+   * and LPP_COMPACT is used instead of LPP_PLAIN for more than 255 neighbors
+   * \param version the LppVersion
+   */
+  void SetVersion (uint8_t version)
+  {
+	  m_version = version;
+  }
+
+  /// \returns requested (or received) encoding version
+  uint8_t GetVersion () const
+  {
+	  return m_version;
+  }
+
+  /**
+   * Set delta list fields (LPP_DELTA only)
+   * \param seqNo the list sequence number, only lower 6 bits are used
+   * \param full true if the list is full, false if it holds changes only
+   * \param request true if full list is requested from neighbors
+   */
+  void SetDeltaList (uint8_t seqNo, bool full, bool request)
+  {
+    m_listSeqNo = seqNo & 0x3F;
+    m_fullList = full;
+    m_fullListRequest = request;
+  }
+  /// \returns list sequence number (LPP_DELTA only)
+  uint8_t GetListSeqNo () const
+  {
+    return m_listSeqNo;
+  }
+  /// \returns true if neighbor list is full, always true except for LPP_DELTA with changes only
+  bool IsFullList () const
+  {
+    return m_version != LPP_DELTA || m_fullList;
+  }
+  /// \returns true if the sender requests full list from neighbors (LPP_DELTA only)
+  bool IsFullListRequested () const
+  {
+    return m_version == LPP_DELTA && m_fullListRequest;
+  }
+
+  /// Control neighbors list
+  bool AddToNeighborsList (Ipv4Address neighbor, uint8_t lppCnt);
+  bool RemoveFromNeighborsList (std::pair<Ipv4Address, uint8_t> & un);
+  void ClearNeighborsList ();
+  /**
+   * Look up LPP count reported for a neighbor (binary search over sorted list)
+   * \param neighbor the IP address of the neighbor
+   * \param lppCnt the LPP count, set only if the neighbor is in the list
+   * \returns true if the neighbor is in the list
+   */
+  bool FindNeighborLppCnt (Ipv4Address neighbor, uint8_t & lppCnt) const;
+
+  bool operator== (LppHeader const & o) const;
+
+private:
+  uint8_t       m_lppId;          ///< LPP ID
+  uint8_t       m_version;        ///< Encoding version
+  Ipv4Address   m_originAddr;     ///< Originator IP Address
+  uint32_t      m_originSeqno;    ///< Originator Sequential number
+  uint8_t       m_maxLppCnt;      ///< Upper bound of LPP counts in the list
+  uint8_t       m_lppInterval;    ///< Advertised LPP interval in 100 ms, 0 if not advertised
+  uint8_t       m_listSeqNo;      ///< Delta list sequence number
+  bool          m_fullList;       ///< Delta list is full list
+  bool          m_fullListRequest; ///< Full list is requested from neighbors
+
+  /// \returns version used for serialization
+  uint8_t GetEncodingVersion () const;
+
+  /// List of neighbors: IP addresses and number of LLP count in last check period,
+  /// kept sorted by IP address
+  std::vector<std::pair<Ipv4Address, uint8_t> > m_neighborsLppCnt;
+};
+
+std::ostream & operator<< (std::ostream & os, LppHeader const &);
+
+
+
+}  // namespace aodv
+}  // namespace ns3
+
+#endif /* AODVPACKET_H */
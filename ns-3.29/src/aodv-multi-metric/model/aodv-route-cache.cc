@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtc@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include "aodv-route-cache.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * Check that the new route should replace the cached route to the same destination
+ * \param entry the cached route
+ * \param newEntry the new route
+ * \returns true if the new route is newer or at least as good
+ */
+static bool
+IsBetterRoute (RouteCache::Entry const & entry, RouteCache::Entry const & newEntry)
+{
+  if (entry.expire < Simulator::Now ())
+    {
+      return true;
+    }
+  int32_t seqNoDiff = int32_t (newEntry.seqNo) - int32_t (entry.seqNo);
+  if (seqNoDiff != 0)
+    {
+      return seqNoDiff > 0;
+    }
+  if (newEntry.etx != entry.etx)
+    {
+      return newEntry.etx < entry.etx;
+    }
+  return newEntry.hop <= entry.hop;
+}
+
+void
+RouteCache::Update (Entry entry)
+{
+  if (m_maxSize == 0)
+    {
+      return;
+    }
+  entry.expire = Simulator::Now () + m_lifetime;
+  std::map<Ipv4Address, Entry>::iterator i = m_entries.find (entry.dst);
+  if (i != m_entries.end ())
+    {
+      if (IsBetterRoute (i->second, entry))
+        {
+          i->second = entry;
+        }
+      return;
+    }
+  if (m_entries.size () >= m_maxSize)
+    {
+      Purge ();
+      if (m_entries.size () >= m_maxSize)
+        {
+          RemoveOldest ();
+        }
+    }
+  m_entries.insert (std::make_pair (entry.dst, entry));
+}
+
+bool
+RouteCache::Lookup (Ipv4Address dst, Entry & entry)
+{
+  std::map<Ipv4Address, Entry>::iterator i = m_entries.find (dst);
+  if (i == m_entries.end ())
+    {
+      return false;
+    }
+  if (i->second.expire < Simulator::Now ())
+    {
+      m_entries.erase (i);
+      return false;
+    }
+  entry = i->second;
+  return true;
+}
+
+void
+RouteCache::Delete (Ipv4Address dst)
+{
+  m_entries.erase (dst);
+}
+
+void
+RouteCache::DeleteWithNextHop (Ipv4Address nextHop)
+{
+  for (std::map<Ipv4Address, Entry>::iterator i = m_entries.begin (); i != m_entries.end (); )
+    {
+      if (i->second.nextHop == nextHop)
+        {
+          m_entries.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+void
+RouteCache::Purge ()
+{
+  Time now = Simulator::Now ();
+  for (std::map<Ipv4Address, Entry>::iterator i = m_entries.begin (); i != m_entries.end (); )
+    {
+      if (i->second.expire < now)
+        {
+          m_entries.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+uint32_t
+RouteCache::GetSize ()
+{
+  Purge ();
+  return m_entries.size ();
+}
+
+void
+RouteCache::SetMaxSize (uint32_t maxSize)
+{
+  m_maxSize = maxSize;
+  while (m_entries.size () > m_maxSize)
+    {
+      RemoveOldest ();
+    }
+}
+
+void
+RouteCache::RemoveOldest ()
+{
+  std::map<Ipv4Address, Entry>::iterator oldest = m_entries.begin ();
+  for (std::map<Ipv4Address, Entry>::iterator i = m_entries.begin (); i != m_entries.end (); ++i)
+    {
+      if (i->second.expire < oldest->second.expire)
+        {
+          oldest = i;
+        }
+    }
+  if (oldest != m_entries.end ())
+    {
+      m_entries.erase (oldest);
+    }
+}
+
+}  // namespace aodv
+}  // namespace ns3
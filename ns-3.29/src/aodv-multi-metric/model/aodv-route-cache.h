@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtc@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef AODV_ROUTE_CACHE_H
+#define AODV_ROUTE_CACHE_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/net-device.h"
+#include "ns3/simulator.h"
+#include <map>
+
+namespace ns3 {
+namespace aodv {
+/**
+ * \ingroup aodv
+ *
+ * \brief Cache of routes learned from RREPs forwarded or received by the node.
+ *
+ * Cached routes are kept apart from the routing table, with their own short lifetime which
+ * is not refreshed by data packets. They are used only to answer RREQs by intermediate node
+ * when the routing table has no valid route to the destination. One route per destination
+ * is kept, newer sequence number wins, then smaller ETX and hop count.
+ */
+class RouteCache
+{
+public:
+  /// Cached route
+  struct Entry
+  {
+    Ipv4Address dst;             ///< destination
+    Ipv4Address nextHop;         ///< next hop to the destination
+    uint32_t seqNo;              ///< destination sequence number
+    uint16_t hop;                ///< hop count
+    uint32_t etx;                ///< route ETX
+    Ipv4InterfaceAddress iface;  ///< interface on which the RREP is received
+    Ptr<NetDevice> dev;          ///< output device
+    Time expire;                 ///< when the entry expires, set by the cache
+  };
+  /**
+   * constructor
+   * \param maxSize the maximal number of cached routes
+   * \param lifetime the lifetime for added entries
+   */
+  RouteCache (uint32_t maxSize, Time lifetime) : m_maxSize (maxSize), m_lifetime (lifetime)
+  {
+  }
+  /**
+   * Add route to the cache, or replace the cached route to the same destination if the new
+   * route is at least as good. If the cache is full, the entry which expires first is removed.
+   * \param entry the route, its expire time is ignored
+   */
+  void Update (Entry entry);
+  /**
+   * Find unexpired route to the destination
+   * \param dst the destination
+   * \param entry the cached route
+   * \returns true if the route is found
+   */
+  bool Lookup (Ipv4Address dst, Entry & entry);
+  /**
+   * Delete cached route to the destination
+   * \param dst the destination
+   */
+  void Delete (Ipv4Address dst);
+  /**
+   * Delete all cached routes through the next hop
+   * \param nextHop the next hop
+   */
+  void DeleteWithNextHop (Ipv4Address nextHop);
+  /// Remove all expired entries
+  void Purge ();
+  /// Remove all entries
+  void Clear ()
+  {
+    m_entries.clear ();
+  }
+  /**
+   * \returns number of entries in cache
+   */
+  uint32_t GetSize ();
+  /**
+   * Set the maximal number of cached routes, extra entries are removed
+   * \param maxSize the maximal number of cached routes
+   */
+  void SetMaxSize (uint32_t maxSize);
+  /**
+   * \returns the maximal number of cached routes
+   */
+  uint32_t GetMaxSize () const
+  {
+    return m_maxSize;
+  }
+  /**
+   * Set lifetime for future added entries.
+   * \param lifetime the lifetime for entries
+   */
+  void SetLifetime (Time lifetime)
+  {
+    m_lifetime = lifetime;
+  }
+  /**
+   * \returns the lifetime for added entries
+   */
+  Time GetLifeTime () const
+  {
+    return m_lifetime;
+  }
+private:
+  /// Remove the entry which expires first
+  void RemoveOldest ();
+
+  /// Cached routes, map destination -> route
+  std::map<Ipv4Address, Entry> m_entries;
+  /// Maximal number of cached routes
+  uint32_t m_maxSize;
+  /// Lifetime for added entries
+  Time m_lifetime;
+};
+
+}  // namespace aodv
+}  // namespace ns3
+
+#endif /* AODV_ROUTE_CACHE_H */
@@ -0,0 +1,3607 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 IITP RAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Based on
+ *      NS-2 AODV model developed by the CMU/MONARCH group and optimized and
+ *      tuned by Samir Das and Mahesh Marina, University of Cincinnati;
+ *
+ *      AODV-UU implementation by Erik Nordström of Uppsala University
+ *      http://core.it.uu.se/core/index.php/AODV-UU
+ *
+ * Authors: Elena Buchatskaia <borovkovaes@iitp.ru>
+ *          Pavel Boyko <boyko@iitp.ru>
+ *
+ * Modified by: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtic@gmail.com>
+ *              Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+#define NS_LOG_APPEND_CONTEXT                                   \
+  if (m_ipv4) { std::clog << "[node " << m_ipv4->GetObject<Node> ()->GetId () << "] "; }
+
+#include "aodv-routing-protocol.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/packet.h" // trace
+#include "ns3/udp-socket-factory.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/udp-header.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/adhoc-wifi-mac.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include <algorithm>
+#include <limits>
+#include "ns3/rx-power-tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AodvRoutingProtocol");
+
+namespace aodv {
+NS_OBJECT_ENSURE_REGISTERED (RoutingProtocol);
+
+/// UDP Port for AODV control traffic
+const uint32_t RoutingProtocol::AODV_PORT = 654;
+/// RERR has 4 B header and 8 B per destination
+const uint32_t RoutingProtocol::RERR_MAX_DESTINATIONS = 150;
+
+/**
+* \ingroup aodv
+* \brief Tag used by AODV implementation
+*/
+class DeferredRouteOutputTag : public Tag
+{
+
+public:
+  /**
+   * \brief Constructor
+   * \param o the output interface
+   */
+  DeferredRouteOutputTag (int32_t o = -1) : Tag (),
+                                            m_oif (o)
+  {
+  }
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid = TypeId ("ns3::aodv::DeferredRouteOutputTag")
+      .SetParent<Tag> ()
+      .SetGroupName ("Aodv")
+      .AddConstructor<DeferredRouteOutputTag> ()
+    ;
+    return tid;
+  }
+
+  TypeId  GetInstanceTypeId () const
+  {
+    return GetTypeId ();
+  }
+
+  /**
+   * \brief Get the output interface
+   * \return the output interface
+   */
+  int32_t GetInterface () const
+  {
+    return m_oif;
+  }
+
+  /**
+   * \brief Set the output interface
+   * \param oif the output interface
+   */
+  void SetInterface (int32_t oif)
+  {
+    m_oif = oif;
+  }
+
+  uint32_t GetSerializedSize () const
+  {
+    return sizeof(int32_t);
+  }
+
+  void  Serialize (TagBuffer i) const
+  {
+    i.WriteU32 (m_oif);
+  }
+
+  void  Deserialize (TagBuffer i)
+  {
+    m_oif = i.ReadU32 ();
+  }
+
+  void  Print (std::ostream &os) const
+  {
+    os << "DeferredRouteOutputTag: output interface = " << m_oif;
+  }
+
+private:
+  /// Positive if output device is fixed in RouteOutput
+  int32_t m_oif;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (DeferredRouteOutputTag);
+
+
+//-----------------------------------------------------------------------------
+RoutingProtocol::RoutingProtocol ()
+  : m_rreqRetries (2),
+    m_ttlStart (1),
+    m_ttlIncrement (2),
+    m_ttlThreshold (7),
+    m_timeoutBuffer (2),
+    m_rreqRateLimit (10),
+    m_rerrRateLimit (10),
+    m_activeRouteTimeout (Seconds (3)),
+    m_netDiameter (35),
+    m_nodeTraversalTime (MilliSeconds (40)),
+    m_netTraversalTime (Time ((2 * m_netDiameter) * m_nodeTraversalTime)),
+    m_pathDiscoveryTime ( Time (2 * m_netTraversalTime)),
+    m_myRouteTimeout (Time (2 * std::max (m_pathDiscoveryTime, m_activeRouteTimeout))),
+    m_helloInterval (Seconds (1)),
+    m_allowedHelloLoss (2),
+    m_deletePeriod (Time (5 * std::max (m_activeRouteTimeout, m_helloInterval))),
+    m_nextHopWait (m_nodeTraversalTime + MilliSeconds (10)),
+    m_blackListTimeout (Time (m_rreqRetries * m_netTraversalTime)),
+    m_maxQueueLen (64),
+    m_maxQueueTime (Seconds (30)),
+    m_destinationOnly (true),
+    m_gratuitousReply (true),
+    m_enableHello (false),
+    m_rreqHoldDown (Seconds (0)),
+    m_rerrAggregationWindow (Seconds (0)),
+    m_enableLocalRepair (false),
+    m_maxRepairTtl (10),
+    m_multipathRoutes (1),
+    m_enableRouteCache (false),
+    m_routeCacheSize (64),
+    m_routeCacheLifetime (Seconds (5)),
+    m_enableRouteHistory (false),
+    m_routeHistoryTimeout (Seconds (60)),
+    m_enableControlScheduler (false),
+    m_controlQueueLength (16),
+    m_routingTable (m_deletePeriod),
+    m_queue (m_maxQueueLen, m_maxQueueTime),
+    m_routeCache (m_routeCacheSize, m_routeCacheLifetime),
+    m_requestId (0),
+    m_seqNo (0),
+    m_rreqIdCache (m_pathDiscoveryTime),
+    m_dpd (m_pathDiscoveryTime),
+    m_nb (m_helloInterval),
+    m_rreqCount (0),
+    m_rerrCount (0),
+    m_enableEtx (true), /*etx*/
+    m_lppInterval (Seconds (1)),
+    m_enableCompactLpp (false),
+    m_a (0.05),
+    m_b (60.0),
+    m_enableAdaptiveLpp (false),
+    m_minLppInterval (MilliSeconds (500)),
+    m_maxLppInterval (Seconds (4)),
+    m_currentLppInterval (Seconds (1)),
+    m_enableLppPiggyback (false),
+    m_enableDeltaLpp (false),
+    m_lppFullListPeriod (10),
+    m_lppListSeqNo (0),
+    m_lppsSinceFullList (0),
+    m_lppFullListRequested (true),
+    m_lppRequestFullList (false),
+    m_lppTimer (Timer::CANCEL_ON_DESTROY),
+    m_htimer (Timer::CANCEL_ON_DESTROY),
+    m_rreqRateLimitTimer (Timer::CANCEL_ON_DESTROY),
+    m_rerrRateLimitTimer (Timer::CANCEL_ON_DESTROY),
+    m_rerrAggregationTimer (Timer::CANCEL_ON_DESTROY),
+    m_controlTxTimer (Timer::CANCEL_ON_DESTROY),
+    m_pendingRerrBroadcast (false),
+    m_lastBcastTime (Seconds (0))
+{
+}
+
+TypeId
+RoutingProtocol::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::aodv::RoutingProtocol")
+    .SetParent<Ipv4RoutingProtocol> ()
+    .SetGroupName ("Aodv")
+    .AddAttribute ("HelloInterval", "HELLO messages emission interval.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RoutingProtocol::m_helloInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("TtlStart", "Initial TTL value for RREQ.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RoutingProtocol::m_ttlStart),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("TtlIncrement", "TTL increment for each attempt using the expanding ring search for RREQ dissemination.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RoutingProtocol::m_ttlIncrement),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("TtlThreshold", "Maximum TTL value for expanding ring search, TTL = NetDiameter is used beyond this value.",
+                   UintegerValue (7),
+                   MakeUintegerAccessor (&RoutingProtocol::m_ttlThreshold),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("TimeoutBuffer", "Provide a buffer for the timeout.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RoutingProtocol::m_timeoutBuffer),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("RreqRetries", "Maximum number of retransmissions of RREQ to discover a route",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RoutingProtocol::m_rreqRetries),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RreqRateLimit", "Maximum number of RREQ per second.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&RoutingProtocol::m_rreqRateLimit),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RerrRateLimit", "Maximum number of RERR per second.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&RoutingProtocol::m_rerrRateLimit),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("NodeTraversalTime", "Conservative estimate of the average one hop traversal time for packets and should include "
+                   "queuing delays, interrupt processing times and transfer times.",
+                   TimeValue (MilliSeconds (40)),
+                   MakeTimeAccessor (&RoutingProtocol::m_nodeTraversalTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("NextHopWait", "Period of our waiting for the neighbour's RREP_ACK = 10 ms + NodeTraversalTime",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&RoutingProtocol::m_nextHopWait),
+                   MakeTimeChecker ())
+    .AddAttribute ("ActiveRouteTimeout", "Period of time during which the route is considered to be valid",
+                   TimeValue (Seconds (3)),
+                   MakeTimeAccessor (&RoutingProtocol::m_activeRouteTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("MyRouteTimeout", "Value of lifetime field in RREP generating by this node = 2 * max(ActiveRouteTimeout, PathDiscoveryTime)",
+                   TimeValue (Seconds (11.2)),
+                   MakeTimeAccessor (&RoutingProtocol::m_myRouteTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("BlackListTimeout", "Time for which the node is put into the blacklist = RreqRetries * NetTraversalTime",
+                   TimeValue (Seconds (5.6)),
+                   MakeTimeAccessor (&RoutingProtocol::m_blackListTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("DeletePeriod", "DeletePeriod is intended to provide an upper bound on the time for which an upstream node A "
+                   "can have a neighbor B as an active next hop for destination D, while B has invalidated the route to D."
+                   " = 5 * max (HelloInterval, ActiveRouteTimeout)",
+                   TimeValue (Seconds (15)),
+                   MakeTimeAccessor (&RoutingProtocol::m_deletePeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("NetDiameter", "Net diameter measures the maximum possible number of hops between two nodes in the network",
+                   UintegerValue (35),
+                   MakeUintegerAccessor (&RoutingProtocol::m_netDiameter),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("NetTraversalTime", "Estimate of the average net traversal time = 2 * NodeTraversalTime * NetDiameter",
+                   TimeValue (Seconds (2.8)),
+                   MakeTimeAccessor (&RoutingProtocol::m_netTraversalTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("PathDiscoveryTime", "Estimate of maximum time needed to find route in network = 2 * NetTraversalTime",
+                   TimeValue (Seconds (5.6)),
+                   MakeTimeAccessor (&RoutingProtocol::m_pathDiscoveryTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxQueueLen", "Maximum number of packets that we allow a routing protocol to buffer.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&RoutingProtocol::SetMaxQueueLen,
+                                         &RoutingProtocol::GetMaxQueueLen),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxQueueTime", "Maximum time packets can be queued (in seconds)",
+                   TimeValue (Seconds (30)),
+                   MakeTimeAccessor (&RoutingProtocol::SetMaxQueueTime,
+                                     &RoutingProtocol::GetMaxQueueTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("AllowedHelloLoss", "Number of hello messages which may be loss for valid link.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RoutingProtocol::m_allowedHelloLoss),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("GratuitousReply", "Indicates whether a gratuitous RREP should be unicast to the node originated route discovery.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::SetGratuitousReplyFlag,
+                                        &RoutingProtocol::GetGratuitousReplyFlag),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DestinationOnly", "Indicates only the destination may respond to this RREQ.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::SetDestinationOnlyFlag,
+                                        &RoutingProtocol::GetDestinationOnlyFlag),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EnableHello", "Indicates whether a hello messages enable.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::SetHelloEnable,
+                                        &RoutingProtocol::GetHelloEnable),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EnableBroadcast", "Indicates whether a broadcast data packets forwarding enable.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::SetBroadcastEnable,
+                                        &RoutingProtocol::GetBroadcastEnable),
+                   MakeBooleanChecker ())
+    .AddAttribute ("UniformRv",
+                   "Access to the underlying UniformRandomVariable",
+                   StringValue ("ns3::UniformRandomVariable"),
+                   MakePointerAccessor (&RoutingProtocol::m_uniformRandomVariable),
+                   MakePointerChecker<UniformRandomVariable> ())
+    .AddAttribute ("RreqHoldDown", "Maximal delay of RREQ forwarding. The first copy of RREQ is held for "
+                   "RreqHoldDown/2 to RreqHoldDown, depending on the link quality of its route, and only "
+                   "the best copy received meanwhile is forwarded. Zero disables hold-down.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&RoutingProtocol::m_rreqHoldDown),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("RerrAggregationWindow", "Time for which unreachable destinations of broken links and "
+                   "undeliverable packets are merged into one RERR, sent when the window started by the "
+                   "first of them expires. Zero disables aggregation.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&RoutingProtocol::m_rerrAggregationWindow),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("EnableLocalRepair", "Indicates whether intermediate node repairs broken routes used by "
+                   "precursors, by one-hop detour or TTL-limited RREQ, before sending RERR.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_enableLocalRepair),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxRepairTtl", "Maximal hop count of the broken route which is repaired by RREQ.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&RoutingProtocol::m_maxRepairTtl),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("MultipathRoutes", "Maximal number of routes per destination: the best route and backup routes "
+                   "through other next hops, ranked by ETX. Broken route is switched to the best backup route "
+                   "without route discovery. 1 disables multipath.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RoutingProtocol::m_multipathRoutes),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("EnableRouteCache", "Indicates whether routes from forwarded and received RREPs are cached "
+                   "and used for RREQ replies by intermediate node when the routing table has no valid route. "
+                   "Intermediate replies require DestinationOnly false.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_enableRouteCache),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RouteCacheSize", "Maximal number of cached routes.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&RoutingProtocol::SetRouteCacheSize,
+                                         &RoutingProtocol::GetRouteCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RouteCacheLifetime", "Lifetime of cached routes, it is not refreshed by data packets.",
+                   TimeValue (Seconds (5)),
+                   MakeTimeAccessor (&RoutingProtocol::SetRouteCacheLifetime,
+                                     &RoutingProtocol::GetRouteCacheLifetime),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableRouteHistory", "Indicates whether the first RREQ ring to destination without routing "
+                   "table entry starts just above the hop count of the last route discovered to it.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_enableRouteHistory),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RouteHistoryTimeout", "Time in which confidence of the last discovered hop count decays "
+                   "to zero, then the first ring is TtlStart again.",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&RoutingProtocol::m_routeHistoryTimeout),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("EnableControlScheduler", "Send jittered control packets (RERR, HELLO, RREQ and LPP) through "
+                   "one priority queue drained by a single timer, instead of one event per packet. "
+                   "Packets due at the same time are sent in priority order, and when the queue is full "
+                   "the packet last in order is dropped.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_enableControlScheduler),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ControlQueueLength", "Maximal number of control packets in the priority queue, "
+                   "the packet with the lowest priority and the latest send time is dropped.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&RoutingProtocol::m_controlQueueLength),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("EnableEtx", "Enable ETX metric.", /*etx*/
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::SetEtxEnable,
+                                        &RoutingProtocol::GetEtxEnable),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LppInterval", "Link probe packet emission interval.", /*etx*/
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RoutingProtocol::m_lppInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Alpha", "ETX parmeter alpha (PLR-ETX only).", /*etx*/
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&RoutingProtocol::m_a),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("Beta", "ETX parmeter beta (PLR-ETX only).", /*etx*/
+                   DoubleValue (60.0),
+                   MakeDoubleAccessor (&RoutingProtocol::m_b),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("EnableCompactLpp", "Send neighbor list of LPP in compact encoding (version 1), "
+                   "metrics without neighbor list always send LPP without the list.", /*etx*/
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_enableCompactLpp),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EnableAdaptiveLpp", "Adapt LPP interval to the rate of changes in the neighborhood, "
+                   "between MinLppInterval and MaxLppInterval. Interval is advertised in LPP, "
+                   "all nodes should use the same setting.", /*etx*/
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_enableAdaptiveLpp),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MinLppInterval", "Minimal adaptive LPP interval, also the step of its increase. "
+                   "Adaptive interval is rounded to 100 ms, the unit in which it is advertised.", /*etx*/
+                   TimeValue (MilliSeconds (500)),
+                   MakeTimeAccessor (&RoutingProtocol::m_minLppInterval),
+                   MakeTimeChecker (MilliSeconds (100), Seconds (25.5)))
+    .AddAttribute ("MaxLppInterval", "Maximal adaptive LPP interval.", /*etx*/
+                   TimeValue (Seconds (4)),
+                   MakeTimeAccessor (&RoutingProtocol::m_maxLppInterval),
+                   MakeTimeChecker (MilliSeconds (100), Seconds (25.5)))
+    .AddAttribute ("EnableLppPiggyback", "Piggyback LPP on broadcast RREQ, RERR and HELLO messages, "
+                   "standalone LPP is sent at the end of LPP interval only if no LPP has been piggybacked. "
+                   "Time stamp advances after the standalone LPP instead of before it, "
+                   "all nodes should use the same setting.", /*etx*/
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_enableLppPiggyback),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EnableDeltaLpp", "Send only LPP counts changed since the previous LPP (version 3), "
+                   "with full list every LppFullListPeriod LPPs or when some neighbor requests it. "
+                   "Used only by metrics with neighbor list on nodes with one AODV interface.", /*etx*/
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_enableDeltaLpp),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LppFullListPeriod", "Every LppFullListPeriod-th delta LPP carries full list.", /*etx*/
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&RoutingProtocol::m_lppFullListPeriod),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("Tx", "A new routing protocol packet is created and is sent", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("LppTx", "LPP is sent, with current and base LPP interval", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_lppTxTrace),
+                     "ns3::aodv::RoutingProtocol::LppTxTracedCallback")
+    .AddTraceSource ("RreqForward", "RREQ is forwarded, with number of its copies absorbed during hold-down", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_rreqForwardTrace),
+                     "ns3::aodv::RoutingProtocol::RreqForwardTracedCallback")
+    .AddTraceSource ("RreqTx", "RREQ is sent by the originator of route discovery", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_rreqTxTrace),
+                     "ns3::aodv::RoutingProtocol::RreqTxTracedCallback")
+    .AddTraceSource ("RrepTx", "RREP is sent or forwarded", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_rrepTxTrace),
+                     "ns3::aodv::RoutingProtocol::RouteDiscoveryTracedCallback")
+    .AddTraceSource ("RouteDiscovered", "RREP is received by the originator of route discovery", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_routeDiscoveredTrace),
+                     "ns3::aodv::RoutingProtocol::RouteDiscoveredTracedCallback")
+    .AddTraceSource ("RouteDiscoveryFailed", "Route discovery is given up by the originator", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_routeDiscoveryFailedTrace),
+                     "ns3::aodv::RoutingProtocol::RouteDiscoveryTracedCallback")
+    .AddTraceSource ("LocalRepair", "Local repair of broken route has finished", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_localRepairTrace),
+                     "ns3::aodv::RoutingProtocol::LocalRepairTracedCallback")
+    .AddTraceSource ("RouteSwitch", "Broken route is switched to backup route", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_routeSwitchTrace),
+                     "ns3::aodv::RoutingProtocol::RouteSwitchTracedCallback")
+    .AddTraceSource ("RouteCache", "Route cache is looked up for RREQ reply, hit or miss", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_routeCacheTrace),
+                     "ns3::aodv::RoutingProtocol::RouteCacheTracedCallback")
+    .AddTraceSource ("ControlDrop", "Control packet is dropped by the control packet scheduler", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_controlDropTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("LppPiggyback", "LPP is piggybacked on other AODV message, with current and base LPP interval", // trace
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_lppPiggybackTrace),
+                     "ns3::aodv::RoutingProtocol::LppTxTracedCallback")
+  ;
+  return tid;
+}
+
+void
+RoutingProtocol::SetMaxQueueLen (uint32_t len)
+{
+  m_maxQueueLen = len;
+  m_queue.SetMaxQueueLen (len);
+}
+void
+RoutingProtocol::SetMaxQueueTime (Time t)
+{
+  m_maxQueueTime = t;
+  m_queue.SetQueueTimeout (t);
+}
+void
+RoutingProtocol::SetRouteCacheSize (uint32_t size)
+{
+  m_routeCacheSize = size;
+  m_routeCache.SetMaxSize (size);
+}
+void
+RoutingProtocol::SetRouteCacheLifetime (Time t)
+{
+  m_routeCacheLifetime = t;
+  m_routeCache.SetLifetime (t);
+}
+
+RoutingProtocol::~RoutingProtocol ()
+{
+}
+
+void
+RoutingProtocol::DoDispose ()
+{
+  m_ipv4 = 0;
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::iterator iter =
+         m_socketAddresses.begin (); iter != m_socketAddresses.end (); iter++)
+    {
+      iter->first->Close ();
+    }
+  m_socketAddresses.clear ();
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::iterator iter =
+         m_socketSubnetBroadcastAddresses.begin (); iter != m_socketSubnetBroadcastAddresses.end (); iter++)
+    {
+      iter->first->Close ();
+    }
+  m_socketSubnetBroadcastAddresses.clear ();
+  for (std::map<std::pair<Ipv4Address, uint32_t>, HeldRequest>::iterator iter =
+         m_heldRequests.begin (); iter != m_heldRequests.end (); iter++)
+    {
+      iter->second.event.Cancel ();
+    }
+  m_heldRequests.clear ();
+  m_pendingRerrDst.clear ();
+  m_pendingRerrPrecursors.clear ();
+  m_localRepairs.clear ();
+  m_controlQueue.clear ();
+  Ipv4RoutingProtocol::DoDispose ();
+}
+
+void
+RoutingProtocol::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
+{
+  *stream->GetStream () << "Node: " << m_ipv4->GetObject<Node> ()->GetId ()
+                        << "; Time: " << Now ().As (unit)
+                        << ", Local time: " << GetObject<Node> ()->GetLocalTime ().As (unit)
+                        << ", AODV Routing table" << std::endl;
+
+  m_routingTable.Print (stream);
+  *stream->GetStream () << std::endl;
+}
+
+int64_t
+RoutingProtocol::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uniformRandomVariable->SetStream (stream);
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+template <class Metric>
+MetricRoutingProtocol<Metric>::MetricRoutingProtocol ()
+{
+  m_nb.SetCallback (MakeCallback (&MetricRoutingProtocol::SendRerrWhenBreaksLinkToNextHop, this));
+}
+
+template <class Metric>
+TypeId
+MetricRoutingProtocol<Metric>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (Metric::GetTypeName ())
+    .SetParent<RoutingProtocol> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<MetricRoutingProtocol<Metric> > ()
+  ;
+  return tid;
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::Start ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_enableHello || (Metric::LINK_PROBES && m_enableEtx)) /*etx ?*/
+    {
+      m_nb.ScheduleTimer ();
+    }
+  m_rreqRateLimitTimer.SetFunction (&MetricRoutingProtocol::RreqRateLimitTimerExpire,
+                                    this);
+  m_rreqRateLimitTimer.Schedule (Seconds (1));
+
+  m_rerrRateLimitTimer.SetFunction (&MetricRoutingProtocol::RerrRateLimitTimerExpire,
+                                    this);
+  m_rerrRateLimitTimer.Schedule (Seconds (1));
+  m_rerrAggregationTimer.SetFunction (&MetricRoutingProtocol::RerrAggregationTimerExpire,
+                                      this);
+  m_controlTxTimer.SetFunction (&MetricRoutingProtocol::ControlTxTimerExpire, this);
+  if (Metric::RX_POWER && m_enableEtx) /*etx*/
+    {
+      m_nbEtx.SetCoeficients (m_a, m_b);
+    }
+}
+
+template <class Metric>
+Ptr<Ipv4Route>
+MetricRoutingProtocol<Metric>::RouteOutput (Ptr<Packet> p, const Ipv4Header &header,
+                                            Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION (this << header << (oif ? oif->GetIfIndex () : 0));
+  if (!p)
+    {
+      NS_LOG_DEBUG ("Packet is == 0");
+      return LoopbackRoute (header, oif); // later
+    }
+  if (m_socketAddresses.empty ())
+    {
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+      NS_LOG_LOGIC ("No aodv interfaces");
+      Ptr<Ipv4Route> route;
+      return route;
+    }
+  sockerr = Socket::ERROR_NOTERROR;
+  Ptr<Ipv4Route> route;
+  Ipv4Address dst = header.GetDestination ();
+  RoutingTableEntry rt;
+  if (m_routingTable.LookupValidRoute (dst, rt))
+    {
+      route = rt.GetRoute ();
+      NS_ASSERT (route != 0);
+      NS_LOG_DEBUG ("Exist route to " << route->GetDestination () << " from interface " << route->GetSource ());
+      if (oif != 0 && route->GetOutputDevice () != oif)
+        {
+          NS_LOG_DEBUG ("Output device doesn't match. Dropped.");
+          sockerr = Socket::ERROR_NOROUTETOHOST;
+          return Ptr<Ipv4Route> ();
+        }
+      UpdateRouteLifeTime (dst, m_activeRouteTimeout);
+      UpdateRouteLifeTime (route->GetGateway (), m_activeRouteTimeout);
+      return route;
+    }
+
+  // Valid route not found, in this case we return loopback.
+  // Actual route request will be deferred until packet will be fully formed,
+  // routed to loopback, received from loopback and passed to RouteInput (see below)
+  uint32_t iif = (oif ? m_ipv4->GetInterfaceForDevice (oif) : -1);
+  DeferredRouteOutputTag tag (iif);
+  NS_LOG_DEBUG ("Valid Route not found");
+  if (!p->PeekPacketTag (tag))
+    {
+      p->AddPacketTag (tag);
+    }
+  return LoopbackRoute (header, oif);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::DeferredRouteOutput (Ptr<const Packet> p, const Ipv4Header & header,
+                                                    UnicastForwardCallback ucb, ErrorCallback ecb)
+{
+  NS_LOG_FUNCTION (this << p << header);
+  NS_ASSERT (p != 0 && p != Ptr<Packet> ());
+
+  QueueEntry newEntry (p, header, ucb, ecb);
+  bool result = m_queue.Enqueue (newEntry);
+  if (result)
+    {
+      NS_LOG_LOGIC ("Add packet " << p->GetUid () << " to queue. Protocol " << (uint16_t) header.GetProtocol ());
+      RoutingTableEntry rt;
+      bool result = m_routingTable.LookupRoute (header.GetDestination (), rt);
+      if (!result || ((rt.GetFlag () != IN_SEARCH) && result))
+        {
+          NS_LOG_LOGIC ("Send new RREQ for outbound packet to " << header.GetDestination ());
+          SendRequest (header.GetDestination ());
+        }
+    }
+}
+
+template <class Metric>
+bool
+MetricRoutingProtocol<Metric>::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
+                                           Ptr<const NetDevice> idev, UnicastForwardCallback ucb,
+                                           MulticastForwardCallback mcb, LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  NS_LOG_FUNCTION (this << p->GetUid () << header.GetDestination () << idev->GetAddress ());
+  if (m_socketAddresses.empty ())
+    {
+      NS_LOG_LOGIC ("No aodv interfaces");
+      return false;
+    }
+  NS_ASSERT (m_ipv4 != 0);
+  NS_ASSERT (p != 0);
+  // Check if input device supports IP
+  NS_ASSERT (m_ipv4->GetInterfaceForDevice (idev) >= 0);
+  int32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+
+  Ipv4Address dst = header.GetDestination ();
+  Ipv4Address origin = header.GetSource ();
+
+  // Deferred route request
+  if (idev == m_lo)
+    {
+      DeferredRouteOutputTag tag;
+      if (p->PeekPacketTag (tag))
+        {
+          DeferredRouteOutput (p, header, ucb, ecb);
+          return true;
+        }
+    }
+
+  // Duplicate of own packet
+  if (IsMyOwnAddress (origin))
+    {
+      return true;
+    }
+
+  // AODV is not a multicast routing protocol
+  if (dst.IsMulticast ())
+    {
+      return false;
+    }
+
+  // Broadcast local delivery/forwarding
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      Ipv4InterfaceAddress iface = j->second;
+      if (m_ipv4->GetInterfaceForAddress (iface.GetLocal ()) == iif)
+        {
+          if (dst == iface.GetBroadcast () || dst.IsBroadcast ())
+            {
+              if (m_dpd.IsDuplicate (p, header))
+                {
+                  NS_LOG_DEBUG ("Duplicated packet " << p->GetUid () << " from " << origin << ". Drop.");
+                  return true;
+                }
+              UpdateRouteLifeTime (origin, m_activeRouteTimeout);
+              Ptr<Packet> packet = p->Copy ();
+              if (lcb.IsNull () == false)
+                {
+                  NS_LOG_LOGIC ("Broadcast local delivery to " << iface.GetLocal ());
+                  lcb (p, header, iif);
+                  // Fall through to additional processing
+                }
+              else
+                {
+                  NS_LOG_ERROR ("Unable to deliver packet locally due to null callback " << p->GetUid () << " from " << origin);
+                  ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+                }
+              if (!m_enableBroadcast)
+                {
+                  return true;
+                }
+              if (header.GetProtocol () == UdpL4Protocol::PROT_NUMBER)
+                {
+                  UdpHeader udpHeader;
+                  p->PeekHeader (udpHeader);
+                  if (udpHeader.GetDestinationPort () == AODV_PORT)
+                    {
+                      // AODV packets sent in broadcast are already managed
+                      return true;
+                    }
+                }
+              if (header.GetTtl () > 1)
+                {
+                  NS_LOG_LOGIC ("Forward broadcast. TTL " << (uint16_t) header.GetTtl ());
+                  RoutingTableEntry toBroadcast;
+                  if (m_routingTable.LookupRoute (dst, toBroadcast))
+                    {
+                      Ptr<Ipv4Route> route = toBroadcast.GetRoute ();
+                      ucb (route, packet, header);
+                    }
+                  else
+                    {
+                      NS_LOG_DEBUG ("No route to forward broadcast. Drop packet " << p->GetUid ());
+                    }
+                }
+              else
+                {
+                  NS_LOG_DEBUG ("TTL exceeded. Drop packet " << p->GetUid ());
+                }
+              return true;
+            }
+        }
+    }
+
+  // Unicast local delivery
+  if (m_ipv4->IsDestinationAddress (dst, iif))
+    {
+      UpdateRouteLifeTime (origin, m_activeRouteTimeout);
+      RoutingTableEntry toOrigin;
+      if (m_routingTable.LookupValidRoute (origin, toOrigin))
+        {
+          UpdateRouteLifeTime (toOrigin.GetNextHop (), m_activeRouteTimeout);
+          m_nb.Update (toOrigin.GetNextHop (), m_activeRouteTimeout);
+        }
+      if (lcb.IsNull () == false)
+        {
+          NS_LOG_LOGIC ("Unicast local delivery to " << dst);
+          lcb (p, header, iif);
+        }
+      else
+        {
+          NS_LOG_ERROR ("Unable to deliver packet locally due to null callback " << p->GetUid () << " from " << origin);
+          ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+        }
+      return true;
+    }
+
+  // Check if input device supports IP forwarding
+  if (m_ipv4->IsForwarding (iif) == false)
+    {
+      NS_LOG_LOGIC ("Forwarding disabled for this interface");
+      ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+      return true;
+    }
+
+  // Forwarding
+  return Forwarding (p, header, ucb, ecb);
+}
+
+template <class Metric>
+bool
+MetricRoutingProtocol<Metric>::Forwarding (Ptr<const Packet> p, const Ipv4Header & header,
+                                           UnicastForwardCallback ucb, ErrorCallback ecb)
+{
+  NS_LOG_FUNCTION (this);
+  Ipv4Address dst = header.GetDestination ();
+  Ipv4Address origin = header.GetSource ();
+  m_routingTable.Purge ();
+  RoutingTableEntry toDst;
+  if (m_routingTable.LookupRoute (dst, toDst))
+    {
+      if (toDst.GetFlag () == VALID)
+        {
+          Ptr<Ipv4Route> route = toDst.GetRoute ();
+          NS_LOG_LOGIC (route->GetSource () << " forwarding to " << dst << " from " << origin << " packet " << p->GetUid ());
+
+          /*
+           *  Each time a route is used to forward a data packet, its Active Route
+           *  Lifetime field of the source, destination and the next hop on the
+           *  path to the destination is updated to be no less than the current
+           *  time plus ActiveRouteTimeout.
+           */
+          UpdateRouteLifeTime (origin, m_activeRouteTimeout);
+          UpdateRouteLifeTime (dst, m_activeRouteTimeout);
+          UpdateRouteLifeTime (route->GetGateway (), m_activeRouteTimeout);
+          /*
+           *  Since the route between each originator and destination pair is expected to be symmetric, the
+           *  Active Route Lifetime for the previous hop, along the reverse path back to the IP source, is also updated
+           *  to be no less than the current time plus ActiveRouteTimeout
+           */
+          RoutingTableEntry toOrigin;
+          m_routingTable.LookupRoute (origin, toOrigin);
+          UpdateRouteLifeTime (toOrigin.GetNextHop (), m_activeRouteTimeout);
+
+          m_nb.Update (route->GetGateway (), m_activeRouteTimeout);
+          m_nb.Update (toOrigin.GetNextHop (), m_activeRouteTimeout);
+
+          ucb (route, p, header);
+          return true;
+        }
+      else if (m_localRepairs.find (dst) != m_localRepairs.end ())
+        {
+          // Wait for local repair, packet is sent or dropped together with own packets
+          QueueEntry newEntry (p, header, ucb, ecb);
+          if (m_queue.Enqueue (newEntry))
+            {
+              NS_LOG_LOGIC ("Add packet " << p->GetUid () << " to queue during local repair of route to " << dst);
+              return true;
+            }
+          NS_LOG_DEBUG ("Drop packet " << p->GetUid () << " because queue is full during local repair.");
+          return false;
+        }
+      else
+        {
+          if (toDst.GetValidSeqNo ())
+            {
+              SendRerrWhenNoRouteToForward (dst, toDst.GetSeqNo (), origin);
+              NS_LOG_DEBUG ("Drop packet " << p->GetUid () << " because no route to forward it.");
+              return false;
+            }
+        }
+    }
+  NS_LOG_LOGIC ("route not found to " << dst << ". Send RERR message.");
+  NS_LOG_DEBUG ("Drop packet " << p->GetUid () << " because no route to forward it.");
+  SendRerrWhenNoRouteToForward (dst, 0, origin);
+  return false;
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SetIpv4 (Ptr<Ipv4> ipv4)
+{
+  NS_ASSERT (ipv4 != 0);
+  NS_ASSERT (m_ipv4 == 0);
+
+  m_ipv4 = ipv4;
+
+  // Create lo route. It is asserted that the only one interface up for now is loopback
+  NS_ASSERT (m_ipv4->GetNInterfaces () == 1 && m_ipv4->GetAddress (0, 0).GetLocal () == Ipv4Address ("127.0.0.1"));
+  m_lo = m_ipv4->GetNetDevice (0);
+  NS_ASSERT (m_lo != 0);
+  // Remember lo route
+  RoutingTableEntry rt (/*device=*/ m_lo, /*dst=*/ Ipv4Address::GetLoopback (), /*know seqno=*/ true, /*seqno=*/ 0,
+                                    /*iface=*/ Ipv4InterfaceAddress (Ipv4Address::GetLoopback (), Ipv4Mask ("255.0.0.0")),
+                                    /*hops=*/ 1, /*next hop=*/ Ipv4Address::GetLoopback (),
+                                    /*lifetime=*/ Simulator::GetMaximumSimulationTime (),
+                                    /*etx=*/ Metric::SelfEtx ());
+  m_routingTable.AddRoute (rt);
+
+  Simulator::ScheduleNow (&MetricRoutingProtocol::Start, this);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::NotifyInterfaceUp (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << m_ipv4->GetAddress (i, 0).GetLocal ());
+  m_receiverInterfaces.clear ();
+  Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol> ();
+  if (l3->GetNAddresses (i) > 1)
+    {
+      NS_LOG_WARN ("AODV does not work with more then one address per each interface.");
+    }
+  Ipv4InterfaceAddress iface = l3->GetAddress (i, 0);
+  if (iface.GetLocal () == Ipv4Address ("127.0.0.1"))
+    {
+      return;
+    }
+
+  // Create a socket to listen only on this interface
+  Ptr<Socket> socket = Socket::CreateSocket (GetObject<Node> (),
+                                             UdpSocketFactory::GetTypeId ());
+  NS_ASSERT (socket != 0);
+  socket->SetRecvCallback (MakeCallback (&MetricRoutingProtocol::RecvAodv, this));
+  socket->BindToNetDevice (l3->GetNetDevice (i));
+  socket->Bind (InetSocketAddress (iface.GetLocal (), AODV_PORT));
+  socket->SetAllowBroadcast (true);
+  socket->SetIpRecvTtl (true);
+  m_socketAddresses.insert (std::make_pair (socket, iface));
+
+  // create also a subnet broadcast socket
+  socket = Socket::CreateSocket (GetObject<Node> (),
+                                 UdpSocketFactory::GetTypeId ());
+  NS_ASSERT (socket != 0);
+  socket->SetRecvCallback (MakeCallback (&MetricRoutingProtocol::RecvAodv, this));
+  socket->BindToNetDevice (l3->GetNetDevice (i));
+  socket->Bind (InetSocketAddress (iface.GetBroadcast (), AODV_PORT));
+  socket->SetAllowBroadcast (true);
+  socket->SetIpRecvTtl (true);
+  m_socketSubnetBroadcastAddresses.insert (std::make_pair (socket, iface));
+
+  // Add local broadcast record to the routing table
+  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (m_ipv4->GetInterfaceForAddress (iface.GetLocal ()));
+  RoutingTableEntry rt (/*device=*/ dev, /*dst=*/ iface.GetBroadcast (), /*know seqno=*/ true, /*seqno=*/ 0, /*iface=*/ iface,
+                        /*hops=*/ 1, /*next hop=*/ iface.GetBroadcast (), /*lifetime=*/ Simulator::GetMaximumSimulationTime (), /*etx=*/ Metric::SelfEtx ());
+  m_routingTable.AddRoute (rt);
+
+  if (l3->GetInterface (i)->GetArpCache ())
+    {
+      m_nb.AddArpCache (l3->GetInterface (i)->GetArpCache ());
+    }
+
+  // Allow neighbor manager use this interface for layer 2 feedback if possible
+  Ptr<WifiNetDevice> wifi = dev->GetObject<WifiNetDevice> ();
+  if (wifi == 0)
+    {
+      return;
+    }
+  Ptr<WifiMac> mac = wifi->GetMac ();
+  if (mac == 0)
+    {
+      return;
+    }
+
+  mac->TraceConnectWithoutContext ("TxErrHeader", m_nb.GetTxErrorCallback ());
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::NotifyInterfaceDown (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << m_ipv4->GetAddress (i, 0).GetLocal ());
+  m_receiverInterfaces.clear ();
+
+  // Disable layer 2 link state monitoring (if possible)
+  Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol> ();
+  Ptr<NetDevice> dev = l3->GetNetDevice (i);
+  Ptr<WifiNetDevice> wifi = dev->GetObject<WifiNetDevice> ();
+  if (wifi != 0)
+    {
+      Ptr<WifiMac> mac = wifi->GetMac ()->GetObject<AdhocWifiMac> ();
+      if (mac != 0)
+        {
+          mac->TraceDisconnectWithoutContext ("TxErrHeader",
+                                              m_nb.GetTxErrorCallback ());
+          m_nb.DelArpCache (l3->GetInterface (i)->GetArpCache ());
+        }
+    }
+
+  // Close socket
+  Ptr<Socket> socket = FindSocketWithInterfaceAddress (m_ipv4->GetAddress (i, 0));
+  NS_ASSERT (socket);
+  socket->Close ();
+  m_socketAddresses.erase (socket);
+
+  // Close socket
+  socket = FindSubnetBroadcastSocketWithInterfaceAddress (m_ipv4->GetAddress (i, 0));
+  NS_ASSERT (socket);
+  socket->Close ();
+  m_socketSubnetBroadcastAddresses.erase (socket);
+
+  if (m_socketAddresses.empty ())
+    {
+      NS_LOG_LOGIC ("No aodv interfaces");
+      m_htimer.Cancel ();
+      m_lppTimer.Cancel (); /*etx*/
+      m_nbEtx.Clear ();     /*etx*/
+      m_nb.Clear ();
+      m_routingTable.Clear ();
+      m_routeCache.Clear ();
+      m_controlTxTimer.Cancel ();
+      m_controlQueue.clear ();
+      return;
+    }
+  m_routingTable.DeleteAllRoutesFromInterface (m_ipv4->GetAddress (i, 0));
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::NotifyAddAddress (uint32_t i, Ipv4InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this << " interface " << i << " address " << address);
+  m_receiverInterfaces.clear ();
+  Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol> ();
+  if (!l3->IsUp (i))
+    {
+      return;
+    }
+  if (l3->GetNAddresses (i) == 1)
+    {
+      Ipv4InterfaceAddress iface = l3->GetAddress (i, 0);
+      Ptr<Socket> socket = FindSocketWithInterfaceAddress (iface);
+      if (!socket)
+        {
+          if (iface.GetLocal () == Ipv4Address ("127.0.0.1"))
+            {
+              return;
+            }
+          // Create a socket to listen only on this interface
+          Ptr<Socket> socket = Socket::CreateSocket (GetObject<Node> (),
+                                                     UdpSocketFactory::GetTypeId ());
+          NS_ASSERT (socket != 0);
+          socket->SetRecvCallback (MakeCallback (&MetricRoutingProtocol::RecvAodv,this));
+          socket->BindToNetDevice (l3->GetNetDevice (i));
+          socket->Bind (InetSocketAddress (iface.GetLocal (), AODV_PORT));
+          socket->SetAllowBroadcast (true);
+          m_socketAddresses.insert (std::make_pair (socket, iface));
+
+          // create also a subnet directed broadcast socket
+          socket = Socket::CreateSocket (GetObject<Node> (),
+                                         UdpSocketFactory::GetTypeId ());
+          NS_ASSERT (socket != 0);
+          socket->SetRecvCallback (MakeCallback (&MetricRoutingProtocol::RecvAodv, this));
+          socket->BindToNetDevice (l3->GetNetDevice (i));
+          socket->Bind (InetSocketAddress (iface.GetBroadcast (), AODV_PORT));
+          socket->SetAllowBroadcast (true);
+          socket->SetIpRecvTtl (true);
+          m_socketSubnetBroadcastAddresses.insert (std::make_pair (socket, iface));
+
+          // Add local broadcast record to the routing table
+          Ptr<NetDevice> dev = m_ipv4->GetNetDevice (
+              m_ipv4->GetInterfaceForAddress (iface.GetLocal ()));
+          RoutingTableEntry rt (/*device=*/ dev, /*dst=*/ iface.GetBroadcast (), /*know seqno=*/ true,
+                                /*seqno=*/ 0, /*iface=*/ iface, /*hops=*/ 1,
+                                /*next hop=*/ iface.GetBroadcast (), /*lifetime=*/ Simulator::GetMaximumSimulationTime (), /*etx=*/ Metric::SelfEtx ());
+          m_routingTable.AddRoute (rt);
+        }
+    }
+  else
+    {
+      NS_LOG_LOGIC ("AODV does not work with more then one address per each interface. Ignore added address");
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::NotifyRemoveAddress (uint32_t i, Ipv4InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this);
+  m_receiverInterfaces.clear ();
+  Ptr<Socket> socket = FindSocketWithInterfaceAddress (address);
+  if (socket)
+    {
+      m_routingTable.DeleteAllRoutesFromInterface (address);
+      socket->Close ();
+      m_socketAddresses.erase (socket);
+
+      Ptr<Socket> unicastSocket = FindSubnetBroadcastSocketWithInterfaceAddress (address);
+      if (unicastSocket)
+        {
+          unicastSocket->Close ();
+          m_socketAddresses.erase (unicastSocket);
+        }
+
+      Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol> ();
+      if (l3->GetNAddresses (i))
+        {
+          Ipv4InterfaceAddress iface = l3->GetAddress (i, 0);
+          // Create a socket to listen only on this interface
+          Ptr<Socket> socket = Socket::CreateSocket (GetObject<Node> (),
+                                                     UdpSocketFactory::GetTypeId ());
+          NS_ASSERT (socket != 0);
+          socket->SetRecvCallback (MakeCallback (&MetricRoutingProtocol::RecvAodv, this));
+          // Bind to any IP address so that broadcasts can be received
+          socket->BindToNetDevice (l3->GetNetDevice (i));
+          socket->Bind (InetSocketAddress (iface.GetLocal (), AODV_PORT));
+          socket->SetAllowBroadcast (true);
+          socket->SetIpRecvTtl (true);
+          m_socketAddresses.insert (std::make_pair (socket, iface));
+
+          // create also a unicast socket
+          socket = Socket::CreateSocket (GetObject<Node> (),
+                                         UdpSocketFactory::GetTypeId ());
+          NS_ASSERT (socket != 0);
+          socket->SetRecvCallback (MakeCallback (&MetricRoutingProtocol::RecvAodv, this));
+          socket->BindToNetDevice (l3->GetNetDevice (i));
+          socket->Bind (InetSocketAddress (iface.GetBroadcast (), AODV_PORT));
+          socket->SetAllowBroadcast (true);
+          socket->SetIpRecvTtl (true);
+          m_socketSubnetBroadcastAddresses.insert (std::make_pair (socket, iface));
+
+          // Add local broadcast record to the routing table
+          Ptr<NetDevice> dev = m_ipv4->GetNetDevice (m_ipv4->GetInterfaceForAddress (iface.GetLocal ()));
+          RoutingTableEntry rt (/*device=*/ dev, /*dst=*/ iface.GetBroadcast (), /*know seqno=*/ true, /*seqno=*/ 0, /*iface=*/ iface,
+                                /*hops=*/ 1, /*next hop=*/ iface.GetBroadcast (), /*lifetime=*/ Simulator::GetMaximumSimulationTime (), /*etx=*/ Metric::SelfEtx ());
+          m_routingTable.AddRoute (rt);
+        }
+      if (m_socketAddresses.empty ())
+        {
+          NS_LOG_LOGIC ("No aodv interfaces");
+          m_htimer.Cancel ();
+          m_lppTimer.Cancel (); /*etx*/
+          m_nbEtx.Clear ();     /*etx*/
+          m_nb.Clear ();
+          m_routingTable.Clear ();
+          m_routeCache.Clear ();
+          m_controlTxTimer.Cancel ();
+          m_controlQueue.clear ();
+          return;
+        }
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Remove address not participating in AODV operation");
+    }
+}
+
+template <class Metric>
+bool
+MetricRoutingProtocol<Metric>::IsMyOwnAddress (Ipv4Address src)
+{
+  NS_LOG_FUNCTION (this << src);
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      Ipv4InterfaceAddress iface = j->second;
+      if (src == iface.GetLocal ())
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+template <class Metric>
+Ptr<Ipv4Route>
+MetricRoutingProtocol<Metric>::LoopbackRoute (const Ipv4Header & hdr, Ptr<NetDevice> oif) const
+{
+  NS_LOG_FUNCTION (this << hdr);
+  NS_ASSERT (m_lo != 0);
+  Ptr<Ipv4Route> rt = Create<Ipv4Route> ();
+  rt->SetDestination (hdr.GetDestination ());
+  //
+  // Source address selection here is tricky.  The loopback route is
+  // returned when AODV does not have a route; this causes the packet
+  // to be looped back and handled (cached) in RouteInput() method
+  // while a route is found. However, connection-oriented protocols
+  // like TCP need to create an endpoint four-tuple (src, src port,
+  // dst, dst port) and create a pseudo-header for checksumming.  So,
+  // AODV needs to guess correctly what the eventual source address
+  // will be.
+  //
+  // For single interface, single address nodes, this is not a problem.
+  // When there are possibly multiple outgoing interfaces, the policy
+  // implemented here is to pick the first available AODV interface.
+  // If RouteOutput() caller specified an outgoing interface, that
+  // further constrains the selection of source address
+  //
+  std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin ();
+  if (oif)
+    {
+      // Iterate to find an address on the oif device
+      for (j = m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+        {
+          Ipv4Address addr = j->second.GetLocal ();
+          int32_t interface = m_ipv4->GetInterfaceForAddress (addr);
+          if (oif == m_ipv4->GetNetDevice (static_cast<uint32_t> (interface)))
+            {
+              rt->SetSource (addr);
+              break;
+            }
+        }
+    }
+  else
+    {
+      rt->SetSource (j->second.GetLocal ());
+    }
+  NS_ASSERT_MSG (rt->GetSource () != Ipv4Address (), "Valid AODV source address not found");
+  rt->SetGateway (Ipv4Address ("127.0.0.1"));
+  rt->SetOutputDevice (m_lo);
+  return rt;
+}
+
+// ETX: added etx metric to table entry
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendRequest (Ipv4Address dst)
+{
+  NS_LOG_FUNCTION ( this << dst);
+  // A node SHOULD NOT originate more than RREQ_RATELIMIT RREQ messages per second.
+  if (m_rreqCount == m_rreqRateLimit)
+    {
+      Simulator::Schedule (m_rreqRateLimitTimer.GetDelayLeft () + MicroSeconds (100),
+                           &MetricRoutingProtocol::SendRequest, this, dst);
+      return;
+    }
+  else
+    {
+      m_rreqCount++;
+    }
+  // Create RREQ header
+  RreqHeader rreqHeader;
+  rreqHeader.SetDst (dst);
+  rreqHeader.SetEtxEncoding (Metric::ETX_ENCODING);
+
+  RoutingTableEntry rt;
+  // Using the Hop field in Routing Table to manage the expanding ring search
+  uint16_t ttl = m_ttlStart;
+  bool retry = false; // trace
+  if (m_routingTable.LookupRoute (dst, rt))
+    {
+      retry = (rt.GetFlag () == IN_SEARCH); // trace
+      if (rt.GetFlag () != IN_SEARCH)
+        {
+          ttl = std::min<uint16_t> (rt.GetHop () + m_ttlIncrement, m_netDiameter);
+        }
+      else
+        {
+          ttl = rt.GetHop () + m_ttlIncrement;
+          if (ttl > m_ttlThreshold)
+            {
+              ttl = m_netDiameter;
+            }
+        }
+      if (ttl == m_netDiameter)
+        {
+          rt.IncrementRreqCnt ();
+        }
+      if (rt.GetValidSeqNo ())
+        {
+          rreqHeader.SetDstSeqno (rt.GetSeqNo ());
+        }
+      else
+        {
+          rreqHeader.SetUnknownSeqno (true);
+        }
+      rt.SetHop (ttl);
+      rt.SetFlag (IN_SEARCH);
+      rt.SetLifeTime (m_pathDiscoveryTime);
+      m_routingTable.Update (rt);
+    }
+  else
+    {
+      if (m_enableRouteHistory)
+        {
+          ttl = GetHistoryTtl (dst);
+        }
+      rreqHeader.SetUnknownSeqno (true);
+      Ptr<NetDevice> dev = 0;
+      RoutingTableEntry newEntry (/*device=*/ dev, /*dst=*/ dst, /*validSeqNo=*/ false, /*seqno=*/ 0,
+                                  /*iface=*/ Ipv4InterfaceAddress (),/*hop=*/ ttl,
+                                  /*nextHop=*/ Ipv4Address (), /*lifeTime=*/ m_pathDiscoveryTime, /*etx=*/ Metric::SelfEtx ());
+      // Check if TtlStart == NetDiameter
+      if (ttl == m_netDiameter)
+        {
+          newEntry.IncrementRreqCnt ();
+        }
+      newEntry.SetFlag (IN_SEARCH);
+      m_routingTable.AddRoute (newEntry);
+    }
+
+  if (m_gratuitousReply)
+    {
+      rreqHeader.SetGratuitousRrep (true);
+    }
+  if (m_destinationOnly)
+    {
+      rreqHeader.SetDestinationOnly (true);
+    }
+
+  m_seqNo++;
+  rreqHeader.SetOriginSeqno (m_seqNo);
+  m_requestId++;
+  rreqHeader.SetId (m_requestId);
+
+  // Send RREQ as subnet directed broadcast from each interface used by aodv
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+
+      rreqHeader.SetOrigin (iface.GetLocal ());
+      m_rreqIdCache.IsDuplicate (iface.GetLocal (), m_requestId);
+
+      Ptr<Packet> packet = Create<Packet> ();
+      SocketIpTtlTag tag;
+      tag.SetTtl (ttl);
+      packet->AddPacketTag (tag);
+      packet->AddHeader (rreqHeader);
+      TypeHeader tHeader (AODVTYPE_RREQ);
+      packet->AddHeader (tHeader);
+      PiggybackLpp (packet, iface); /*etx*/
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination;
+      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+      NS_LOG_DEBUG ("Send RREQ with id " << rreqHeader.GetId () << " to socket");
+      m_rreqTxTrace (iface.GetLocal (), m_requestId, dst, retry); // trace
+      m_lastBcastTime = Simulator::Now ();
+      ScheduleControlPacket (socket, packet, destination, Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), CONTROL_RREQ);
+    }
+  ScheduleRreqRetry (dst);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendTo (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination)
+{
+  m_txTrace (packet); // trace
+  socket->SendTo (packet, 0, InetSocketAddress (destination, AODV_PORT));
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::ScheduleControlPacket (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination,
+                                                      Time jitter, ControlPriority priority)
+{
+  if (!m_enableControlScheduler)
+    {
+      Simulator::Schedule (jitter, &MetricRoutingProtocol::SendControlPacket, this, socket, packet, destination, priority);
+      return;
+    }
+  NS_LOG_FUNCTION (this << destination << jitter << priority);
+  ControlPacket cp;
+  cp.priority = priority;
+  cp.due = Simulator::Now () + jitter;
+  cp.socket = socket;
+  cp.packet = packet;
+  cp.destination = destination;
+  std::vector<ControlPacket>::iterator pos = m_controlQueue.begin ();
+  while (pos != m_controlQueue.end ()
+         && (pos->priority < cp.priority || (pos->priority == cp.priority && pos->due <= cp.due)))
+    {
+      ++pos;
+    }
+  if (m_controlQueue.size () >= m_controlQueueLength)
+    {
+      if (pos == m_controlQueue.end ())
+        {
+          NS_LOG_DEBUG ("Control queue is full, drop control packet with priority " << priority);
+          m_controlDropTrace (packet); // trace
+          return;
+        }
+      NS_LOG_DEBUG ("Control queue is full, drop queued control packet with priority " << m_controlQueue.back ().priority);
+      m_controlDropTrace (m_controlQueue.back ().packet); // trace
+      m_controlQueue.pop_back ();
+    }
+  m_controlQueue.insert (pos, cp);
+  ScheduleControlTimer ();
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::ScheduleControlTimer ()
+{
+  if (m_controlQueue.empty ())
+    {
+      return;
+    }
+  Time next = m_controlQueue.front ().due;
+  for (std::vector<ControlPacket>::const_iterator i = m_controlQueue.begin (); i != m_controlQueue.end (); ++i)
+    {
+      next = std::min (next, i->due);
+    }
+  Time delay = std::max (next - Simulator::Now (), Seconds (0));
+  if (!m_controlTxTimer.IsRunning () || delay < m_controlTxTimer.GetDelayLeft ())
+    {
+      m_controlTxTimer.Cancel ();
+      m_controlTxTimer.Schedule (delay);
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::ControlTxTimerExpire ()
+{
+  NS_LOG_FUNCTION (this);
+  // Due packets are taken out first, sending may trigger new control packets
+  std::vector<ControlPacket> due;
+  Time now = Simulator::Now ();
+  for (std::vector<ControlPacket>::iterator i = m_controlQueue.begin (); i != m_controlQueue.end (); )
+    {
+      if (i->due <= now)
+        {
+          due.push_back (*i);
+          i = m_controlQueue.erase (i);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  for (std::vector<ControlPacket>::const_iterator i = due.begin (); i != due.end (); ++i)
+    {
+      SendControlPacket (i->socket, i->packet, i->destination, i->priority);
+    }
+  ScheduleControlTimer ();
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendControlPacket (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination,
+                                                  ControlPriority priority)
+{
+  if (priority == CONTROL_LPP)
+    {
+      m_lppTxTrace (packet, m_currentLppInterval, m_lppInterval); // trace
+    }
+  SendTo (socket, packet, destination);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::ScheduleRreqRetry (Ipv4Address dst)
+{
+  NS_LOG_FUNCTION (this << dst);
+  if (m_addressReqTimer.find (dst) == m_addressReqTimer.end ())
+    {
+      Timer timer (Timer::CANCEL_ON_DESTROY);
+      m_addressReqTimer[dst] = timer;
+    }
+  m_addressReqTimer[dst].SetFunction (&MetricRoutingProtocol::RouteRequestTimerExpire, this);
+  m_addressReqTimer[dst].Remove ();
+  m_addressReqTimer[dst].SetArguments (dst);
+  RoutingTableEntry rt;
+  m_routingTable.LookupRoute (dst, rt);
+  Time retry;
+  if (rt.GetHop () < m_netDiameter)
+    {
+      retry = 2 * m_nodeTraversalTime * (rt.GetHop () + m_timeoutBuffer);
+    }
+  else
+    {
+      NS_ABORT_MSG_UNLESS (rt.GetRreqCnt () > 0, "Unexpected value for GetRreqCount ()");
+      uint16_t backoffFactor = rt.GetRreqCnt () - 1;
+      NS_LOG_LOGIC ("Applying binary exponential backoff factor " << backoffFactor);
+      retry = m_netTraversalTime * (1 << backoffFactor);
+    }
+  m_addressReqTimer[dst].Schedule (retry);
+  NS_LOG_LOGIC ("Scheduled RREQ retry in " << retry.GetSeconds () << " seconds");
+}
+
+// ETX: added reception of LPP packet
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RecvAodv (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Address sourceAddress;
+  Ptr<Packet> packet = socket->RecvFrom (sourceAddress);
+  InetSocketAddress inetSourceAddr = InetSocketAddress::ConvertFrom (sourceAddress);
+  Ipv4Address sender = inetSourceAddr.GetIpv4 ();
+  Ipv4Address receiver;
+
+  std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator i = m_socketAddresses.find (socket);
+  if (i != m_socketAddresses.end ())
+    {
+      receiver = i->second.GetLocal ();
+    }
+  else if ((i = m_socketSubnetBroadcastAddresses.find (socket)) != m_socketSubnetBroadcastAddresses.end ())
+    {
+      receiver = i->second.GetLocal ();
+    }
+  else
+    {
+      NS_ASSERT_MSG (false, "Received a packet from an unknown socket");
+    }
+  NS_LOG_DEBUG ("AODV node " << this << " received a AODV packet from " << sender << " to " << receiver);
+
+  ReceiverInterface const & receiverIface = GetReceiverInterface (receiver);
+  UpdateRouteToNeighbor (sender, receiverIface);
+  TypeHeader tHeader (AODVTYPE_RREQ);
+  packet->RemoveHeader (tHeader);
+  if (!tHeader.IsValid ())
+    {
+      NS_LOG_DEBUG ("AODV message " << packet->GetUid () << " with unknown type received: " << tHeader.Get () << ". Drop");
+      return; // drop
+    }
+  if (tHeader.Get () == AODVTYPE_LPP) /*etx*/
+    {
+      RecvLpp (packet, receiverIface, sender);
+      if (packet->GetSize () == 0)
+        {
+          return;
+        }
+      // LPP was piggybacked on the AODV message which follows it
+      packet->RemoveHeader (tHeader);
+      if (!tHeader.IsValid () || tHeader.Get () == AODVTYPE_LPP)
+        {
+          NS_LOG_DEBUG ("AODV message " << packet->GetUid () << " with unknown type piggybacked: " << tHeader.Get () << ". Drop");
+          return; // drop
+        }
+    }
+  switch (tHeader.Get ())
+    {
+    case AODVTYPE_RREQ:
+      {
+        RecvRequest (packet, receiverIface, sender);
+        break;
+      }
+    case AODVTYPE_RREP:
+      {
+        RecvReply (packet, receiverIface, sender);
+        break;
+      }
+    case AODVTYPE_RERR:
+      {
+        RecvError (packet, sender);
+        break;
+      }
+    case AODVTYPE_RREP_ACK:
+      {
+        RecvReplyAck (sender);
+        break;
+      }
+    default:
+      {
+        break;
+      }
+    }
+}
+
+template <class Metric>
+bool
+MetricRoutingProtocol<Metric>::UpdateRouteLifeTime (Ipv4Address addr, Time lifetime)
+{
+  NS_LOG_FUNCTION (this << addr << lifetime);
+  RoutingTableEntry rt;
+  if (m_routingTable.LookupRoute (addr, rt))
+    {
+      if (rt.GetFlag () == VALID)
+        {
+          NS_LOG_DEBUG ("Updating VALID route");
+          rt.SetRreqCnt (0);
+          rt.SetLifeTime (std::max (lifetime, rt.GetLifeTime ()));
+          m_routingTable.Update (rt);
+          return true;
+        }
+    }
+  return false;
+}
+
+template <class Metric>
+typename MetricRoutingProtocol<Metric>::ReceiverInterface const &
+MetricRoutingProtocol<Metric>::GetReceiverInterface (Ipv4Address local)
+{
+  std::map<Ipv4Address, ReceiverInterface>::const_iterator i = m_receiverInterfaces.find (local);
+  if (i != m_receiverInterfaces.end ())
+    {
+      return i->second;
+    }
+  int32_t interface = m_ipv4->GetInterfaceForAddress (local);
+  NS_ASSERT (interface >= 0);
+  ReceiverInterface receiver;
+  receiver.local = local;
+  receiver.device = m_ipv4->GetNetDevice (interface);
+  receiver.ifaddr = m_ipv4->GetAddress (interface, 0);
+  return m_receiverInterfaces.insert (std::make_pair (local, receiver)).first->second;
+}
+
+//ETX: added etx field to routing table
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::UpdateRouteToNeighbor (Ipv4Address sender, ReceiverInterface const & receiver)
+{
+  NS_LOG_FUNCTION (this << "sender " << sender << " receiver " << receiver.local);
+  uint32_t etx = m_nbEtx.GetEtxForNeighbor (sender); // cached link ETX, looked up once
+  RoutingTableEntry toNeighbor;
+  if (!m_routingTable.LookupRoute (sender, toNeighbor))
+    {
+      Ptr<NetDevice> dev = receiver.device;
+      RoutingTableEntry newEntry (/*device=*/ dev, /*dst=*/ sender, /*know seqno=*/ false, /*seqno=*/ 0,
+                                  /*iface=*/ receiver.ifaddr,
+                                  /*hops=*/ 1, /*next hop=*/ sender, /*lifetime=*/ m_activeRouteTimeout,
+                                  /*etx=*/ etx);
+      m_routingTable.AddRoute (newEntry);
+    }
+  else
+    {
+      Ptr<NetDevice> dev = receiver.device;
+      if (toNeighbor.GetValidSeqNo () && (toNeighbor.GetHop () == 1) && (toNeighbor.GetOutputDevice () == dev))
+        {
+          toNeighbor.SetLifeTime (std::max (m_activeRouteTimeout, toNeighbor.GetLifeTime ()));
+          toNeighbor.SetEtx (etx);
+          m_routingTable.Update (toNeighbor); // this was missing in original AODV implementation
+        }
+      else
+        {
+          RoutingTableEntry newEntry (/*device=*/ dev, /*dst=*/ sender, /*know seqno=*/ false, /*seqno=*/ 0,
+                                      /*iface=*/ receiver.ifaddr,
+                                      /*hops=*/ 1, /*next hop=*/ sender,
+                                      /*lifetime=*/ std::max (m_activeRouteTimeout, toNeighbor.GetLifeTime ()),
+                                      /*etx=*/ etx);
+          m_routingTable.Update (newEntry);
+        }
+    }
+}
+
+// ETX: new function for receiving LPP packets 
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RecvLpp (Ptr<Packet> p, ReceiverInterface const & receiver, Ipv4Address src)
+{
+  NS_LOG_FUNCTION (this);
+
+  //NS_LOG_DEBUG ("LPP receive: " << Simulator::Now ().GetSeconds () << " - sender = " << src << ", receiver = " << receiver.local);
+  LppHeader lppHeader;
+  p->RemoveHeader (lppHeader);
+  Ipv4Address origin = lppHeader.GetOriginAddress ();
+  NS_ASSERT (origin == src); // Neighbor from which the packet is received is always originator of LPP packet
+  uint8_t lppTimeStamp = lppHeader.GetLppId ();
+
+  // Search for my IP address in LPP packet header
+  uint8_t lppForward = 0; // if there is no my address in the packet header lpp forward should be 0
+  bool listSynchronized = true;
+  if (Metric::NEIGHBOR_LIST)
+    {
+      if (lppHeader.IsFullList ())
+        {
+          lppHeader.FindNeighborLppCnt (receiver.local, lppForward);
+        }
+      else
+        {
+          // Delta list, the last known count is used if some delta is missed
+          listSynchronized = m_nbEtx.FindDeltaLppForward (src, receiver.local, lppHeader, lppForward);
+        }
+    }
+  double power = 0;
+  if (Metric::RX_POWER)
+    {
+      RxPowerTag rxPowerTag;
+      bool z = p->PeekPacketTag (rxPowerTag);
+      NS_ASSERT_MSG (z, "Power ETX: No RxPowerTag found, packet must have RxPowerTag!");
+      uint8_t hops = rxPowerTag.GetHops ();
+      NS_ASSERT_MSG (hops == 1, "Power ETX: RxPowerTag found, but number of hops in LPP packet is not 1!");
+      power = rxPowerTag.GetRxPower ();
+    }
+  // Add new or update existing etx entry for neighbor with IP address "src".
+  // LPP count is updated based on lppTime stamp received in packet header.
+  // LPP forward count is updated from list provided in LPP packet header.
+  // Neighbor with adaptive LPP advertises its interval
+  Time lppInterval = lppHeader.GetLppInterval ();
+  if (!lppInterval.IsStrictlyPositive ())
+    {
+      lppInterval = m_lppInterval;
+    }
+  m_nbEtx.UpdateNeighborEtx (src, lppTimeStamp, lppForward, power, lppInterval); /*etx*/
+  if (Metric::NEIGHBOR_LIST && lppHeader.GetVersion () == LppHeader::LPP_DELTA)
+    {
+      m_nbEtx.SetLppListSeqNo (src, listSynchronized ? lppHeader.GetListSeqNo ()
+                                                     : NeighborEtx<Metric>::LPP_LIST_NOT_SYNCHRONIZED);
+      if (!listSynchronized)
+        {
+          NS_LOG_DEBUG ("Delta LPP from " << src << " missed, full list is requested");
+          m_lppRequestFullList = true;
+        }
+      if (lppHeader.IsFullListRequested ())
+        {
+          m_lppFullListRequested = true;
+        }
+    }
+  uint32_t etx = m_nbEtx.GetEtxForNeighbor (src); /*etx*/
+  // Since ETX is changed we should update route entry for neighbor
+  // LPP is used as HELLO so it should be updated as if HELLO message is received
+  // We use LPP as HELLO message, so we do the same as in ProcessHello (), but with ETX metric
+  RoutingTableEntry toNeighbor;
+  if (!m_routingTable.LookupRoute (src, toNeighbor))
+    {
+      Ptr<NetDevice> dev = receiver.device;
+      RoutingTableEntry newEntry (/*device=*/ dev, /*dst=*/ src, /*validSeqNo=*/ true,
+                                  /*seqno=*/ lppHeader.GetOriginSeqno (),
+                                  /*iface=*/ receiver.ifaddr,
+                                  /*hop=*/ 1, /*nextHop=*/ src,
+                                  /*lifeTime=*/ Time (m_allowedHelloLoss * std::max (m_helloInterval, lppInterval)),
+                                  /*etx*/ etx);
+      m_routingTable.AddRoute (newEntry);
+    }
+  else
+    {
+      toNeighbor.SetLifeTime (std::max (Time (m_allowedHelloLoss * std::max (m_helloInterval, lppInterval)), toNeighbor.GetLifeTime ()));
+      toNeighbor.SetSeqNo (lppHeader.GetOriginSeqno ());
+      toNeighbor.SetValidSeqNo (true);
+      toNeighbor.SetFlag (VALID);
+      toNeighbor.SetOutputDevice (receiver.device);
+      toNeighbor.SetInterface (receiver.ifaddr);
+      toNeighbor.SetHop (1);
+      toNeighbor.SetNextHop (src);
+      toNeighbor.SetEtx (etx); /*etx*/
+      m_routingTable.Update (toNeighbor);
+    }
+
+    m_nb.Update (src, Time (m_allowedHelloLoss * lppInterval));
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RecvRequest (Ptr<Packet> p, ReceiverInterface const & receiver, Ipv4Address src)
+{
+  NS_LOG_FUNCTION (this);
+  RreqHeader rreqHeader;
+  p->RemoveHeader (rreqHeader);
+
+  // A node ignores all RREQs received from any node in its blacklist
+  RoutingTableEntry toPrev;
+  if (m_routingTable.LookupRoute (src, toPrev))
+    {
+      if (toPrev.IsUnidirectional ())
+        {
+          NS_LOG_DEBUG ("Ignoring RREQ from node in blacklist");
+          return;
+        }
+    }
+
+  uint32_t id = rreqHeader.GetId ();
+  Ipv4Address origin = rreqHeader.GetOrigin ();
+
+  // Add in RREQ ETX metric for last hop from neighbor to this node
+  // Now RREQ contains ETX from origin to this node
+  // src is always neighbor, origin maybe isn't
+  rreqHeader.SetEtx (Metric::AddLinkEtx (rreqHeader.GetEtx (), m_nbEtx.GetEtxForNeighbor (src)));
+  // Forwarded RREQ carries ETX in encoding of this node's metric
+  rreqHeader.SetEtxEncoding (Metric::ETX_ENCODING);
+  /*
+   *  Node checks to determine whether it has received a RREQ with the same Originator IP Address and RREQ ID.
+   *  If such a RREQ has been received, the node silently discards the newly received RREQ.
+   *  This is modified to include ETX, so RREQ is discarded only if etx of previously received RREQ is beter (smaller) then this one
+   */
+  if (m_rreqIdCache.IsDuplicate (origin, id))
+    {
+      RoutingTableEntry rte;
+      if (m_routingTable.LookupRoute (origin, rte))
+        {
+          if (rte.GetEtx () <= rreqHeader.GetEtx ())
+            {
+              NS_LOG_DEBUG ("Duplicate, IGNORE previous RREQ had better ETX.");
+              return;
+            }
+            NS_LOG_DEBUG ("Duplicate, but better ETX. Continue...");
+        }
+      NS_LOG_DEBUG ("Duplicate, but no route in the table. Continue...");
+    }
+  else
+    {
+      NS_LOG_DEBUG ("Not found duplicate. Continue...");
+    }
+
+  // Increment RREQ hop count
+  uint8_t hop = rreqHeader.GetHopCount () + 1;
+  rreqHeader.SetHopCount (hop);
+
+  /*
+   *  When the reverse route is created or updated, the following actions on the route are also carried out:
+   *  1. the Originator Sequence Number from the RREQ is compared to the corresponding destination sequence number
+   *     in the route table entry and copied if greater than the existing value there
+   *  2. the valid sequence number field is set to true;
+   *  3. the next hop in the routing table becomes the node from which the  RREQ was received
+   *  4. the hop count is copied from the Hop Count in the RREQ message;
+   *  5. the Lifetime is set to be the maximum of (ExistingLifetime, MinimalLifetime), where
+   *     MinimalLifetime = current time + 2*NetTraversalTime - 2*HopCount*NodeTraversalTime
+   *  6. ETX is copied from the RREQ message
+   */
+  RoutingTableEntry toOrigin;
+  if (!m_routingTable.LookupRoute (origin, toOrigin))
+    { // There is no route in the routing table
+      Ptr<NetDevice> dev = receiver.device;
+      RoutingTableEntry newEntry (/*device=*/ dev, /*dst=*/ origin, /*validSeno=*/ true, /*seqNo=*/ rreqHeader.GetOriginSeqno (),
+                                              /*iface=*/ receiver.ifaddr, /*hops=*/ hop,
+                                              /*nextHop*/ src, /*timeLife=*/ Time ((2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime)),
+                                              /*etx*/ rreqHeader.GetEtx ());
+      m_routingTable.AddRoute (newEntry);
+    }
+  else
+    { // Update existing route
+      if (toOrigin.GetValidSeqNo ())
+        {
+          if (int32_t (rreqHeader.GetOriginSeqno ()) - int32_t (toOrigin.GetSeqNo ()) > 0)
+            { // update sequence number with newer one
+              toOrigin.SetSeqNo (rreqHeader.GetOriginSeqno ());
+            }
+        }
+      else
+        { // not valid seq. no.
+          toOrigin.SetSeqNo (rreqHeader.GetOriginSeqno ());
+        }
+      toOrigin.SetValidSeqNo (true);
+      toOrigin.SetNextHop (src);
+      toOrigin.SetOutputDevice (receiver.device);
+      toOrigin.SetInterface (receiver.ifaddr);
+      toOrigin.SetHop (hop);
+      toOrigin.SetLifeTime (std::max (Time (2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime),
+                                      toOrigin.GetLifeTime ()));
+      toOrigin.SetEtx (rreqHeader.GetEtx ()); /*etx*/
+      m_routingTable.Update (toOrigin);
+      //m_nb.Update (src, Time (AllowedHelloLoss * HelloInterval));
+    }
+
+
+  RoutingTableEntry toNeighbor;
+  if (!m_routingTable.LookupRoute (src, toNeighbor))
+    { // no route
+      NS_LOG_DEBUG ("Neighbor:" << src << " not found in routing table. Creating an entry");
+      Ptr<NetDevice> dev = receiver.device;
+      RoutingTableEntry newEntry (dev, src, false, rreqHeader.GetOriginSeqno (),
+                                  receiver.ifaddr,
+                                  1, src, m_activeRouteTimeout,
+                                  /*etx*/ m_nbEtx.GetEtxForNeighbor (src));
+      m_routingTable.AddRoute (newEntry);
+    }
+  else
+    { // Update existing route
+      toNeighbor.SetLifeTime (m_activeRouteTimeout);
+      toNeighbor.SetValidSeqNo (false);
+      toNeighbor.SetSeqNo (rreqHeader.GetOriginSeqno ());
+      toNeighbor.SetFlag (VALID);
+      toNeighbor.SetOutputDevice (receiver.device);
+      toNeighbor.SetInterface (receiver.ifaddr);
+      toNeighbor.SetHop (1);
+      toNeighbor.SetNextHop (src);
+      toNeighbor.SetEtx (m_nbEtx.GetEtxForNeighbor (src)); /*etx*/
+      m_routingTable.Update (toNeighbor);
+    }
+  m_nb.Update (src, Time (m_allowedHelloLoss * m_helloInterval));
+
+  NS_LOG_LOGIC (receiver.local << " receive RREQ with hop count " << static_cast<uint32_t> (rreqHeader.GetHopCount ())
+                         << " ID " << rreqHeader.GetId ()
+                         << " to destination " << rreqHeader.GetDst ());
+
+  //  A node generates a RREP if either:
+  //  (i)  it is itself the destination,
+  if (IsMyOwnAddress (rreqHeader.GetDst ()))
+    {
+      m_routingTable.LookupRoute (origin, toOrigin);
+      NS_LOG_DEBUG ("Send reply since I am the destination");
+      SendReply (rreqHeader, toOrigin);
+      return;
+    }
+  /*
+   * (ii) or it has an active route to the destination, the destination sequence number in the node's existing route table entry for the destination
+   *      is valid and greater than or equal to the Destination Sequence Number of the RREQ, and the "destination only" flag is NOT set.
+   */
+  RoutingTableEntry toDst;
+  Ipv4Address dst = rreqHeader.GetDst ();
+  if (m_enableRouteCache && !rreqHeader.GetDestinationOnly () && !m_routingTable.LookupValidRoute (dst, toDst))
+    {
+      InstallCachedRoute (rreqHeader, src);
+    }
+  if (m_routingTable.LookupRoute (dst, toDst))
+    {
+      /*
+       * Drop RREQ, This node RREP will make a loop.
+       */
+      if (toDst.GetNextHop () == src)
+        {
+          NS_LOG_DEBUG ("Drop RREQ from " << src << ", dest next hop " << toDst.GetNextHop ());
+          return;
+        }
+      /*
+       * The Destination Sequence number for the requested destination is set to the maximum of the corresponding value
+       * received in the RREQ message, and the destination sequence value currently maintained by the node for the requested destination.
+       * However, the forwarding node MUST NOT modify its maintained value for the destination sequence number, even if the value
+       * received in the incoming RREQ is larger than the value currently maintained by the forwarding node.
+       */
+      if ((rreqHeader.GetUnknownSeqno () || (int32_t (toDst.GetSeqNo ()) - int32_t (rreqHeader.GetDstSeqno ()) >= 0))
+          && toDst.GetValidSeqNo () )
+        {
+          if (!rreqHeader.GetDestinationOnly () && toDst.GetFlag () == VALID)
+            {
+              m_routingTable.LookupRoute (origin, toOrigin);
+              SendReplyByIntermediateNode (toDst, toOrigin, rreqHeader.GetGratuitousRrep ());
+              return;
+            }
+          // Update seqno and valid fileds in the RREQ packet for forwarding
+          rreqHeader.SetDstSeqno (toDst.GetSeqNo ());
+          rreqHeader.SetUnknownSeqno (false);
+        }
+    }
+
+  // Forward RREQ
+  SocketIpTtlTag tag;
+  p->RemovePacketTag (tag);
+  if (tag.GetTtl () < 2)
+    {
+      NS_LOG_DEBUG ("TTL exceeded. Drop RREQ origin " << src << " destination " << dst );
+      return;
+    }
+  if (m_rreqHoldDown > Seconds (0))
+    {
+      HoldRequest (rreqHeader, tag.GetTtl () - 1);
+      return;
+    }
+  ForwardRequest (rreqHeader, tag.GetTtl () - 1);
+  m_rreqForwardTrace (origin, id, 0); // trace
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::ForwardRequest (RreqHeader const & rreqHeader, uint8_t ttl)
+{
+  NS_LOG_FUNCTION (this << rreqHeader.GetOrigin () << rreqHeader.GetId ());
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      Ptr<Packet> packet = Create<Packet> ();
+      SocketIpTtlTag ttlTag;
+      ttlTag.SetTtl (ttl);
+      packet->AddPacketTag (ttlTag);
+      packet->AddHeader (rreqHeader);
+      TypeHeader tHeader (AODVTYPE_RREQ);
+      packet->AddHeader (tHeader);
+      PiggybackLpp (packet, iface); /*etx*/
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination;
+      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+      m_lastBcastTime = Simulator::Now ();
+      ScheduleControlPacket (socket, packet, destination, Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), CONTROL_RREQ);
+
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::HoldRequest (RreqHeader const & rreqHeader, uint8_t ttl)
+{
+  NS_LOG_FUNCTION (this << rreqHeader.GetOrigin () << rreqHeader.GetId ());
+  std::pair<Ipv4Address, uint32_t> key (rreqHeader.GetOrigin (), rreqHeader.GetId ());
+  typename std::map<std::pair<Ipv4Address, uint32_t>, HeldRequest>::iterator i = m_heldRequests.find (key);
+  if (i != m_heldRequests.end ())
+    {
+      // Worse copies are discarded as duplicates, so this one is better than the held one
+      NS_LOG_DEBUG ("RREQ with better ETX " << rreqHeader.GetEtx () << " replaces held RREQ");
+      i->second.header = rreqHeader;
+      i->second.ttl = ttl;
+      i->second.absorbed++;
+      return;
+    }
+  // Hold-down grows with mean link quality loss of the route
+  uint8_t hops = std::max<uint8_t> (rreqHeader.GetHopCount (), 1);
+  double loss = Metric::LinkLoss (rreqHeader.GetEtx () / hops);
+  Time holdDown = Seconds (m_rreqHoldDown.GetSeconds () * (1.0 + loss) / 2.0);
+  HeldRequest held;
+  held.header = rreqHeader;
+  held.ttl = ttl;
+  held.absorbed = 0;
+  held.event = Simulator::Schedule (holdDown, &MetricRoutingProtocol::RequestHoldDownExpire, this,
+                                    rreqHeader.GetOrigin (), rreqHeader.GetId ());
+  m_heldRequests.insert (std::make_pair (key, held));
+  NS_LOG_DEBUG ("Hold RREQ from " << rreqHeader.GetOrigin () << " ID " << rreqHeader.GetId ()
+                                  << " for " << holdDown.GetSeconds () << " s");
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RequestHoldDownExpire (Ipv4Address origin, uint32_t id)
+{
+  NS_LOG_FUNCTION (this << origin << id);
+  typename std::map<std::pair<Ipv4Address, uint32_t>, HeldRequest>::iterator i =
+    m_heldRequests.find (std::make_pair (origin, id));
+  NS_ASSERT (i != m_heldRequests.end ());
+  ForwardRequest (i->second.header, i->second.ttl);
+  m_rreqForwardTrace (origin, id, i->second.absorbed); // trace
+  m_heldRequests.erase (i);
+}
+
+// Send RREP by destination node
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendReply (RreqHeader const & rreqHeader, RoutingTableEntry const & toOrigin)
+{
+  NS_LOG_FUNCTION (this << toOrigin.GetDestination ());
+  /*
+   * Destination node MUST increment its own sequence number by one if the sequence number in the RREQ packet is equal to that
+   * incremented value. Otherwise, the destination does not change its sequence number before generating the  RREP message.
+   */
+  if (!rreqHeader.GetUnknownSeqno () && (rreqHeader.GetDstSeqno () == m_seqNo + 1))
+    {
+      m_seqNo++;
+    }
+  RrepHeader rrepHeader ( /*prefixSize=*/ 0, /*hops=*/ 0, /*dst=*/ rreqHeader.GetDst (),
+                          /*dstSeqNo=*/ m_seqNo, /*origin=*/ toOrigin.GetDestination (), /*lifeTime=*/ m_myRouteTimeout,
+                          /*etx*/ 0); // ETX is set to 0 for calculation of reverse ETX from destination to origin
+  rrepHeader.SetEtxEncoding (Metric::ETX_ENCODING);
+  Ptr<Packet> packet = Create<Packet> ();
+  SocketIpTtlTag tag;
+  tag.SetTtl (toOrigin.GetHop ());
+  packet->AddPacketTag (tag);
+  packet->AddHeader (rrepHeader);
+  TypeHeader tHeader (AODVTYPE_RREP);
+  packet->AddHeader (tHeader);
+  Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
+  NS_ASSERT (socket);
+  m_txTrace (packet); // trace
+  m_rrepTxTrace (rrepHeader.GetOrigin (), rrepHeader.GetDst ()); // trace
+  socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), AODV_PORT));
+}
+
+// Send RREP by an intermediate node which is not the destination for RREQ
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendReplyByIntermediateNode (RoutingTableEntry & toDst, RoutingTableEntry & toOrigin, bool gratRep)
+{
+  NS_LOG_FUNCTION (this);
+  RrepHeader rrepHeader (/*prefix size=*/ 0, /*hops=*/ toDst.GetHop (), /*dst=*/ toDst.GetDestination (), /*dst seqno=*/ toDst.GetSeqNo (),
+                         /*origin=*/ toOrigin.GetDestination (), /*lifetime=*/ toDst.GetLifeTime (),
+                         /*etx*/ toDst.GetEtx ()); // reverse ETX calculation starts with value of my ETX for destination
+  rrepHeader.SetEtxEncoding (Metric::ETX_ENCODING);
+  /* If the node we received a RREQ for is a neighbor we are
+   * probably facing a unidirectional link... Better request a RREP-ack
+   */
+  if (toDst.GetHop () == 1)
+    {
+      rrepHeader.SetAckRequired (true);
+      RoutingTableEntry toNextHop;
+      m_routingTable.LookupRoute (toOrigin.GetNextHop (), toNextHop);
+      toNextHop.m_ackTimer.SetFunction (&MetricRoutingProtocol::AckTimerExpire, this);
+      toNextHop.m_ackTimer.SetArguments (toNextHop.GetDestination (), m_blackListTimeout);
+      toNextHop.m_ackTimer.SetDelay (m_nextHopWait);
+    }
+  toDst.InsertPrecursor (toOrigin.GetNextHop ());
+  toOrigin.InsertPrecursor (toDst.GetNextHop ());
+  m_routingTable.Update (toDst);
+  m_routingTable.Update (toOrigin);
+
+  Ptr<Packet> packet = Create<Packet> ();
+  SocketIpTtlTag tag;
+  tag.SetTtl (toOrigin.GetHop ());
+  packet->AddPacketTag (tag);
+  packet->AddHeader (rrepHeader);
+  TypeHeader tHeader (AODVTYPE_RREP);
+  packet->AddHeader (tHeader);
+  Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
+  NS_ASSERT (socket);
+  m_txTrace (packet); // trace
+  m_rrepTxTrace (rrepHeader.GetOrigin (), rrepHeader.GetDst ()); // trace
+  socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), AODV_PORT));
+
+  // Generating gratuitous RREPs
+  if (gratRep)
+    {
+      RrepHeader gratRepHeader (/*prefix size=*/ 0, /*hops=*/ toOrigin.GetHop (), /*dst=*/ toOrigin.GetDestination (),
+                                /*dst seqno=*/ toOrigin.GetSeqNo (), /*origin=*/ toDst.GetDestination (),
+                                /*lifetime=*/ toOrigin.GetLifeTime (),
+                                /*etx*/ toOrigin.GetEtx ()); // in RREP packet for destination insert my ETX to the origin
+      gratRepHeader.SetEtxEncoding (Metric::ETX_ENCODING);
+      gratRepHeader.SetGratuitous (true);
+      Ptr<Packet> packetToDst = Create<Packet> ();
+      SocketIpTtlTag gratTag;
+      gratTag.SetTtl (toDst.GetHop ());
+      packetToDst->AddPacketTag (gratTag);
+      packetToDst->AddHeader (gratRepHeader);
+      TypeHeader type (AODVTYPE_RREP);
+      packetToDst->AddHeader (type);
+      Ptr<Socket> socket = FindSocketWithInterfaceAddress (toDst.GetInterface ());
+      NS_ASSERT (socket);
+      NS_LOG_LOGIC ("Send gratuitous RREP " << packet->GetUid ());
+      m_txTrace (packet); // trace
+      m_rrepTxTrace (gratRepHeader.GetDst (), gratRepHeader.GetOrigin ()); // trace
+      socket->SendTo (packetToDst, 0, InetSocketAddress (toDst.GetNextHop (), AODV_PORT));
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendReplyAck (Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION (this << " to " << neighbor);
+  RrepAckHeader h;
+  TypeHeader typeHeader (AODVTYPE_RREP_ACK);
+  Ptr<Packet> packet = Create<Packet> ();
+  SocketIpTtlTag tag;
+  tag.SetTtl (1);
+  packet->AddPacketTag (tag);
+  packet->AddHeader (h);
+  packet->AddHeader (typeHeader);
+  RoutingTableEntry toNeighbor;
+  m_routingTable.LookupRoute (neighbor, toNeighbor);
+  Ptr<Socket> socket = FindSocketWithInterfaceAddress (toNeighbor.GetInterface ());
+  NS_ASSERT (socket);
+  m_txTrace (packet); // trace
+  socket->SendTo (packet, 0, InetSocketAddress (neighbor, AODV_PORT));
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RecvReply (Ptr<Packet> p, ReceiverInterface const & receiver, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION (this << " src " << sender);
+  RrepHeader rrepHeader;
+  p->RemoveHeader (rrepHeader);
+  Ipv4Address dst = rrepHeader.GetDst ();
+  NS_LOG_LOGIC ("RREP destination " << dst << " RREP origin " << rrepHeader.GetOrigin ());
+
+  uint8_t hop = rrepHeader.GetHopCount () + 1;
+  rrepHeader.SetHopCount (hop);
+
+  // If RREP is Hello message
+  if (dst == rrepHeader.GetOrigin ())
+    {
+      ProcessHello (rrepHeader, receiver);
+      return;
+    }
+
+  // Add in RREP header ETX metric for last hop from neighbor to this node
+  // Now RREP contains ETX from destination to this node
+  // sender is always neighbor, destination maybe isn't
+  rrepHeader.SetEtx (Metric::AddLinkEtx (rrepHeader.GetEtx (), m_nbEtx.GetEtxForNeighbor (sender)));
+  // Forwarded RREP carries ETX in encoding of this node's metric
+  rrepHeader.SetEtxEncoding (Metric::ETX_ENCODING);
+
+    
+  /*
+   * If the route table entry to the destination is created or updated, then the following actions occur:
+   * -  the route is marked as active,
+   * -  the destination sequence number is marked as valid,
+   * -  the next hop in the route entry is assigned to be the node from which the RREP is received,
+   *    which is indicated by the source IP address field in the IP header,
+   * -  the hop count is set to the value of the hop count from RREP message + 1
+   * -  the expiry time is set to the current time plus the value of the Lifetime in the RREP message,
+   * -  etx is used from the RREP message,
+   * -  and the destination sequence number is the Destination Sequence Number in the RREP message.
+   */
+  Ptr<NetDevice> dev = receiver.device;
+  RoutingTableEntry newEntry (/*device=*/ dev, /*dst=*/ dst, /*validSeqNo=*/ true, /*seqno=*/ rrepHeader.GetDstSeqno (),
+                              /*iface=*/ receiver.ifaddr,/*hop=*/ hop,
+                              /*nextHop=*/ sender, /*lifeTime=*/ rrepHeader.GetLifeTime (),
+                              /*etx*/ rrepHeader.GetEtx ());
+  RoutingTableEntry toDst;
+  if (m_routingTable.LookupRoute (dst, toDst))
+    {
+      if (m_multipathRoutes > 1)
+        {
+          InheritAlternateRoutes (toDst, newEntry);
+        }
+      /*
+       * The existing entry is updated only in the following circumstances:
+       * (i) the sequence number in the routing table is marked as invalid in route table entry.
+       */
+      if (!toDst.GetValidSeqNo ())
+        {
+          m_routingTable.Update (newEntry);
+          NS_LOG_DEBUG ("      Route updated: the sequence number in the routing table is marked as invalid in route table entry.");
+        }
+      // (ii)the Destination Sequence Number in the RREP is greater than the node's copy of the destination sequence number and the known value is valid,
+      else if ((int32_t (rrepHeader.GetDstSeqno ()) - int32_t (toDst.GetSeqNo ())) > 0)
+        {
+          m_routingTable.Update (newEntry);
+          NS_LOG_DEBUG ("      Route updated: the Destination Sequence Number in the RREP is greater than the node's copy of the destination sequence number and the known value is valid.");
+        }
+      else
+        {
+          // (iii) the sequence numbers are the same, but the route is marked as inactive.
+          if (toDst.GetFlag () != VALID)
+            {
+              m_routingTable.Update (newEntry);
+              NS_LOG_DEBUG ("      Route updated: the sequence numbers are the same, but the route is marked as inactive.");
+            }
+          // (iv) the sequence numbers are the same, but ETX is smaller (better).
+          else if (rrepHeader.GetEtx () < toDst.GetEtx ())
+            {
+              m_routingTable.Update (newEntry);
+              NS_LOG_DEBUG ("      Route updated: the sequence numbers are the same, but ETX is smaller.");
+            }
+          // (v)  the sequence numbers and ETX are the same, and the New Hop Count is smaller than the hop count in route table entry.
+          else if ((rrepHeader.GetEtx () == toDst.GetEtx ()) && (hop < toDst.GetHop ()))
+            {
+              m_routingTable.Update (newEntry);
+              NS_LOG_DEBUG ("      Route updated: the sequence numbers and ETX are the same, and the New Hop Count is smaller than the hop count in route table entry.");
+            }
+          // Nenad ???: Should lifetime of active route from the table be updated if new route is equal to existing one?
+          else if ((toDst.GetRoute ()->GetGateway () == sender) && (rrepHeader.GetEtx () == toDst.GetEtx ()) && (hop == toDst.GetHop ()))
+            {
+              toDst.SetLifeTime (std::max (rrepHeader.GetLifeTime (), toDst.GetLifeTime ()));
+              m_routingTable.Update (toDst);
+              NS_LOG_DEBUG ("      Route updated: the same route, lite time is updated.");
+            }
+        }
+    }
+  else
+    {
+      // The forward route for this destination is created if it does not already exist.
+      NS_LOG_LOGIC ("add new route");
+      m_routingTable.AddRoute (newEntry);
+    }
+  if (m_multipathRoutes > 1)
+    {
+      AddAlternateRoute (newEntry);
+    }
+  if (m_enableRouteCache)
+    {
+      CacheRoute (rrepHeader, receiver, sender);
+    }
+  // Acknowledge receipt of the RREP by sending a RREP-ACK message back
+  if (rrepHeader.GetAckRequired ())
+    {
+      SendReplyAck (sender);
+      rrepHeader.SetAckRequired (false);
+    }
+    
+  NS_LOG_LOGIC ("receiver " << receiver.local << " origin " << rrepHeader.GetOrigin ());
+  if (IsMyOwnAddress (rrepHeader.GetOrigin ()))
+    {
+      if (toDst.GetFlag () == IN_SEARCH)
+        {
+          m_routingTable.Update (newEntry);
+          m_addressReqTimer[dst].Remove ();
+          m_addressReqTimer.erase (dst);
+        }
+      if (m_localRepairs.erase (dst) > 0)
+        {
+          NS_LOG_DEBUG ("Route to " << dst << " is locally repaired");
+          m_localRepairTrace (dst, true); // trace
+        }
+      NS_LOG_DEBUG ("NEW ROUTE FOUND!" << Simulator::Now ().GetSeconds () << " sec.");
+      NS_LOG_DEBUG (rrepHeader.GetOrigin () << "-->" << dst);
+      NS_LOG_DEBUG ("Etx = " << rrepHeader.GetEtx () << ", hops = " << int(hop)); 
+
+      m_routingTable.LookupRoute (dst, toDst);
+      if (m_enableRouteHistory)
+        {
+          RememberRoute (toDst);
+        }
+      // A gratuitous RREP is answer to a RREQ of another node, no discovery of this node ends here
+      if (!rrepHeader.GetGratuitous ())
+        {
+          m_routeDiscoveredTrace (rrepHeader.GetOrigin (), dst, toDst.GetHop (), toDst.GetEtx ()); // trace
+        }
+      SendPacketFromQueue (dst, toDst.GetRoute ());
+      return;
+    }
+
+  RoutingTableEntry toOrigin;
+  if (!m_routingTable.LookupRoute (rrepHeader.GetOrigin (), toOrigin) || toOrigin.GetFlag () == IN_SEARCH)
+    {
+      return; // Impossible! drop.
+    }
+  toOrigin.SetLifeTime (std::max (m_activeRouteTimeout, toOrigin.GetLifeTime ()));
+  m_routingTable.Update (toOrigin);
+
+  // Update information about precursors
+  if (m_routingTable.LookupValidRoute (rrepHeader.GetDst (), toDst))
+    {
+      toDst.InsertPrecursor (toOrigin.GetNextHop ());
+      m_routingTable.Update (toDst);
+
+      RoutingTableEntry toNextHopToDst;
+      m_routingTable.LookupRoute (toDst.GetNextHop (), toNextHopToDst);
+      toNextHopToDst.InsertPrecursor (toOrigin.GetNextHop ());
+      m_routingTable.Update (toNextHopToDst);
+
+      toOrigin.InsertPrecursor (toDst.GetNextHop ());
+      m_routingTable.Update (toOrigin);
+
+      RoutingTableEntry toNextHopToOrigin;
+      m_routingTable.LookupRoute (toOrigin.GetNextHop (), toNextHopToOrigin);
+      toNextHopToOrigin.InsertPrecursor (toDst.GetNextHop ());
+      m_routingTable.Update (toNextHopToOrigin);
+    }
+  SocketIpTtlTag tag;
+  p->RemovePacketTag (tag);
+  if (tag.GetTtl () < 2)
+    {
+      NS_LOG_DEBUG ("TTL exceeded. Drop RREP destination " << dst << " origin " << rrepHeader.GetOrigin ());
+      return;
+    }
+
+  Ptr<Packet> packet = Create<Packet> ();
+  SocketIpTtlTag ttl;
+  ttl.SetTtl (tag.GetTtl () - 1);
+  packet->AddPacketTag (ttl);
+  packet->AddHeader (rrepHeader);
+  TypeHeader tHeader (AODVTYPE_RREP);
+  packet->AddHeader (tHeader);
+  Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
+  NS_ASSERT (socket);
+  m_txTrace (packet); // trace
+  // Gratuitous RREP has origin and destination of the RREQ swapped, it is counted for that RREQ
+  if (rrepHeader.GetGratuitous ())
+    {
+      m_rrepTxTrace (rrepHeader.GetDst (), rrepHeader.GetOrigin ()); // trace
+    }
+  else
+    {
+      m_rrepTxTrace (rrepHeader.GetOrigin (), rrepHeader.GetDst ()); // trace
+    }
+  socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), AODV_PORT));
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RecvReplyAck (Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION (this);
+  RoutingTableEntry rt;
+  if (m_routingTable.LookupRoute (neighbor, rt))
+    {
+      rt.m_ackTimer.Cancel ();
+      rt.SetFlag (VALID);
+      m_routingTable.Update (rt);
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::ProcessHello (RrepHeader const & rrepHeader, ReceiverInterface const & receiver)
+{
+  NS_LOG_FUNCTION (this << "from " << rrepHeader.GetDst ());
+  /*
+   *  Whenever a node receives a Hello message from a neighbor, the node
+   * SHOULD make sure that it has an active route to the neighbor, and
+   * create one if necessary.
+   */
+  RoutingTableEntry toNeighbor;
+  if (!m_routingTable.LookupRoute (rrepHeader.GetDst (), toNeighbor))
+    {
+      Ptr<NetDevice> dev = receiver.device;
+      RoutingTableEntry newEntry (/*device=*/ dev, /*dst=*/ rrepHeader.GetDst (), /*validSeqNo=*/ true, /*seqno=*/ rrepHeader.GetDstSeqno (),
+                                  /*iface=*/ receiver.ifaddr,
+                                  /*hop=*/ 1, /*nextHop=*/ rrepHeader.GetDst (), /*lifeTime=*/ rrepHeader.GetLifeTime (),
+                                  /*etx*/ m_nbEtx.GetEtxForNeighbor (rrepHeader.GetDst ())); // etx from hello is useless but node has local etx for neighbor
+      m_routingTable.AddRoute (newEntry);
+    }
+  else
+    {
+      toNeighbor.SetLifeTime (std::max (Time (m_allowedHelloLoss * m_helloInterval), toNeighbor.GetLifeTime ()));
+      toNeighbor.SetSeqNo (rrepHeader.GetDstSeqno ());
+      toNeighbor.SetValidSeqNo (true);
+      toNeighbor.SetFlag (VALID);
+      toNeighbor.SetOutputDevice (receiver.device);
+      toNeighbor.SetInterface (receiver.ifaddr);
+      toNeighbor.SetHop (1);
+      toNeighbor.SetNextHop (rrepHeader.GetDst ());
+      toNeighbor.SetEtx (m_nbEtx.GetEtxForNeighbor (rrepHeader.GetDst ())); // etx from hello is useless but node has local etx for the neighbor
+      m_routingTable.Update (toNeighbor);
+    }
+  if (m_enableHello)
+    {
+      m_nb.Update (rrepHeader.GetDst (), Time (m_allowedHelloLoss * m_helloInterval));
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RecvError (Ptr<Packet> p, Ipv4Address src )
+{
+  NS_LOG_FUNCTION (this << " from " << src);
+  RerrHeader rerrHeader;
+  p->RemoveHeader (rerrHeader);
+  std::map<Ipv4Address, uint32_t> dstWithNextHopSrc;
+  std::map<Ipv4Address, uint32_t> unreachable;
+  m_routingTable.GetListOfDestinationWithNextHop (src, dstWithNextHopSrc);
+  std::pair<Ipv4Address, uint32_t> un;
+  while (rerrHeader.RemoveUnDestination (un))
+    {
+      for (std::map<Ipv4Address, uint32_t>::const_iterator i =
+             dstWithNextHopSrc.begin (); i != dstWithNextHopSrc.end (); ++i)
+        {
+          if (i->first == un.first)
+            {
+              unreachable.insert (un);
+            }
+        }
+    }
+  if (m_enableRouteCache)
+    {
+      m_routeCache.DeleteWithNextHop (src);
+    }
+  if (m_multipathRoutes > 1)
+    {
+      SwitchToAlternateRoutes (src, unreachable);
+    }
+
+  std::vector<Ipv4Address> precursors;
+  for (std::map<Ipv4Address, uint32_t>::const_iterator i = unreachable.begin ();
+       i != unreachable.end (); )
+    {
+      if (!rerrHeader.AddUnDestination (i->first, i->second))
+        {
+          TypeHeader typeHeader (AODVTYPE_RERR);
+          Ptr<Packet> packet = Create<Packet> ();
+          SocketIpTtlTag tag;
+          tag.SetTtl (1);
+          packet->AddPacketTag (tag);
+          packet->AddHeader (rerrHeader);
+          packet->AddHeader (typeHeader);
+          SendRerrMessage (packet, precursors);
+          rerrHeader.Clear ();
+        }
+      else
+        {
+          RoutingTableEntry toDst;
+          m_routingTable.LookupRoute (i->first, toDst);
+          toDst.GetPrecursors (precursors);
+          ++i;
+        }
+    }
+  if (rerrHeader.GetDestCount () != 0)
+    {
+      TypeHeader typeHeader (AODVTYPE_RERR);
+      Ptr<Packet> packet = Create<Packet> ();
+      SocketIpTtlTag tag;
+      tag.SetTtl (1);
+      packet->AddPacketTag (tag);
+      packet->AddHeader (rerrHeader);
+      packet->AddHeader (typeHeader);
+      SendRerrMessage (packet, precursors);
+    }
+  m_routingTable.InvalidateRoutesWithDst (unreachable);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RouteRequestTimerExpire (Ipv4Address dst)
+{
+  NS_LOG_LOGIC (this);
+  NS_LOG_DEBUG ("RouteRequestTimerExpire");
+  RoutingTableEntry toDst;
+  if (m_routingTable.LookupValidRoute (dst, toDst))
+    {
+      SendPacketFromQueue (dst, toDst.GetRoute ());
+      NS_LOG_LOGIC ("route to " << dst << " found");
+      if (m_localRepairs.erase (dst) > 0)
+        {
+          m_localRepairTrace (dst, true); // trace
+        }
+      return;
+    }
+  // Local repair has only one attempt, route discovery is left to the originators
+  if (m_localRepairs.find (dst) != m_localRepairs.end ())
+    {
+      LocalRepairFailed (dst);
+      return;
+    }
+  /*
+   *  If a route discovery has been attempted RreqRetries times at the maximum TTL without
+   *  receiving any RREP, all data packets destined for the corresponding destination SHOULD be
+   *  dropped from the buffer and a Destination Unreachable message SHOULD be delivered to the application.
+   */
+  if (toDst.GetRreqCnt () == m_rreqRetries)
+    {
+      NS_LOG_LOGIC ("route discovery to " << dst << " has been attempted RreqRetries (" << m_rreqRetries << ") times with ttl " << m_netDiameter);
+      m_addressReqTimer.erase (dst);
+      m_routingTable.DeleteRoute (dst);
+      TraceRouteDiscoveryFailed (dst); // trace
+      NS_LOG_DEBUG ("Route not found. Drop all packets with dst " << dst);
+      m_queue.DropPacketWithDst (dst);
+      return;
+    }
+
+  if (toDst.GetFlag () == IN_SEARCH)
+    {
+      NS_LOG_LOGIC ("Resend RREQ to " << dst << " previous ttl " << toDst.GetHop ());
+      SendRequest (dst);
+    }
+  else
+    {
+      NS_LOG_DEBUG ("Route down. Stop search. Drop packet with destination " << dst);
+      m_addressReqTimer.erase (dst);
+      m_routingTable.DeleteRoute (dst);
+      TraceRouteDiscoveryFailed (dst); // trace
+      m_queue.DropPacketWithDst (dst);
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::TraceRouteDiscoveryFailed (Ipv4Address dst) // trace
+{
+  // RREQ is sent from all interfaces, each with its own originator address
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      m_routeDiscoveryFailedTrace (j->second.GetLocal (), dst);
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::HelloTimerExpire ()
+{
+  NS_LOG_FUNCTION (this);
+  Time offset = Time (Seconds (0));
+  if (m_lastBcastTime > Time (Seconds (0)))
+    {
+      offset = Simulator::Now () - m_lastBcastTime;
+      NS_LOG_DEBUG ("Hello deferred due to last bcast at:" << m_lastBcastTime);
+    }
+  else
+    {
+      SendHello ();
+    }
+  m_htimer.Cancel ();
+  Time diff = m_helloInterval - offset;
+  m_htimer.Schedule (std::max (Time (Seconds (0)), diff));
+  m_lastBcastTime = Time (Seconds (0));
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RreqRateLimitTimerExpire ()
+{
+  NS_LOG_FUNCTION (this);
+  m_rreqCount = 0;
+  m_rreqRateLimitTimer.Schedule (Seconds (1));
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RerrRateLimitTimerExpire ()
+{
+  NS_LOG_FUNCTION (this);
+  m_rerrCount = 0;
+  m_rerrRateLimitTimer.Schedule (Seconds (1));
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RerrAggregationTimerExpire ()
+{
+  NS_LOG_FUNCTION (this);
+  std::map<Ipv4Address, uint32_t> unreachable;
+  std::vector<Ipv4Address> precursors;
+  unreachable.swap (m_pendingRerrDst);
+  precursors.swap (m_pendingRerrPrecursors);
+  bool broadcast = m_pendingRerrBroadcast;
+  m_pendingRerrBroadcast = false;
+
+  std::map<Ipv4Address, uint32_t>::const_iterator i = unreachable.begin ();
+  while (i != unreachable.end ())
+    {
+      RerrHeader rerrHeader;
+      for (; i != unreachable.end () && rerrHeader.GetDestCount () < RERR_MAX_DESTINATIONS; ++i)
+        {
+          // Route could have been repaired or rediscovered during the window
+          RoutingTableEntry toDst;
+          if (!m_routingTable.LookupValidRoute (i->first, toDst))
+            {
+              rerrHeader.AddUnDestination (i->first, i->second);
+            }
+        }
+      if (rerrHeader.GetDestCount () == 0)
+        {
+          break;
+        }
+      // A node SHOULD NOT originate more than RERR_RATELIMIT RERR messages per second.
+      if (m_rerrCount == m_rerrRateLimit)
+        {
+          NS_ASSERT (m_rerrRateLimitTimer.IsRunning ());
+          NS_LOG_LOGIC ("RerrRateLimit reached at " << Simulator::Now ().GetSeconds ()
+                                                    << "; suppressing aggregated RERR");
+          return;
+        }
+      NS_LOG_LOGIC ("Send aggregated RERR with " << (uint32_t) rerrHeader.GetDestCount () << " destinations");
+      Ptr<Packet> packet = Create<Packet> ();
+      SocketIpTtlTag tag;
+      tag.SetTtl (1);
+      packet->AddPacketTag (tag);
+      packet->AddHeader (rerrHeader);
+      packet->AddHeader (TypeHeader (AODVTYPE_RERR));
+      if (broadcast)
+        {
+          SendRerrFromAllInterfaces (packet);
+        }
+      else
+        {
+          SendRerrMessage (packet, precursors);
+        }
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::LppTimerExpire ()
+{
+  NS_LOG_FUNCTION (this);
+  //NS_LOG_DEBUG ("LPP timer expired at: " << Simulator::Now ().GetSeconds () << " s.");
+  m_lppTimer.Cancel ();
+  if (m_enableAdaptiveLpp)
+    {
+      AdaptLppInterval ();
+    }
+  m_lppTimer.Schedule (m_currentLppInterval);
+  SendLpp ();
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::AdaptLppInterval ()
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t neighborChanges, etxChanges;
+  m_nbEtx.GetAndResetChanges (neighborChanges, etxChanges);
+  if (neighborChanges > 0 || 2 * etxChanges > m_nbEtx.GetNNeighbors ())
+    {
+      m_currentLppInterval = std::max (m_minLppInterval, m_currentLppInterval / 2);
+    }
+  else if (etxChanges == 0)
+    {
+      m_currentLppInterval = std::min (m_maxLppInterval, m_currentLppInterval + m_minLppInterval);
+    }
+  // Interval is advertised in 100 ms units, so it is kept on them, and neighbors expect the next LPP on time
+  m_currentLppInterval = MilliSeconds (100 * std::max<int64_t> ((m_currentLppInterval.GetMilliSeconds () + 50) / 100, 1));
+  NS_LOG_DEBUG ("LPP interval " << m_currentLppInterval.GetSeconds () << " s, neighbor changes "
+                << neighborChanges << ", ETX changes " << etxChanges);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::AckTimerExpire (Ipv4Address neighbor, Time blacklistTimeout)
+{
+  NS_LOG_FUNCTION (this);
+  m_routingTable.MarkLinkAsUnidirectional (neighbor, blacklistTimeout);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendHello ()
+{
+  NS_LOG_FUNCTION (this);
+  /* Broadcast a RREP with TTL = 1 with the RREP message fields set as follows:
+   *   Destination IP Address         The node's IP address.
+   *   Destination Sequence Number    The node's latest sequence number.
+   *   Hop Count                      0
+   *   Lifetime                       AllowedHelloLoss * HelloInterval
+   *   ETX                            0 (not useful since HELLO is broadcast packet)
+   */
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      RrepHeader helloHeader (/*prefix size=*/ 0, /*hops=*/ 0, /*dst=*/ iface.GetLocal (), /*dst seqno=*/ m_seqNo,
+                              /*origin=*/ iface.GetLocal (),/*lifetime=*/ Time (m_allowedHelloLoss * m_helloInterval),
+                              /*etx*/ 0);
+      helloHeader.SetEtxEncoding (Metric::ETX_ENCODING);
+      Ptr<Packet> packet = Create<Packet> ();
+      SocketIpTtlTag tag;
+      tag.SetTtl (1);
+      packet->AddPacketTag (tag);
+      packet->AddHeader (helloHeader);
+      TypeHeader tHeader (AODVTYPE_RREP);
+      packet->AddHeader (tHeader);
+      PiggybackLpp (packet, iface); /*etx*/
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination;
+      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+      Time jitter = Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10)));
+      ScheduleControlPacket (socket, packet, destination, jitter, CONTROL_RREP);
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::FillLppHeader (LppHeader & lppHeader, Ipv4InterfaceAddress const & iface)
+{
+  //set fields of LPP header
+  lppHeader.SetLppId (m_nbEtx.GetLppTimeStamp ());
+  if (Metric::NEIGHBOR_LIST)
+    {
+      lppHeader.SetVersion (m_enableCompactLpp ? LppHeader::LPP_COMPACT : LppHeader::LPP_PLAIN);
+    }
+  else
+    {
+      lppHeader.SetVersion (LppHeader::LPP_NO_LIST);
+    }
+  lppHeader.SetOriginAddress (iface.GetLocal ());
+  lppHeader.SetOriginSeqno (m_seqNo);
+  if (m_enableAdaptiveLpp)
+    {
+      lppHeader.SetLppInterval (m_currentLppInterval);
+    }
+  // Delta list sequence is common for all interfaces, so it is used only with one interface
+  if (Metric::NEIGHBOR_LIST && m_enableDeltaLpp && m_socketAddresses.size () == 1)
+    {
+      bool full = m_lppFullListRequested || ++m_lppsSinceFullList >= m_lppFullListPeriod;
+      m_lppListSeqNo = (m_lppListSeqNo + 1) & 0x3F;
+      lppHeader.SetVersion (LppHeader::LPP_DELTA);
+      lppHeader.SetDeltaList (m_lppListSeqNo, full, m_lppRequestFullList);
+      m_lppRequestFullList = false;
+      if (full)
+        {
+          m_lppsSinceFullList = 0;
+          m_lppFullListRequested = false;
+          m_nbEtx.FillLppCntData (lppHeader);
+        }
+      else
+        {
+          m_nbEtx.FillLppCntDelta (lppHeader);
+        }
+      return;
+    }
+  m_nbEtx.FillLppCntData (lppHeader);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::PiggybackLpp (Ptr<Packet> packet, Ipv4InterfaceAddress const & iface)
+{
+  if (!Metric::LINK_PROBES || !m_enableEtx || !m_enableLppPiggyback)
+    {
+      return;
+    }
+  // Receiver counts only one LPP per time stamp
+  if (!m_lppPiggybackIfaces.insert (iface.GetLocal ()).second)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << iface.GetLocal ());
+  LppHeader lppHeader;
+  FillLppHeader (lppHeader, iface);
+  if (lppHeader.GetVersion () == LppHeader::LPP_PLAIN)
+    {
+      lppHeader.SetVersion (LppHeader::LPP_COMPACT);
+    }
+  packet->AddHeader (lppHeader);
+  TypeHeader tHeader (AODVTYPE_LPP);
+  packet->AddHeader (tHeader);
+  m_lppPiggybackTrace (packet, m_currentLppInterval, m_lppInterval); // trace
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendLpp ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_enableLppPiggyback)
+    {
+      // increment time stamp and clear oldest time stamp
+      m_nbEtx.GotoNextTimeStampAndClearOldest ();
+    }
+
+  // send lpp counts from past 10 seconds (not including current and oldest)
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      if (m_lppPiggybackIfaces.find (iface.GetLocal ()) != m_lppPiggybackIfaces.end ())
+        {
+          // LPP of this time stamp has been piggybacked
+          continue;
+        }
+      LppHeader lppHeader;
+      FillLppHeader (lppHeader, iface);
+      //NS_LOG_DEBUG ("LPP send: time=" << Simulator::Now ().GetSeconds () << " s, " << "source=" << iface.GetLocal ());
+
+      Ptr<Packet> packet = Create<Packet> (); // LPP packets use 0B dummy data payload
+      SocketIpTtlTag tag;
+      tag.SetTtl (1);
+      packet->AddPacketTag (tag);
+      packet->AddHeader (lppHeader);
+      TypeHeader tHeader (AODVTYPE_LPP);
+      packet->AddHeader (tHeader);
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination;
+      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+      // LPP is also broadcast packet
+      m_lastBcastTime = Simulator::Now ();
+      Time jitter = Time (MicroSeconds (m_uniformRandomVariable->GetInteger (0, 10000)));
+      // NS_LOG_DEBUG ("Jitter = " << jitter);
+      ScheduleControlPacket (socket, packet, destination, jitter, CONTROL_LPP);
+    }
+
+  if (m_enableLppPiggyback)
+    {
+      // With piggybacking LPP of the time stamp may be sent any time during LPP interval,
+      // so standalone LPP is sent at the end of interval, before the next time stamp
+      m_lppPiggybackIfaces.clear ();
+      m_nbEtx.GotoNextTimeStampAndClearOldest ();
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendPacketFromQueue (Ipv4Address dst, Ptr<Ipv4Route> route)
+{
+  NS_LOG_FUNCTION (this);
+  QueueEntry queueEntry;
+  while (m_queue.Dequeue (dst, queueEntry))
+    {
+      DeferredRouteOutputTag tag;
+      Ptr<Packet> p = ConstCast<Packet> (queueEntry.GetPacket ());
+      UnicastForwardCallback ucb = queueEntry.GetUnicastForwardCallback ();
+      Ipv4Header header = queueEntry.GetIpv4Header ();
+      if (!p->RemovePacketTag (tag))
+        {
+          // Packet of other node, buffered during local repair
+          ucb (route, p, header);
+          continue;
+        }
+      if (tag.GetInterface () != -1
+          && tag.GetInterface () != m_ipv4->GetInterfaceForDevice (route->GetOutputDevice ()))
+        {
+          NS_LOG_DEBUG ("Output device doesn't match. Dropped.");
+          return;
+        }
+      header.SetSource (route->GetSource ());
+      header.SetTtl (header.GetTtl () + 1); // compensate extra TTL decrement by fake loopback routing
+      ucb (route, p, header);
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendRerrWhenBreaksLinkToNextHop (Ipv4Address nextHop)
+{
+  NS_LOG_FUNCTION (this << nextHop);
+  RerrHeader rerrHeader;
+  std::vector<Ipv4Address> precursors;
+  std::map<Ipv4Address, uint32_t> unreachable;
+
+  RoutingTableEntry toNextHop;
+  if (!m_routingTable.LookupRoute (nextHop, toNextHop))
+    {
+      return;
+    }
+  toNextHop.GetPrecursors (precursors);
+  m_routingTable.GetListOfDestinationWithNextHop (nextHop, unreachable);
+  if (m_enableRouteCache)
+    {
+      m_routeCache.DeleteWithNextHop (nextHop);
+    }
+  if (m_multipathRoutes > 1)
+    {
+      m_routingTable.DeleteAlternatesWithNextHop (nextHop);
+      SwitchToAlternateRoutes (nextHop, unreachable);
+    }
+  if (m_enableLocalRepair)
+    {
+      StartLocalRepair (nextHop, unreachable);
+    }
+  if (m_rerrAggregationWindow > Seconds (0))
+    {
+      for (std::map<Ipv4Address, uint32_t>::const_iterator i = unreachable.begin ();
+           i != unreachable.end (); ++i)
+        {
+          RoutingTableEntry toDst;
+          m_routingTable.LookupRoute (i->first, toDst);
+          toDst.GetPrecursors (precursors);
+        }
+      unreachable.insert (std::make_pair (nextHop, toNextHop.GetSeqNo ()));
+      AggregateRerr (unreachable, precursors, false);
+      m_routingTable.InvalidateRoutesWithDst (unreachable);
+      return;
+    }
+  rerrHeader.AddUnDestination (nextHop, toNextHop.GetSeqNo ());
+  for (std::map<Ipv4Address, uint32_t>::const_iterator i = unreachable.begin (); i
+       != unreachable.end (); )
+    {
+      if (!rerrHeader.AddUnDestination (i->first, i->second))
+        {
+          NS_LOG_LOGIC ("Send RERR message with maximum size.");
+          TypeHeader typeHeader (AODVTYPE_RERR);
+          Ptr<Packet> packet = Create<Packet> ();
+          SocketIpTtlTag tag;
+          tag.SetTtl (1);
+          packet->AddPacketTag (tag);
+          packet->AddHeader (rerrHeader);
+          packet->AddHeader (typeHeader);
+          SendRerrMessage (packet, precursors);
+          rerrHeader.Clear ();
+        }
+      else
+        {
+          RoutingTableEntry toDst;
+          m_routingTable.LookupRoute (i->first, toDst);
+          toDst.GetPrecursors (precursors);
+          ++i;
+        }
+    }
+  if (rerrHeader.GetDestCount () != 0)
+    {
+      TypeHeader typeHeader (AODVTYPE_RERR);
+      Ptr<Packet> packet = Create<Packet> ();
+      SocketIpTtlTag tag;
+      tag.SetTtl (1);
+      packet->AddPacketTag (tag);
+      packet->AddHeader (rerrHeader);
+      packet->AddHeader (typeHeader);
+      SendRerrMessage (packet, precursors);
+    }
+  unreachable.insert (std::make_pair (nextHop, toNextHop.GetSeqNo ()));
+  m_routingTable.InvalidateRoutesWithDst (unreachable);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendRerrWhenNoRouteToForward (Ipv4Address dst,
+                                                             uint32_t dstSeqNo, Ipv4Address origin)
+{
+  NS_LOG_FUNCTION (this);
+  RoutingTableEntry toOrigin;
+  if (m_rerrAggregationWindow > Seconds (0))
+    {
+      // Next hop towards the originator is the only precursor, broadcast if there is no route
+      std::map<Ipv4Address, uint32_t> unreachable;
+      unreachable.insert (std::make_pair (dst, dstSeqNo));
+      std::vector<Ipv4Address> precursors;
+      bool broadcast = !m_routingTable.LookupValidRoute (origin, toOrigin);
+      if (!broadcast)
+        {
+          precursors.push_back (toOrigin.GetNextHop ());
+        }
+      AggregateRerr (unreachable, precursors, broadcast);
+      return;
+    }
+  // A node SHOULD NOT originate more than RERR_RATELIMIT RERR messages per second.
+  if (m_rerrCount == m_rerrRateLimit)
+    {
+      // Just make sure that the RerrRateLimit timer is running and will expire
+      NS_ASSERT (m_rerrRateLimitTimer.IsRunning ());
+      // discard the packet and return
+      NS_LOG_LOGIC ("RerrRateLimit reached at " << Simulator::Now ().GetSeconds () << " with timer delay left "
+                                                << m_rerrRateLimitTimer.GetDelayLeft ().GetSeconds ()
+                                                << "; suppressing RERR");
+      return;
+    }
+  RerrHeader rerrHeader;
+  rerrHeader.AddUnDestination (dst, dstSeqNo);
+  Ptr<Packet> packet = Create<Packet> ();
+  SocketIpTtlTag tag;
+  tag.SetTtl (1);
+  packet->AddPacketTag (tag);
+  packet->AddHeader (rerrHeader);
+  packet->AddHeader (TypeHeader (AODVTYPE_RERR));
+  if (m_routingTable.LookupValidRoute (origin, toOrigin))
+    {
+      Ptr<Socket> socket = FindSocketWithInterfaceAddress (
+          toOrigin.GetInterface ());
+      NS_ASSERT (socket);
+      NS_LOG_LOGIC ("Unicast RERR to the source of the data transmission");
+      m_txTrace (packet); // trace
+      socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), AODV_PORT));
+    }
+  else
+    {
+      SendRerrFromAllInterfaces (packet);
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendRerrFromAllInterfaces (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator i =
+         m_socketAddresses.begin (); i != m_socketAddresses.end (); ++i)
+    {
+      Ptr<Socket> socket = i->first;
+      Ipv4InterfaceAddress iface = i->second;
+      NS_ASSERT (socket);
+      NS_LOG_LOGIC ("Broadcast RERR message from interface " << iface.GetLocal ());
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination;
+      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+      Ptr<Packet> p = packet->Copy ();
+      PiggybackLpp (p, iface); /*etx*/
+      m_txTrace (p); // trace
+      socket->SendTo (p, 0, InetSocketAddress (destination, AODV_PORT));
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::AggregateRerr (std::map<Ipv4Address, uint32_t> const & unreachable,
+                                              std::vector<Ipv4Address> const & precursors, bool broadcast)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<Ipv4Address, uint32_t>::const_iterator i = unreachable.begin ();
+       i != unreachable.end (); ++i)
+    {
+      // The latest sequence number of the destination is sent
+      m_pendingRerrDst[i->first] = i->second;
+    }
+  for (std::vector<Ipv4Address>::const_iterator i = precursors.begin (); i != precursors.end (); ++i)
+    {
+      if (std::find (m_pendingRerrPrecursors.begin (), m_pendingRerrPrecursors.end (), *i)
+          == m_pendingRerrPrecursors.end ())
+        {
+          m_pendingRerrPrecursors.push_back (*i);
+        }
+    }
+  m_pendingRerrBroadcast = m_pendingRerrBroadcast || broadcast;
+  if (!m_pendingRerrDst.empty () && !m_rerrAggregationTimer.IsRunning ())
+    {
+      m_rerrAggregationTimer.Schedule (m_rerrAggregationWindow);
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::StartLocalRepair (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable)
+{
+  NS_LOG_FUNCTION (this << nextHop);
+  std::map<Ipv4Address, uint32_t>::iterator i = unreachable.begin ();
+  while (i != unreachable.end ())
+    {
+      if (m_localRepairs.find (i->first) != m_localRepairs.end ())
+        {
+          // Already under repair, RERR is sent if the repair fails
+          unreachable.erase (i++);
+          continue;
+        }
+      RoutingTableEntry toDst;
+      // Only routes of other nodes are repaired, own packets start new route discovery anyway
+      if (i->first == nextHop
+          || !m_routingTable.LookupRoute (i->first, toDst)
+          || toDst.GetFlag () != VALID
+          || !toDst.GetValidSeqNo ()
+          || toDst.IsPrecursorListEmpty ())
+        {
+          ++i;
+          continue;
+        }
+      if (FindOneHopDetour (toDst))
+        {
+          NS_LOG_DEBUG ("Route to " << i->first << " is switched to one-hop detour");
+          m_localRepairTrace (i->first, true); // trace
+          unreachable.erase (i++);
+          continue;
+        }
+      if (toDst.GetHop () > m_maxRepairTtl)
+        {
+          ++i;
+          continue;
+        }
+      // RREQ TTL is the last known hop count plus TtlIncrement (see SendRequest)
+      NS_LOG_DEBUG ("Local repair of route to " << i->first << " with " << (uint16_t) toDst.GetHop () << " hops");
+      // Packets to the destination are buffered from now on, even if RREQ is rate limited
+      toDst.Invalidate (m_routingTable.GetBadLinkLifetime ());
+      m_routingTable.Update (toDst);
+      m_localRepairs.insert (i->first);
+      SendRequest (i->first);
+      unreachable.erase (i++);
+    }
+}
+
+template <class Metric>
+bool
+MetricRoutingProtocol<Metric>::FindOneHopDetour (RoutingTableEntry & toDst)
+{
+  NS_LOG_FUNCTION (this << toDst.GetDestination ());
+  Ipv4Address dst = toDst.GetDestination ();
+  uint32_t linkEtx = Metric::EtxMaxValue ();
+  if (Metric::LINK_PROBES && m_enableEtx) /*etx*/
+    {
+      linkEtx = m_nbEtx.GetEtxForNeighbor (dst);
+    }
+  else if (m_enableHello && m_nb.IsNeighbor (dst))
+    {
+      linkEtx = 1;
+    }
+  if (linkEtx >= Metric::EtxMaxValue ())
+    {
+      return false;
+    }
+  // Destination is heard on the interface of the broken route
+  toDst.SetNextHop (dst);
+  toDst.SetHop (1);
+  toDst.SetEtx (Metric::AddLinkEtx (Metric::SelfEtx (), linkEtx));
+  toDst.SetLifeTime (std::max (m_activeRouteTimeout, toDst.GetLifeTime ()));
+  m_routingTable.Update (toDst);
+  return true;
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::InheritAlternateRoutes (RoutingTableEntry const & toDst, RoutingTableEntry & newEntry)
+{
+  NS_LOG_FUNCTION (this << toDst.GetDestination ());
+  if (toDst.GetFlag () != VALID
+      || !toDst.GetValidSeqNo ()
+      || toDst.GetSeqNo () != newEntry.GetSeqNo ()
+      || toDst.GetInterface () != newEntry.GetInterface ())
+    {
+      return;
+    }
+  // The new route may have more hops than this node has advertised with the sequence number
+  uint16_t advertisedHop = std::max (toDst.GetAdvertisedHop (), newEntry.GetHop ());
+  newEntry.SetAdvertisedHop (advertisedHop);
+  uint32_t maxAlternates = m_multipathRoutes - 1;
+  for (uint32_t i = 0; i < toDst.GetAlternateCount (); ++i)
+    {
+      AlternateRoute const & alternate = toDst.GetAlternate (i);
+      if (alternate.nextHop != newEntry.GetNextHop () && alternate.hop - 1 < advertisedHop)
+        {
+          newEntry.InsertAlternate (alternate, maxAlternates);
+        }
+    }
+  if (toDst.GetNextHop () != newEntry.GetNextHop () && toDst.GetHop () - 1 < advertisedHop)
+    {
+      AlternateRoute alternate;
+      alternate.nextHop = toDst.GetNextHop ();
+      alternate.hop = toDst.GetHop ();
+      alternate.etx = toDst.GetEtx ();
+      alternate.expireTime = Simulator::Now () + toDst.GetLifeTime ();
+      newEntry.InsertAlternate (alternate, maxAlternates);
+    }
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::AddAlternateRoute (RoutingTableEntry const & newEntry)
+{
+  NS_LOG_FUNCTION (this << newEntry.GetDestination ());
+  RoutingTableEntry toDst;
+  if (!m_routingTable.LookupRoute (newEntry.GetDestination (), toDst)
+      || toDst.GetFlag () != VALID
+      || toDst.GetNextHop () == newEntry.GetNextHop ()
+      || !toDst.GetValidSeqNo ()
+      || toDst.GetSeqNo () != newEntry.GetSeqNo ()
+      || toDst.GetInterface () != newEntry.GetInterface ())
+    {
+      return;
+    }
+  // AOMDV advertised hop count rule: hop count advertised by the next hop has to be below the
+  // hop count advertised by this node, so two nodes can't keep backup routes through each other
+  if (newEntry.GetHop () - 1 >= toDst.GetAdvertisedHop ())
+    {
+      NS_LOG_DEBUG ("Backup route to " << toDst.GetDestination () << " through " << newEntry.GetNextHop ()
+                                       << " is not shorter than advertised hop count " << toDst.GetAdvertisedHop ());
+      return;
+    }
+  AlternateRoute alternate;
+  alternate.nextHop = newEntry.GetNextHop ();
+  alternate.hop = newEntry.GetHop ();
+  alternate.etx = newEntry.GetEtx ();
+  alternate.expireTime = Simulator::Now () + newEntry.GetLifeTime ();
+  toDst.InsertAlternate (alternate, m_multipathRoutes - 1);
+  m_routingTable.Update (toDst);
+  NS_LOG_DEBUG ("Backup route to " << toDst.GetDestination () << " through " << alternate.nextHop
+                                   << ", etx = " << alternate.etx << ", hops = " << alternate.hop);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SwitchToAlternateRoutes (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable)
+{
+  NS_LOG_FUNCTION (this << nextHop);
+  std::map<Ipv4Address, uint32_t>::iterator i = unreachable.begin ();
+  while (i != unreachable.end ())
+    {
+      RoutingTableEntry toDst;
+      if (i->first == nextHop
+          || !m_routingTable.LookupRoute (i->first, toDst)
+          || toDst.GetFlag () != VALID)
+        {
+          ++i;
+        }
+      else if (int32_t (i->second) - int32_t (toDst.GetSeqNo ()) > 0)
+        {
+          // RERR brings newer sequence number, backup routes with the old one may lead to loops
+          NS_LOG_DEBUG ("Backup routes to " << i->first << " are dropped, newer sequence number " << i->second);
+          toDst.DeleteAllAlternates ();
+          m_routingTable.Update (toDst);
+          ++i;
+        }
+      else if (SwitchToAlternateRoute (toDst, nextHop))
+        {
+          unreachable.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+template <class Metric>
+bool
+MetricRoutingProtocol<Metric>::SwitchToAlternateRoute (RoutingTableEntry & toDst, Ipv4Address brokenNextHop)
+{
+  NS_LOG_FUNCTION (this << toDst.GetDestination () << brokenNextHop);
+  if (toDst.GetAlternateCount () == 0)
+    {
+      return false;
+    }
+  toDst.DeleteAlternate (brokenNextHop);
+  bool switched = false;
+  while (toDst.GetAlternateCount () > 0 && !switched)
+    {
+      AlternateRoute alternate = toDst.GetAlternate (0);
+      toDst.DeleteAlternate (alternate.nextHop);
+      if (alternate.expireTime <= Simulator::Now () || !IsNeighborHeard (alternate.nextHop))
+        {
+          continue; // stale backup route
+        }
+      NS_LOG_DEBUG ("Route to " << toDst.GetDestination () << " is switched from " << brokenNextHop
+                                << " to backup route through " << alternate.nextHop);
+      toDst.SetNextHop (alternate.nextHop);
+      toDst.SetHop (alternate.hop);
+      toDst.SetEtx (alternate.etx);
+      toDst.SetLifeTime (alternate.expireTime - Simulator::Now ());
+      m_routeSwitchTrace (toDst.GetDestination (), alternate.nextHop); // trace
+      switched = true;
+    }
+  m_routingTable.Update (toDst);
+  return switched;
+}
+
+template <class Metric>
+bool
+MetricRoutingProtocol<Metric>::IsNeighborHeard (Ipv4Address addr)
+{
+  if (Metric::LINK_PROBES && m_enableEtx) /*etx*/
+    {
+      return m_nbEtx.GetEtxForNeighbor (addr) < Metric::EtxMaxValue ();
+    }
+  if (m_enableHello)
+    {
+      return m_nb.IsNeighbor (addr);
+    }
+  return true;
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::CacheRoute (RrepHeader const & rrepHeader, ReceiverInterface const & receiver, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION (this << rrepHeader.GetDst () << sender);
+  RouteCache::Entry entry;
+  entry.dst = rrepHeader.GetDst ();
+  entry.nextHop = sender;
+  entry.seqNo = rrepHeader.GetDstSeqno ();
+  entry.hop = rrepHeader.GetHopCount ();
+  entry.etx = rrepHeader.GetEtx (); /*etx*/
+  entry.iface = receiver.ifaddr;
+  entry.dev = receiver.device;
+  m_routeCache.Update (entry);
+}
+
+template <class Metric>
+bool
+MetricRoutingProtocol<Metric>::InstallCachedRoute (RreqHeader const & rreqHeader, Ipv4Address src)
+{
+  NS_LOG_FUNCTION (this << rreqHeader.GetDst () << src);
+  Ipv4Address dst = rreqHeader.GetDst ();
+  RouteCache::Entry entry;
+  if (!m_routeCache.Lookup (dst, entry))
+    {
+      m_routeCacheTrace (dst, false); // trace
+      return false;
+    }
+  RoutingTableEntry toDst;
+  bool exists = m_routingTable.LookupRoute (dst, toDst);
+  if ((!rreqHeader.GetUnknownSeqno () && int32_t (entry.seqNo) - int32_t (rreqHeader.GetDstSeqno ()) < 0)
+      || (exists && toDst.GetValidSeqNo () && int32_t (entry.seqNo) - int32_t (toDst.GetSeqNo ()) < 0))
+    {
+      NS_LOG_DEBUG ("Cached route to " << dst << " has old sequence number");
+      m_routeCache.Delete (dst);
+      m_routeCacheTrace (dst, false); // trace
+      return false;
+    }
+  if (entry.nextHop == src || !IsNeighborHeard (entry.nextHop))
+    {
+      m_routeCacheTrace (dst, false); // trace
+      return false;
+    }
+  Time lifetime = entry.expire - Simulator::Now ();
+  if (exists)
+    {
+      toDst.SetFlag (VALID);
+      toDst.SetValidSeqNo (true);
+      toDst.SetSeqNo (entry.seqNo);
+      toDst.SetNextHop (entry.nextHop);
+      toDst.SetOutputDevice (entry.dev);
+      toDst.SetInterface (entry.iface);
+      toDst.SetHop (entry.hop);
+      toDst.SetEtx (entry.etx); /*etx*/
+      toDst.SetLifeTime (lifetime);
+      m_routingTable.Update (toDst);
+    }
+  else
+    {
+      RoutingTableEntry newEntry (/*device=*/ entry.dev, /*dst=*/ dst, /*validSeqNo=*/ true, /*seqno=*/ entry.seqNo,
+                                  /*iface=*/ entry.iface, /*hop=*/ entry.hop,
+                                  /*nextHop=*/ entry.nextHop, /*lifeTime=*/ lifetime,
+                                  /*etx*/ entry.etx);
+      m_routingTable.AddRoute (newEntry);
+    }
+  NS_LOG_DEBUG ("Route to " << dst << " through " << entry.nextHop << " is installed from route cache");
+  m_routeCacheTrace (dst, true); // trace
+  return true;
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::RememberRoute (RoutingTableEntry const & toDst)
+{
+  NS_LOG_FUNCTION (this << toDst.GetDestination ());
+  RouteHistory & history = m_routeHistory[toDst.GetDestination ()];
+  history.hop = toDst.GetHop ();
+  history.etx = toDst.GetEtx ();
+  history.time = Simulator::Now ();
+}
+
+template <class Metric>
+uint16_t
+MetricRoutingProtocol<Metric>::GetHistoryTtl (Ipv4Address dst)
+{
+  std::map<Ipv4Address, RouteHistory>::iterator i = m_routeHistory.find (dst);
+  if (i == m_routeHistory.end ())
+    {
+      return m_ttlStart;
+    }
+  Time age = Simulator::Now () - i->second.time;
+  if (age >= m_routeHistoryTimeout)
+    {
+      m_routeHistory.erase (i);
+      return m_ttlStart;
+    }
+  uint16_t historyTtl = i->second.hop + m_ttlIncrement;
+  if (historyTtl <= m_ttlStart)
+    {
+      return m_ttlStart;
+    }
+  double confidence = 1.0 - age.GetSeconds () / m_routeHistoryTimeout.GetSeconds ();
+  // Route over lossy links is more likely to have changed since it was discovered
+  uint16_t hops = std::max<uint16_t> (i->second.hop, 1);
+  confidence *= 1.0 - Metric::LinkLoss (i->second.etx / hops) / 2.0;
+  uint16_t ttl = m_ttlStart + (uint16_t) std::round (confidence * (historyTtl - m_ttlStart));
+  NS_LOG_DEBUG ("First RREQ ring to " << dst << " with TTL " << ttl << ", last hop count " << i->second.hop
+                << ", confidence " << confidence);
+  return std::min<uint16_t> (ttl, m_netDiameter);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::LocalRepairFailed (Ipv4Address dst)
+{
+  NS_LOG_FUNCTION (this << dst);
+  m_localRepairs.erase (dst);
+  m_addressReqTimer.erase (dst);
+  m_localRepairTrace (dst, false); // trace
+  TraceRouteDiscoveryFailed (dst); // trace
+  NS_LOG_DEBUG ("Local repair failed. Drop all packets with dst " << dst);
+  m_queue.DropPacketWithDst (dst);
+
+  RoutingTableEntry toDst;
+  if (!m_routingTable.LookupRoute (dst, toDst))
+    {
+      return;
+    }
+  std::vector<Ipv4Address> precursors;
+  toDst.GetPrecursors (precursors);
+  toDst.Invalidate (m_routingTable.GetBadLinkLifetime ());
+  m_routingTable.Update (toDst);
+  if (m_rerrAggregationWindow > Seconds (0))
+    {
+      std::map<Ipv4Address, uint32_t> unreachable;
+      unreachable.insert (std::make_pair (dst, toDst.GetSeqNo ()));
+      AggregateRerr (unreachable, precursors, false);
+      return;
+    }
+  RerrHeader rerrHeader;
+  rerrHeader.AddUnDestination (dst, toDst.GetSeqNo ());
+  Ptr<Packet> packet = Create<Packet> ();
+  SocketIpTtlTag tag;
+  tag.SetTtl (1);
+  packet->AddPacketTag (tag);
+  packet->AddHeader (rerrHeader);
+  packet->AddHeader (TypeHeader (AODVTYPE_RERR));
+  SendRerrMessage (packet, precursors);
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::SendRerrMessage (Ptr<Packet> packet, std::vector<Ipv4Address> const & precursors)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (precursors.empty ())
+    {
+      NS_LOG_LOGIC ("No precursors");
+      return;
+    }
+  // A node SHOULD NOT originate more than RERR_RATELIMIT RERR messages per second.
+  if (m_rerrCount == m_rerrRateLimit)
+    {
+      // Just make sure that the RerrRateLimit timer is running and will expire
+      NS_ASSERT (m_rerrRateLimitTimer.IsRunning ());
+      // discard the packet and return
+      NS_LOG_LOGIC ("RerrRateLimit reached at " << Simulator::Now ().GetSeconds () << " with timer delay left "
+                                                << m_rerrRateLimitTimer.GetDelayLeft ().GetSeconds ()
+                                                << "; suppressing RERR");
+      return;
+    }
+  // If there is only one precursor, RERR SHOULD be unicast toward that precursor
+  if (precursors.size () == 1)
+    {
+      RoutingTableEntry toPrecursor;
+      if (m_routingTable.LookupValidRoute (precursors.front (), toPrecursor))
+        {
+          Ptr<Socket> socket = FindSocketWithInterfaceAddress (toPrecursor.GetInterface ());
+          NS_ASSERT (socket);
+          NS_LOG_LOGIC ("one precursor => unicast RERR to " << toPrecursor.GetDestination () << " from " << toPrecursor.GetInterface ().GetLocal ());
+          ScheduleControlPacket (socket, packet, precursors.front (), Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), CONTROL_RERR);
+          m_rerrCount++;
+        }
+      return;
+    }
+
+  //  Should only transmit RERR on those interfaces which have precursor nodes for the broken route
+  std::vector<Ipv4InterfaceAddress> ifaces;
+  RoutingTableEntry toPrecursor;
+  for (std::vector<Ipv4Address>::const_iterator i = precursors.begin (); i != precursors.end (); ++i)
+    {
+      if (m_routingTable.LookupValidRoute (*i, toPrecursor)
+          && std::find (ifaces.begin (), ifaces.end (), toPrecursor.GetInterface ()) == ifaces.end ())
+        {
+          ifaces.push_back (toPrecursor.GetInterface ());
+        }
+    }
+
+  for (std::vector<Ipv4InterfaceAddress>::const_iterator i = ifaces.begin (); i != ifaces.end (); ++i)
+    {
+      Ptr<Socket> socket = FindSocketWithInterfaceAddress (*i);
+      NS_ASSERT (socket);
+      NS_LOG_LOGIC ("Broadcast RERR message from interface " << i->GetLocal ());
+      // std::cout << "Broadcast RERR message from interface " << i->GetLocal () << std::endl;
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ptr<Packet> p = packet->Copy ();
+      PiggybackLpp (p, *i); /*etx*/
+      Ipv4Address destination;
+      if (i->GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = i->GetBroadcast ();
+        }
+      ScheduleControlPacket (socket, p, destination, Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), CONTROL_RERR);
+    }
+}
+
+template <class Metric>
+Ptr<Socket>
+MetricRoutingProtocol<Metric>::FindSocketWithInterfaceAddress (Ipv4InterfaceAddress addr ) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      if (iface == addr)
+        {
+          return socket;
+        }
+    }
+  Ptr<Socket> socket;
+  return socket;
+}
+
+template <class Metric>
+Ptr<Socket>
+MetricRoutingProtocol<Metric>::FindSubnetBroadcastSocketWithInterfaceAddress (Ipv4InterfaceAddress addr ) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketSubnetBroadcastAddresses.begin (); j != m_socketSubnetBroadcastAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      if (iface == addr)
+        {
+          return socket;
+        }
+    }
+  Ptr<Socket> socket;
+  return socket;
+}
+
+template <class Metric>
+void
+MetricRoutingProtocol<Metric>::DoInitialize (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t startTime;
+  if (m_enableHello)
+    {
+      m_htimer.SetFunction (&MetricRoutingProtocol::HelloTimerExpire, this);
+      startTime = m_uniformRandomVariable->GetInteger (0, 100);
+      NS_LOG_DEBUG ("Starting at time " << startTime << "ms");
+      m_htimer.Schedule (MilliSeconds (startTime));
+    }
+  if (Metric::LINK_PROBES && m_enableEtx) /*etx*/
+    {
+      m_currentLppInterval = m_lppInterval;
+      if (m_enableAdaptiveLpp)
+        {
+          NS_ASSERT_MSG (m_minLppInterval <= m_maxLppInterval, "MinLppInterval must not exceed MaxLppInterval");
+          m_currentLppInterval = std::min (m_maxLppInterval, std::max (m_minLppInterval, m_lppInterval));
+        }
+      // Neighbors' LPP intervals differ, so every neighbor has its own LPP count slots
+      m_nbEtx.SetVariableSlots (m_enableAdaptiveLpp, m_lppInterval);
+      m_lppTimer.SetFunction (&MetricRoutingProtocol::LppTimerExpire, this);
+      startTime = m_uniformRandomVariable->GetInteger (0, 100);
+      NS_LOG_DEBUG ("LPP timer starting at time " << startTime << "ms");
+      m_lppTimer.Schedule (MilliSeconds (startTime));
+    }
+  Ipv4RoutingProtocol::DoInitialize ();
+}
+
+template class MetricRoutingProtocol<HopCountMetric>;
+template class MetricRoutingProtocol<EtxMetric>;
+template class MetricRoutingProtocol<LightEtxMetric>;
+template class MetricRoutingProtocol<LightReverseEtxMetric>;
+template class MetricRoutingProtocol<PowerLightReverseEtxMetric>;
+
+NS_OBJECT_ENSURE_REGISTERED (HopCountRoutingProtocol);
+NS_OBJECT_ENSURE_REGISTERED (EtxRoutingProtocol);
+NS_OBJECT_ENSURE_REGISTERED (LightEtxRoutingProtocol);
+NS_OBJECT_ENSURE_REGISTERED (LightReverseEtxRoutingProtocol);
+NS_OBJECT_ENSURE_REGISTERED (PowerLightReverseEtxRoutingProtocol);
+
+} //namespace aodv
+} //namespace ns3
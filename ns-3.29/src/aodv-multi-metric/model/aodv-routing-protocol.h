@@ -0,0 +1,908 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 IITP RAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Based on
+ *      NS-2 AODV model developed by the CMU/MONARCH group and optimized and
+ *      tuned by Samir Das and Mahesh Marina, University of Cincinnati;
+ *
+ *      AODV-UU implementation by Erik Nordström of Uppsala University
+ *      http://core.it.uu.se/core/index.php/AODV-UU
+ *
+ * Authors: Elena Buchatskaia <borovkovaes@iitp.ru>
+ *          Pavel Boyko <boyko@iitp.ru>
+ *
+ * Modified by: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtic@gmail.com>
+ *              Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+#ifndef AODVROUTINGPROTOCOL_H
+#define AODVROUTINGPROTOCOL_H
+
+#include "aodv-rtable.h"
+#include "aodv-rqueue.h"
+#include "aodv-route-cache.h"
+#include "aodv-packet.h"
+#include "aodv-neighbor.h"
+#include "aodv-dpd.h"
+#include "ns3/node.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include <map>
+#include <set>
+#include "aodv-metric.h"
+#include "aodv-neighbor-etx.h"
+#include "ns3/traced-callback.h" // trace
+#include "ns3/event-id.h"
+
+namespace ns3 {
+namespace aodv {
+/**
+ * \ingroup aodv
+ *
+ * \brief AODV routing protocol
+ *
+ * Protocol parameters, attributes and state which do not depend on the link metric.
+ * The protocol itself is implemented by MetricRoutingProtocol for each of the metrics.
+ */
+class RoutingProtocol : public Ipv4RoutingProtocol
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  static const uint32_t AODV_PORT;
+  /// Maximal number of unreachable destinations in aggregated RERR, so that it fits in MTU with piggybacked LPP
+  static const uint32_t RERR_MAX_DESTINATIONS;
+
+  /// constructor
+  RoutingProtocol ();
+  virtual ~RoutingProtocol ();
+  virtual void DoDispose ();
+
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+
+  // Handle protocol parameters
+  /**
+   * Get maximum queue time
+   * \returns the maximum queue time
+   */
+  Time GetMaxQueueTime () const
+  {
+    return m_maxQueueTime;
+  }
+  /**
+   * Set the maximum queue time
+   * \param t the maximum queue time
+   */
+  void SetMaxQueueTime (Time t);
+  /**
+   * Get the maximum queue length
+   * \returns the maximum queue length
+   */
+  uint32_t GetMaxQueueLen () const
+  {
+    return m_maxQueueLen;
+  }
+  /**
+   * Set the maximum queue length
+   * \param len the maximum queue length
+   */
+  void SetMaxQueueLen (uint32_t len);
+  /**
+   * Get the maximal number of cached routes
+   * \returns the maximal number of cached routes
+   */
+  uint32_t GetRouteCacheSize () const
+  {
+    return m_routeCacheSize;
+  }
+  /**
+   * Set the maximal number of cached routes
+   * \param size the maximal number of cached routes
+   */
+  void SetRouteCacheSize (uint32_t size);
+  /**
+   * Get the lifetime of cached routes
+   * \returns the lifetime of cached routes
+   */
+  Time GetRouteCacheLifetime () const
+  {
+    return m_routeCacheLifetime;
+  }
+  /**
+   * Set the lifetime of cached routes
+   * \param t the lifetime of cached routes
+   */
+  void SetRouteCacheLifetime (Time t);
+  /**
+   * Get destination only flag
+   * \returns the destination only flag
+   */
+  bool GetDestinationOnlyFlag () const
+  {
+    return m_destinationOnly;
+  }
+  /**
+   * Set destination only flag
+   * \param f the destination only flag
+   */
+  void SetDestinationOnlyFlag (bool f)
+  {
+    m_destinationOnly = f;
+  }
+  /**
+   * Get gratuitous reply flag
+   * \returns the gratuitous reply flag
+   */
+  bool GetGratuitousReplyFlag () const
+  {
+    return m_gratuitousReply;
+  }
+  /**
+   * Set gratuitous reply flag
+   * \param f the gratuitous reply flag
+   */
+  void SetGratuitousReplyFlag (bool f)
+  {
+    m_gratuitousReply = f;
+  }
+  /**
+   * Set hello enable
+   * \param f the hello enable flag
+   */
+  void SetHelloEnable (bool f)
+  {
+    m_enableHello = f;
+  }
+  /**
+   * Get hello enable flag
+   * \returns the enable hello flag
+   */
+  bool GetHelloEnable () const
+  {
+    return m_enableHello;
+  }
+  /**
+   * Set broadcast enable flag
+   * \param f enable broadcast flag
+   */
+  void SetBroadcastEnable (bool f)
+  {
+    m_enableBroadcast = f;
+  }
+  /**
+   * Get broadcast enable flag
+   * \returns the broadcast enable flag
+   */
+  bool GetBroadcastEnable () const
+  {
+    return m_enableBroadcast;
+  }
+
+  void SetEtxEnable (bool f) 
+  { 
+    m_enableEtx = f; /*etx*/
+  }
+  
+  bool GetEtxEnable () const 
+  { 
+    return m_enableEtx; /*etx*/
+  }
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * TracedCallback signature for sent link probe packets.
+   *
+   * \param [in] packet The LPP packet.
+   * \param [in] interval The time until the next LPP of this node.
+   * \param [in] baseInterval The LppInterval attribute, interval of nodes without adaptive LPP.
+   */
+  typedef void (* LppTxTracedCallback)
+    (Ptr<const Packet> packet, Time interval, Time baseInterval);
+  /**
+   * TracedCallback signature for forwarded RREQs.
+   *
+   * \param [in] origin The RREQ originator.
+   * \param [in] id The RREQ ID.
+   * \param [in] absorbed The number of better copies of the RREQ received during forwarding
+   *                      hold-down, each of them would be forwarded without hold-down.
+   */
+  typedef void (* RreqForwardTracedCallback)
+    (Ipv4Address origin, uint32_t id, uint32_t absorbed);
+  /**
+   * TracedCallback signature for RREQs sent by the originator.
+   *
+   * \param [in] origin The RREQ originator, address of the interface which sends the RREQ.
+   * \param [in] id The RREQ ID.
+   * \param [in] dst The destination of route discovery.
+   * \param [in] retry True if route discovery of the destination is already in progress.
+   */
+  typedef void (* RreqTxTracedCallback)
+    (Ipv4Address origin, uint32_t id, Ipv4Address dst, bool retry);
+  /**
+   * TracedCallback signature for RREPs sent and forwarded, and for failed route discoveries.
+   * RREP carries no RREQ ID, so route discovery is identified by its originator and destination.
+   *
+   * \param [in] origin The originator of route discovery.
+   * \param [in] dst The destination of route discovery.
+   */
+  typedef void (* RouteDiscoveryTracedCallback)
+    (Ipv4Address origin, Ipv4Address dst);
+  /**
+   * TracedCallback signature for RREPs received by the originator of route discovery.
+   *
+   * \param [in] origin The originator of route discovery.
+   * \param [in] dst The destination of route discovery.
+   * \param [in] hopCount The hop count of the route to the destination in the routing table.
+   * \param [in] etx The ETX of the route to the destination in the routing table.
+   */
+  typedef void (* RouteDiscoveredTracedCallback)
+    (Ipv4Address origin, Ipv4Address dst, uint8_t hopCount, uint32_t etx);
+  /**
+   * TracedCallback signature for local repairs of broken routes.
+   *
+   * \param [in] dst The destination of the broken route.
+   * \param [in] repaired True if the route is repaired, by one-hop detour or by repair RREQ.
+   */
+  typedef void (* LocalRepairTracedCallback)
+    (Ipv4Address dst, bool repaired);
+  /**
+   * TracedCallback signature for switches of broken routes to backup routes in multipath mode.
+   *
+   * \param [in] dst The destination of the route.
+   * \param [in] nextHop The next hop of the backup route.
+   */
+  typedef void (* RouteSwitchTracedCallback)
+    (Ipv4Address dst, Ipv4Address nextHop);
+  /**
+   * TracedCallback signature for route cache lookups of RREQs answered by intermediate node.
+   *
+   * \param [in] dst The destination of the RREQ.
+   * \param [in] hit True if the cached route is used for the reply.
+   */
+  typedef void (* RouteCacheTracedCallback)
+    (Ipv4Address dst, bool hit);
+
+protected:
+  // Protocol parameters.
+  uint32_t m_rreqRetries;             ///< Maximum number of retransmissions of RREQ with TTL = NetDiameter to discover a route
+  uint16_t m_ttlStart;                ///< Initial TTL value for RREQ.
+  uint16_t m_ttlIncrement;            ///< TTL increment for each attempt using the expanding ring search for RREQ dissemination.
+  uint16_t m_ttlThreshold;            ///< Maximum TTL value for expanding ring search, TTL = NetDiameter is used beyond this value.
+  uint16_t m_timeoutBuffer;           ///< Provide a buffer for the timeout.
+  uint16_t m_rreqRateLimit;           ///< Maximum number of RREQ per second.
+  uint16_t m_rerrRateLimit;           ///< Maximum number of REER per second.
+  Time m_activeRouteTimeout;          ///< Period of time during which the route is considered to be valid.
+  uint32_t m_netDiameter;             ///< Net diameter measures the maximum possible number of hops between two nodes in the network
+  /**
+   *  NodeTraversalTime is a conservative estimate of the average one hop traversal time for packets
+   *  and should include queuing delays, interrupt processing times and transfer times.
+   */
+  Time m_nodeTraversalTime;
+  Time m_netTraversalTime;             ///< Estimate of the average net traversal time.
+  Time m_pathDiscoveryTime;            ///< Estimate of maximum time needed to find route in network.
+  Time m_myRouteTimeout;               ///< Value of lifetime field in RREP generating by this node.
+  /**
+   * Every HelloInterval the node checks whether it has sent a broadcast  within the last HelloInterval.
+   * If it has not, it MAY broadcast a  Hello message
+   */
+  Time m_helloInterval;
+  uint32_t m_allowedHelloLoss;         ///< Number of hello messages which may be loss for valid link
+  /**
+   * DeletePeriod is intended to provide an upper bound on the time for which an upstream node A
+   * can have a neighbor B as an active next hop for destination D, while B has invalidated the route to D.
+   */
+  Time m_deletePeriod;
+  Time m_nextHopWait;                  ///< Period of our waiting for the neighbour's RREP_ACK
+  Time m_blackListTimeout;             ///< Time for which the node is put into the blacklist
+  uint32_t m_maxQueueLen;              ///< The maximum number of packets that we allow a routing protocol to buffer.
+  Time m_maxQueueTime;                 ///< The maximum period of time that a routing protocol is allowed to buffer a packet for.
+  bool m_destinationOnly;              ///< Indicates only the destination may respond to this RREQ.
+  bool m_gratuitousReply;              ///< Indicates whether a gratuitous RREP should be unicast to the node originated route discovery.
+  bool m_enableHello;                  ///< Indicates whether a hello messages enable
+  bool m_enableBroadcast;              ///< Indicates whether a a broadcast data packets forwarding enable
+  Time m_rreqHoldDown;                 ///< Maximal delay of RREQ forwarding, zero disables hold-down
+  Time m_rerrAggregationWindow;        ///< Time for which RERR triggers are merged, zero disables aggregation
+  bool m_enableLocalRepair;            ///< Indicates whether intermediate node repairs broken routes before sending RERR
+  uint16_t m_maxRepairTtl;             ///< Maximal hop count of the broken route which is locally repaired
+  uint32_t m_multipathRoutes;          ///< Maximal number of routes per destination, the route and its backups
+  bool m_enableRouteCache;             ///< Indicates whether routes from forwarded and received RREPs are cached for RREQ replies
+  uint32_t m_routeCacheSize;           ///< Maximal number of cached routes
+  Time m_routeCacheLifetime;           ///< Lifetime of cached routes
+  bool m_enableRouteHistory;           ///< Indicates whether the first RREQ ring is seeded by the last discovered hop count
+  Time m_routeHistoryTimeout;          ///< Time in which confidence of the last discovered hop count decays to zero
+  bool m_enableControlScheduler;       ///< Indicates whether jittered control packets are sent through the priority queue
+  uint32_t m_controlQueueLength;       ///< Maximal number of control packets in the priority queue
+  //\}
+
+  /// IP protocol
+  Ptr<Ipv4> m_ipv4;
+  /// Raw unicast socket per each IP interface, map socket -> iface address (IP + mask)
+  std::map< Ptr<Socket>, Ipv4InterfaceAddress > m_socketAddresses;
+  /// Raw subnet directed broadcast socket per each IP interface, map socket -> iface address (IP + mask)
+  std::map< Ptr<Socket>, Ipv4InterfaceAddress > m_socketSubnetBroadcastAddresses;
+  /// Loopback device used to defer RREQ until packet will be fully formed
+  Ptr<NetDevice> m_lo;
+
+  /// Routing table
+  RoutingTable m_routingTable;
+  /// A "drop-front" queue used by the routing layer to buffer packets to which it does not have a route.
+  RequestQueue m_queue;
+  /// Routes learned from RREPs, used for replies by intermediate node
+  RouteCache m_routeCache;
+  /// Broadcast ID
+  uint32_t m_requestId;
+  /// Request sequence number
+  uint32_t m_seqNo;
+  /// Handle duplicated RREQ
+  IdCache m_rreqIdCache;
+  /// Handle duplicated broadcast/multicast packets
+  DuplicatePacketDetection m_dpd;
+  /// Handle neighbors
+  Neighbors m_nb;
+  /// Number of RREQs used for RREQ rate control
+  uint16_t m_rreqCount;
+  /// Number of RERRs used for RERR rate control
+  uint16_t m_rerrCount;
+
+  /// Enable link probe packets for ETX metric
+  bool m_enableEtx; /*etx*/
+  /// LPP interval
+  Time m_lppInterval; /*etx*/
+  /// Send LPP neighbor list in compact encoding
+  bool m_enableCompactLpp; /*etx*/
+  /// PLR-ETX metric parameters alpha and beta
+  double m_a, m_b; /*etx*/
+  /// Adapt LPP interval to the rate of changes in the neighborhood
+  bool m_enableAdaptiveLpp; /*etx*/
+  /// Bounds of adaptive LPP interval
+  Time m_minLppInterval, m_maxLppInterval; /*etx*/
+  /// Current LPP interval, equal to m_lppInterval if adaptive LPP is disabled
+  Time m_currentLppInterval; /*etx*/
+  /// Piggyback LPP on broadcast RREQ, RERR and HELLO
+  bool m_enableLppPiggyback; /*etx*/
+  /// Interfaces which have sent piggybacked LPP in the current time stamp
+  std::set<Ipv4Address> m_lppPiggybackIfaces; /*etx*/
+  /// Send only changed LPP counts, with full list every m_lppFullListPeriod LPPs
+  bool m_enableDeltaLpp; /*etx*/
+  /// Number of LPPs between two full lists in delta LPP mode
+  uint32_t m_lppFullListPeriod; /*etx*/
+  /// Sequence number of the last sent delta LPP list
+  uint8_t m_lppListSeqNo; /*etx*/
+  /// Number of LPPs sent since the last full list
+  uint32_t m_lppsSinceFullList; /*etx*/
+  /// Some neighbor has requested full list, or nothing has been sent yet
+  bool m_lppFullListRequested; /*etx*/
+  /// Delta from some neighbor is missed, so full lists are requested
+  bool m_lppRequestFullList; /*etx*/
+  /// Link probe packet timer
+  Timer m_lppTimer; /*etx*/
+  /// Hello timer
+  Timer m_htimer;
+  /// RREQ rate limit timer
+  Timer m_rreqRateLimitTimer;
+  /// RERR rate limit timer
+  Timer m_rerrRateLimitTimer;
+  /// RERR aggregation window timer
+  Timer m_rerrAggregationTimer;
+  /// Control packet scheduler timer, expires at the earliest jittered send time in the queue
+  Timer m_controlTxTimer;
+  /// Unreachable destinations waiting for aggregated RERR, map destination -> sequence number
+  std::map<Ipv4Address, uint32_t> m_pendingRerrDst;
+  /// Precursors of the unreachable destinations waiting for aggregated RERR
+  std::vector<Ipv4Address> m_pendingRerrPrecursors;
+  /// Some aggregated destination has no precursor, so aggregated RERR is broadcast from all interfaces
+  bool m_pendingRerrBroadcast;
+  /// Destinations of broken routes under local repair, their packets wait in the request queue
+  std::set<Ipv4Address> m_localRepairs;
+  /// Map IP address + RREQ timer.
+  std::map<Ipv4Address, Timer> m_addressReqTimer;
+  /// The last route discovered by this node to the destination, kept after the route is deleted
+  struct RouteHistory
+  {
+    uint16_t hop;       ///< Hop count of the route
+    uint32_t etx;       ///< ETX of the route
+    Time time;          ///< When the route is discovered
+  };
+  /// Route history, map destination -> the last discovered route
+  std::map<Ipv4Address, RouteHistory> m_routeHistory;
+
+  /// Interface which has received AODV packet, resolved once per packet
+  struct ReceiverInterface
+  {
+    Ipv4Address local;           ///< Local address of the receiving socket
+    Ptr<NetDevice> device;       ///< Net device of the interface
+    Ipv4InterfaceAddress ifaddr; ///< The first address of the interface
+  };
+  /// Receiving interfaces, map local address -> interface, cleared when interfaces or addresses change
+  std::map<Ipv4Address, ReceiverInterface> m_receiverInterfaces;
+
+  /// RREQ waiting for forwarding hold-down to expire, the best copy received so far
+  struct HeldRequest
+  {
+    RreqHeader header;  ///< RREQ to forward
+    uint8_t ttl;        ///< IP TTL of forwarded RREQ
+    uint32_t absorbed;  ///< Number of better copies received during hold-down
+    EventId event;      ///< Forwarding event
+  };
+  /// RREQs in forwarding hold-down, map (originator, RREQ ID) -> held RREQ
+  std::map<std::pair<Ipv4Address, uint32_t>, HeldRequest> m_heldRequests;
+
+  /// Priority of control packets in the control packet scheduler, lower value is sent first
+  enum ControlPriority
+  {
+    CONTROL_RERR = 0,   ///< RERR
+    CONTROL_RREP = 1,   ///< RREP (HELLO), other RREPs are unicast without jitter
+    CONTROL_RREQ = 2,   ///< RREQ sent or forwarded
+    CONTROL_LPP = 3     ///< standalone LPP
+  };
+  /// Control packet waiting for its jittered send time
+  struct ControlPacket
+  {
+    ControlPriority priority;   ///< Priority of the packet
+    Time due;                   ///< Jittered send time
+    Ptr<Socket> socket;         ///< Socket to send the packet from
+    Ptr<Packet> packet;         ///< The packet
+    Ipv4Address destination;    ///< Destination of the packet
+  };
+  /// Control packet queue, ordered by priority and then by send time
+  std::vector<ControlPacket> m_controlQueue;
+
+  /// Provides uniform random variables.
+  Ptr<UniformRandomVariable> m_uniformRandomVariable;
+  /// Keep track of the last bcast time
+  Time m_lastBcastTime;
+
+  /// Traced Callback: transmitted packets.
+  TracedCallback<Ptr<const Packet> > m_txTrace; // trace
+  /// Traced Callback: transmitted LPPs, with current and base LPP interval.
+  TracedCallback<Ptr<const Packet>, Time, Time> m_lppTxTrace; // trace
+  /// Traced Callback: LPPs piggybacked on other AODV messages, with current and base LPP interval.
+  TracedCallback<Ptr<const Packet>, Time, Time> m_lppPiggybackTrace; // trace
+  /// Traced Callback: forwarded RREQs, with number of copies absorbed during hold-down.
+  TracedCallback<Ipv4Address, uint32_t, uint32_t> m_rreqForwardTrace; // trace
+  /// Traced Callback: RREQs sent by the originator.
+  TracedCallback<Ipv4Address, uint32_t, Ipv4Address, bool> m_rreqTxTrace; // trace
+  /// Traced Callback: RREPs sent and forwarded, identified by (origin, destination).
+  TracedCallback<Ipv4Address, Ipv4Address> m_rrepTxTrace; // trace
+  /// Traced Callback: RREPs received by the originator, with route in the routing table.
+  TracedCallback<Ipv4Address, Ipv4Address, uint8_t, uint32_t> m_routeDiscoveredTrace; // trace
+  /// Traced Callback: route discoveries given up by the originator.
+  TracedCallback<Ipv4Address, Ipv4Address> m_routeDiscoveryFailedTrace; // trace
+  /// Traced Callback: local repairs, successful or not.
+  TracedCallback<Ipv4Address, bool> m_localRepairTrace; // trace
+  /// Traced Callback: broken routes switched to backup routes.
+  TracedCallback<Ipv4Address, Ipv4Address> m_routeSwitchTrace; // trace
+  /// Traced Callback: route cache lookups, hit or miss.
+  TracedCallback<Ipv4Address, bool> m_routeCacheTrace; // trace
+  /// Traced Callback: control packets dropped by the control packet scheduler over the queue length.
+  TracedCallback<Ptr<const Packet> > m_controlDropTrace; // trace
+};
+
+/**
+ * \ingroup aodv
+ *
+ * \brief AODV routing protocol with link metric policy Metric (see aodv-metric.h)
+ *
+ * Metric is resolved at compile time, so link ETX lookup and RREQ/RREP ETX accumulation
+ * are not dispatched through virtual calls. Protocols for all metrics are built together
+ * and can be mixed in one simulation, see AodvHelper::SetMetric.
+ */
+template <class Metric>
+class MetricRoutingProtocol : public RoutingProtocol
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  MetricRoutingProtocol ();
+
+  // Inherited from Ipv4RoutingProtocol
+  Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+  bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                   UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                   LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+
+protected:
+  virtual void DoInitialize (void);
+private:
+  /// ETX for neighbors
+  NeighborEtx<Metric> m_nbEtx; /*etx*/
+
+  /// Start protocol operation
+  void Start ();
+  /**
+   * Queue packet and send route request
+   *
+   * \param p the packet to route
+   * \param header the IP header
+   * \param ucb the UnicastForwardCallback function
+   * \param ecb the ErrorCallback function
+   */ 
+  void DeferredRouteOutput (Ptr<const Packet> p, const Ipv4Header & header, UnicastForwardCallback ucb, ErrorCallback ecb);
+  /**
+   * If route exists and is valid, forward packet.
+   *
+   * \param p the packet to route
+   * \param header the IP header
+   * \param ucb the UnicastForwardCallback function
+   * \param ecb the ErrorCallback function
+   * \returns true if forwarded
+   */ 
+  bool Forwarding (Ptr<const Packet> p, const Ipv4Header & header, UnicastForwardCallback ucb, ErrorCallback ecb);
+  /**
+   * Repeated attempts by a source node at route discovery for a single destination
+   * use the expanding ring search technique.
+   * \param dst the destination IP address
+   */
+  void ScheduleRreqRetry (Ipv4Address dst);
+  /**
+   * Set lifetime field in routing table entry to the maximum of existing lifetime and lt, if the entry exists
+   * \param addr - destination address
+   * \param lt - proposed time for lifetime field in routing table entry for destination with address addr.
+   * \return true if route to destination address addr exist
+   */
+  bool UpdateRouteLifeTime (Ipv4Address addr, Time lt);
+  /**
+   * Update neighbor record.
+   * \param receiver is supposed to be my interface
+   * \param sender is supposed to be IP address of my neighbor.
+   */
+  void UpdateRouteToNeighbor (Ipv4Address sender, ReceiverInterface const & receiver);
+  /**
+   * Resolve interface of the local address, the result is cached until interfaces or
+   * addresses of the node change
+   * \param local the local address of the receiving socket
+   * \returns the receiving interface
+   */
+  ReceiverInterface const & GetReceiverInterface (Ipv4Address local);
+  /**
+   * Test whether the provided address is assigned to an interface on this node
+   * \param src the source IP address
+   * \returns true if the IP address is the node's IP address
+   */
+  bool IsMyOwnAddress (Ipv4Address src);
+  /**
+   * Find unicast socket with local interface address iface
+   *
+   * \param iface the interface
+   * \returns the socket associated with the interface
+   */
+  Ptr<Socket> FindSocketWithInterfaceAddress (Ipv4InterfaceAddress iface) const;
+  /**
+   * Find subnet directed broadcast socket with local interface address iface
+   *
+   * \param iface the interface
+   * \returns the socket associated with the interface
+   */
+  Ptr<Socket> FindSubnetBroadcastSocketWithInterfaceAddress (Ipv4InterfaceAddress iface) const;
+  /**
+   * Process hello message
+   * 
+   * \param rrepHeader RREP message header
+   * \param receiver receiver interface
+   */
+  void ProcessHello (RrepHeader const & rrepHeader, ReceiverInterface const & receiver);
+  /**
+   * Create loopback route for given header
+   *
+   * \param header the IP header
+   * \param oif the output interface net device
+   * \returns the route
+   */
+  Ptr<Ipv4Route> LoopbackRoute (const Ipv4Header & header, Ptr<NetDevice> oif) const;
+
+  ///\name Receive control packets
+  //\{
+  /// Receive and process control packet
+  void RecvAodv (Ptr<Socket> socket);
+  /// Receive RREQ
+  void RecvRequest (Ptr<Packet> p, ReceiverInterface const & receiver, Ipv4Address src);
+  /// Receive RREP
+  void RecvReply (Ptr<Packet> p, ReceiverInterface const & receiver, Ipv4Address src);
+  /// Receive RREP_ACK
+  void RecvReplyAck (Ipv4Address neighbor);
+  /// Receive RERR from node with address src
+  void RecvError (Ptr<Packet> p, Ipv4Address src);
+  /// Receive LPP
+  void RecvLpp (Ptr<Packet> p, ReceiverInterface const & receiver, Ipv4Address src); /*etx*/
+  //\}
+
+  ///\name Send
+  //\{
+  /// Forward packet from route request queue
+  void SendPacketFromQueue (Ipv4Address dst, Ptr<Ipv4Route> route);
+  /**
+   * Fill LPP header to be sent from interface iface
+   * \param lppHeader the LPP header
+   * \param iface the interface
+   */
+  void FillLppHeader (LppHeader & lppHeader, Ipv4InterfaceAddress const & iface); /*etx*/
+  /**
+   * Piggyback LPP on broadcast AODV message, at most once per LPP time stamp and interface.
+   * LPP header is added in front of the message, so it is processed first.
+   * \param packet the packet with AODV message, including its type header
+   * \param iface the interface which sends the packet
+   */
+  void PiggybackLpp (Ptr<Packet> packet, Ipv4InterfaceAddress const & iface); /*etx*/
+  /// Send hello
+  void SendHello ();
+  /// Send link probe packet
+  void SendLpp (); /*etx*/
+  /// Send RREQ
+  void SendRequest (Ipv4Address dst);
+  /**
+   * Forward RREQ from all interfaces
+   * \param rreqHeader the RREQ header
+   * \param ttl the IP TTL of forwarded RREQ
+   */
+  void ForwardRequest (RreqHeader const & rreqHeader, uint8_t ttl);
+  /**
+   * Hold RREQ before forwarding, hold-down grows from RreqHoldDown/2 for a route of perfect
+   * links to RreqHoldDown as the mean link quality of the route gets worse. Copy of a held
+   * RREQ replaces it, since only copies with better ETX are forwarded.
+   * \param rreqHeader the RREQ header
+   * \param ttl the IP TTL of forwarded RREQ
+   */
+  void HoldRequest (RreqHeader const & rreqHeader, uint8_t ttl);
+  /// Send RREP
+  void SendReply (RreqHeader const & rreqHeader, RoutingTableEntry const & toOrigin);
+  /** Send RREP by intermediate node
+   * \param toDst routing table entry to destination
+   * \param toOrigin routing table entry to originator
+   * \param gratRep indicates whether a gratuitous RREP should be unicast to destination
+   */
+  void SendReplyByIntermediateNode (RoutingTableEntry & toDst, RoutingTableEntry & toOrigin, bool gratRep);
+  /// Send RREP_ACK
+  void SendReplyAck (Ipv4Address neighbor);
+  /// Initiate RERR
+  void SendRerrWhenBreaksLinkToNextHop (Ipv4Address nextHop);
+  /// Forward RERR
+  void SendRerrMessage (Ptr<Packet> packet, std::vector<Ipv4Address> const & precursors);
+  /**
+   * Send RERR message when no route to forward input packet. Unicast if there is reverse route to originating node, broadcast otherwise.
+   * \param dst - destination node IP address
+   * \param dstSeqNo - destination node sequence number
+   * \param origin - originating node IP address
+   */
+  void SendRerrWhenNoRouteToForward (Ipv4Address dst, uint32_t dstSeqNo, Ipv4Address origin);
+  /**
+   * Broadcast RERR message from all interfaces
+   * \param packet - RERR packet
+   */
+  void SendRerrFromAllInterfaces (Ptr<Packet> packet);
+  /**
+   * Add unreachable destinations to RERR aggregated in the current window, the window
+   * is started by the first destination
+   * \param unreachable - unreachable destinations with their sequence numbers
+   * \param precursors - precursors which should receive RERR
+   * \param broadcast - RERR should be broadcast from all interfaces, regardless of precursors
+   */
+  void AggregateRerr (std::map<Ipv4Address, uint32_t> const & unreachable,
+                      std::vector<Ipv4Address> const & precursors, bool broadcast);
+  /**
+   * Repair routes broken with the link to the next hop, which are used by precursors.
+   * Route is switched to one-hop detour if the destination is a neighbor now, otherwise
+   * TTL-limited RREQ is sent if the route is not longer than MaxRepairTtl. Repaired
+   * destinations, and destinations under repair, are removed from the unreachable list.
+   * \param nextHop - the next hop of the broken routes
+   * \param unreachable - destinations with the next hop, with their sequence numbers
+   */
+  void StartLocalRepair (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable);
+  /**
+   * Switch the broken route to one-hop route if the destination is a neighbor, known
+   * from HELLO messages or with finite link ETX
+   * \param toDst - routing table entry of the broken route
+   * \return true if the route is switched
+   */
+  bool FindOneHopDetour (RoutingTableEntry & toDst);
+  /**
+   * Local repair has not found a route: drop buffered packets and send RERR to precursors
+   * \param dst - destination of the broken route
+   */
+  void LocalRepairFailed (Ipv4Address dst);
+  /**
+   * Multipath mode: keep the route of the entry, which is replaced by the route from RREP,
+   * and its backup routes as backup routes of the new route. Only routes with the same
+   * destination sequence number and interface are kept, and only if the hop count advertised
+   * by their next hop is below the advertised hop count of the new route (AOMDV rule).
+   * \param toDst - the entry in the routing table
+   * \param newEntry - the entry with the route from RREP
+   */
+  void InheritAlternateRoutes (RoutingTableEntry const & toDst, RoutingTableEntry & newEntry);
+  /**
+   * Multipath mode: keep the route from RREP as backup route if it has not replaced the
+   * route of the entry, and it has other next hop and the same destination sequence number.
+   * Hop count advertised by its next hop has to be below the advertised hop count of the entry
+   * (AOMDV rule), so that no two nodes keep backup routes through each other.
+   * \param newEntry - the entry with the route from RREP
+   */
+  void AddAlternateRoute (RoutingTableEntry const & newEntry);
+  /**
+   * Multipath mode: switch routes to backup routes, if the route through the next hop is broken.
+   * Switched destinations are removed from the unreachable list. Backup routes are dropped
+   * instead if the unreachable list (from RERR) has newer sequence number of the destination.
+   * \param nextHop - the next hop of the broken routes
+   * \param unreachable - destinations with the next hop, with their sequence numbers
+   */
+  void SwitchToAlternateRoutes (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable);
+  /**
+   * Multipath mode: switch the route to the best backup route which is not through the
+   * broken next hop. Expired backup routes and backup routes through next hops which are
+   * not heard any more are deleted.
+   * \param toDst - the entry in the routing table
+   * \param brokenNextHop - the next hop of the broken route
+   * \return true if the route is switched
+   */
+  bool SwitchToAlternateRoute (RoutingTableEntry & toDst, Ipv4Address brokenNextHop);
+  /**
+   * Check that the neighbor is still heard, with finite link ETX, or as HELLO neighbor
+   * for metrics without LPP. Without LPP and HELLO messages every neighbor is assumed heard.
+   * \param addr - the neighbor address
+   * \return true if the neighbor is heard
+   */
+  bool IsNeighborHeard (Ipv4Address addr);
+  /**
+   * Route cache: cache the route to the destination of RREP
+   * \param rrepHeader - RREP with hop count and ETX including the last link
+   * \param receiver - interface on which the RREP is received
+   * \param sender - the neighbor which has sent the RREP, the next hop of the route
+   */
+  void CacheRoute (RrepHeader const & rrepHeader, ReceiverInterface const & receiver, Ipv4Address sender);
+  /**
+   * Route cache: install the cached route to the destination of RREQ in the routing table,
+   * if there is no valid route in the table. Cached route is used only if its sequence number
+   * is not older than the one in RREQ and in the table, it is not through the RREQ sender,
+   * and its next hop is still heard. Lookup is traced as hit or miss.
+   * \param rreqHeader - the RREQ
+   * \param src - the neighbor which has sent the RREQ
+   * \return true if the cached route is installed
+   */
+  bool InstallCachedRoute (RreqHeader const & rreqHeader, Ipv4Address src);
+  /**
+   * Route history: remember hop count and ETX of the route discovered by this node
+   * \param toDst - the discovered route in the routing table
+   */
+  void RememberRoute (RoutingTableEntry const & toDst);
+  /**
+   * Route history: TTL of the first RREQ ring to the destination without routing table entry.
+   * It is the last discovered hop count + TtlIncrement, scaled towards TtlStart by confidence,
+   * which decays linearly with the age of the route in RouteHistoryTimeout and is lowered
+   * by mean link quality loss of the route.
+   * \param dst - the destination
+   * \return TTL of the first RREQ, TtlStart if there is no history
+   */
+  uint16_t GetHistoryTtl (Ipv4Address dst);
+  /// @}
+
+  /**
+   * Send packet to destination scoket
+   * \param socket - destination node socket
+   * \param packet - packet to send
+   * \param destination - destination node IP address
+   */
+  void SendTo (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination);
+  /**
+   * Send control packet after jitter. With control packet scheduler the packet waits in the
+   * priority queue, which is drained by one timer: packets due at the same time are sent in
+   * priority order. When the queue is full the packet last in order is dropped.
+   * \param socket - socket to send the packet from
+   * \param packet - packet to send
+   * \param destination - destination IP address
+   * \param jitter - delay of the send
+   * \param priority - priority of the packet
+   */
+  void ScheduleControlPacket (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination,
+                              Time jitter, ControlPriority priority);
+  /// Schedule the control packet scheduler timer to the earliest send time in the queue
+  void ScheduleControlTimer ();
+  /**
+   * Send jittered control packet when its send time has come, LPP is traced here
+   * \param socket - socket to send the packet from
+   * \param packet - packet to send
+   * \param destination - destination IP address
+   * \param priority - priority of the packet
+   */
+  void SendControlPacket (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination,
+                          ControlPriority priority);
+
+  /// Schedule next send of link probe packet
+  void LppTimerExpire (); /*etx*/
+  /**
+   * Adapt LPP interval to changes in the neighborhood since the last LPP: shorten it
+   * (halve) if some neighbor appeared or disappeared or ETX of more than half of the
+   * neighbors changed, prolong it (by MinLppInterval) if nothing has changed.
+   */
+  void AdaptLppInterval (); /*etx*/
+  /// Schedule next send of hello message
+  void HelloTimerExpire ();
+  /// Reset RREQ count and schedule RREQ rate limit timer with delay 1 sec.
+  void RreqRateLimitTimerExpire ();
+  /// Reset RERR count and schedule RERR rate limit timer with delay 1 sec.
+  void RerrRateLimitTimerExpire ();
+  /// Send RERRs with all destinations aggregated in the window, at most RERR_MAX_DESTINATIONS per RERR
+  void RerrAggregationTimerExpire ();
+  /// Send control packets whose send time has come, in priority order
+  void ControlTxTimerExpire ();
+  /**
+   * Handle route discovery process
+   * \param dst the destination IP address
+   */
+  void RouteRequestTimerExpire (Ipv4Address dst);
+  /**
+   * Trace failed route discovery for all originator addresses of this node
+   * \param dst the destination IP address
+   */
+  void TraceRouteDiscoveryFailed (Ipv4Address dst); // trace
+  /**
+   * Forward held RREQ
+   * \param origin the RREQ originator
+   * \param id the RREQ ID
+   */
+  void RequestHoldDownExpire (Ipv4Address origin, uint32_t id);
+  /**
+   * Mark link to neighbor node as unidirectional for blacklistTimeout
+   *
+   * \param neighbor the IP address of the neightbor node
+   * \param blacklistTimeout the black list timeout time
+   */
+  void AckTimerExpire (Ipv4Address neighbor, Time blacklistTimeout);
+};
+
+/// Original AODV, hop count metric
+typedef MetricRoutingProtocol<HopCountMetric> HopCountRoutingProtocol;
+/// AODV with ETX metric
+typedef MetricRoutingProtocol<EtxMetric> EtxRoutingProtocol;
+/// AODV with L-ETX metric
+typedef MetricRoutingProtocol<LightEtxMetric> LightEtxRoutingProtocol;
+/// AODV with LR-ETX metric
+typedef MetricRoutingProtocol<LightReverseEtxMetric> LightReverseEtxRoutingProtocol;
+/// AODV with PLR-ETX metric
+typedef MetricRoutingProtocol<PowerLightReverseEtxMetric> PowerLightReverseEtxRoutingProtocol;
+
+extern template class MetricRoutingProtocol<HopCountMetric>;
+extern template class MetricRoutingProtocol<EtxMetric>;
+extern template class MetricRoutingProtocol<LightEtxMetric>;
+extern template class MetricRoutingProtocol<LightReverseEtxMetric>;
+extern template class MetricRoutingProtocol<PowerLightReverseEtxMetric>;
+
+} //namespace aodv
+} //namespace ns3
+
+#endif /* AODVROUTINGPROTOCOL_H */
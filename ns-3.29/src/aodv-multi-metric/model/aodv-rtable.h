@@ -0,0 +1,675 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 IITP RAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Based on
+ *      NS-2 AODV model developed by the CMU/MONARCH group and optimized and
+ *      tuned by Samir Das and Mahesh Marina, University of Cincinnati;
+ *
+ *      AODV-UU implementation by Erik Nordström of Uppsala University
+ *      http://core.it.uu.se/core/index.php/AODV-UU
+ *
+ * Authors: Elena Buchatskaia <borovkovaes@iitp.ru>
+ *          Pavel Boyko <boyko@iitp.ru>
+ *
+ * Modified by: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>, <nen.jevtic@gmail.com>
+ *              Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+#ifndef AODV_RTABLE_H
+#define AODV_RTABLE_H
+
+#include <stdint.h>
+#include <cassert>
+#include <map>
+#include <vector>
+#include <sys/types.h>
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/timer.h"
+#include "ns3/net-device.h"
+#include "ns3/output-stream-wrapper.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv
+ * \brief Route record states
+ */
+enum RouteFlags
+{
+  VALID = 0,          //!< VALID
+  INVALID = 1,        //!< INVALID
+  IN_SEARCH = 2,      //!< IN_SEARCH
+};
+
+/**
+ * \ingroup aodv
+ * \brief List of precursors of a routing table entry
+ *
+ * Most routes have a few precursors, so the first PrecursorList::INLINE_SIZE of them
+ * are kept inside the list and only the others are kept in a vector. Routing table
+ * entries are copied out of and back into the table on every update, and copying a
+ * list without spilled precursors needs no allocation.
+ */
+class PrecursorList
+{
+public:
+  /// Number of precursors kept inside the list
+  static const uint32_t INLINE_SIZE = 4;
+
+  PrecursorList ();
+  /**
+   * Insert precursor if it is not yet in the list
+   * \param id precursor address
+   * \return true if precursor is inserted
+   */
+  bool Insert (Ipv4Address id);
+  /**
+   * Lookup precursor
+   * \param id precursor address
+   * \return true if precursor is in the list
+   */
+  bool Lookup (Ipv4Address id) const;
+  /**
+   * Delete precursor, order of other precursors is kept
+   * \param id precursor address
+   * \return true if precursor is deleted
+   */
+  bool Delete (Ipv4Address id);
+  /// Delete all precursors
+  void Clear ();
+  /**
+   * \return number of precursors
+   */
+  uint32_t GetSize () const
+  {
+    return m_size;
+  }
+  /**
+   * \param i index of precursor, less than GetSize ()
+   * \return precursor address
+   */
+  Ipv4Address Get (uint32_t i) const
+  {
+    return i < INLINE_SIZE ? m_inline[i] : m_spill[i - INLINE_SIZE];
+  }
+
+private:
+  Ipv4Address m_inline[INLINE_SIZE]; ///< the first INLINE_SIZE precursors
+  std::vector<Ipv4Address> m_spill;  ///< the other precursors
+  uint32_t m_size;                   ///< number of precursors
+};
+
+/**
+ * \ingroup aodv
+ * \brief Backup route of a routing table entry in multipath mode, through other
+ * next hop than the route of the entry
+ */
+struct AlternateRoute
+{
+  Ipv4Address nextHop; ///< next hop of the backup route
+  uint16_t hop;        ///< hop count of the backup route
+  uint32_t etx;        ///< ETX of the backup route
+  Time expireTime;     ///< expiration time of the backup route
+};
+
+/**
+ * \ingroup aodv
+ * \brief Routing table entry
+ */
+class RoutingTableEntry
+{
+public:
+  /**
+   * constructor
+   *
+   * \param dev the device
+   * \param dst the destination IP address
+   * \param vSeqNo verify sequence number flag
+   * \param seqNo the sequence number
+   * \param iface the interface
+   * \param hops the number of hops
+   * \param nextHop the IP address of the next hop
+   * \param lifetime the lifetime of the entry
+   * \param etx metric
+   */
+  RoutingTableEntry (Ptr<NetDevice> dev = 0,Ipv4Address dst = Ipv4Address (), bool vSeqNo = false, uint32_t seqNo = 0,
+                     Ipv4InterfaceAddress iface = Ipv4InterfaceAddress (), uint16_t  hops = 0,
+                     Ipv4Address nextHop = Ipv4Address (), Time lifetime = Simulator::Now (), uint32_t etx = 10000); /* etx */
+
+  ~RoutingTableEntry ();
+
+  ///\name Precursors management
+  //\{
+  /**
+   * Insert precursor in precursor list if it doesn't yet exist in the list
+   * \param id precursor address
+   * \return true on success
+   */
+  bool InsertPrecursor (Ipv4Address id);
+  /**
+   * Lookup precursor by address
+   * \param id precursor address
+   * \return true on success
+   */
+  bool LookupPrecursor (Ipv4Address id);
+  /**
+   * \brief Delete precursor
+   * \param id precursor address
+   * \return true on success
+   */
+  bool DeletePrecursor (Ipv4Address id);
+  /// Delete all precursors
+  void DeleteAllPrecursors ();
+  /**
+   * Check that precursor list is empty
+   * \return true if precursor list is empty
+   */
+  bool IsPrecursorListEmpty () const;
+  /**
+   * Inserts precursors in output parameter prec if they do not yet exist in vector
+   * \param prec vector of precursor addresses
+   */
+  void GetPrecursors (std::vector<Ipv4Address> & prec) const;
+  //\}
+
+  ///\name Backup routes of multipath mode, ranked by ETX and then by hop count
+  //\{
+  /**
+   * Insert backup route, or replace backup route through the same next hop.
+   * Expired backup routes are deleted, and the worst ones if there are more than maxAlternates.
+   * \param alternate backup route
+   * \param maxAlternates maximal number of backup routes
+   */
+  void InsertAlternate (AlternateRoute const & alternate, uint32_t maxAlternates);
+  /**
+   * Delete backup route
+   * \param nextHop next hop of backup route
+   * \return true on success
+   */
+  bool DeleteAlternate (Ipv4Address nextHop);
+  /// Delete all backup routes
+  void DeleteAllAlternates ()
+  {
+    m_alternates.clear ();
+  }
+  /**
+   * \return number of backup routes
+   */
+  uint32_t GetAlternateCount () const
+  {
+    return m_alternates.size ();
+  }
+  /**
+   * \param i index of backup route, less than GetAlternateCount (), the best one is 0
+   * \return backup route
+   */
+  AlternateRoute const & GetAlternate (uint32_t i) const
+  {
+    return m_alternates[i];
+  }
+  //\}
+
+  /**
+   * Mark entry as "down" (i.e. disable it)
+   * \param badLinkLifetime duration to keep entry marked as invalid
+   */
+  void Invalidate (Time badLinkLifetime);
+
+  // Fields
+  /**
+   * Get destination address function
+   * \returns the IPv4 destination address
+   */
+  Ipv4Address GetDestination () const
+  {
+    return m_ipv4Route->GetDestination ();
+  }
+  /**
+   * Get route function
+   * \returns The IPv4 route
+   */
+  Ptr<Ipv4Route> GetRoute () const
+  {
+    return m_ipv4Route;
+  }
+  /**
+   * Set route function
+   * \param r the IPv4 route
+   */
+  void SetRoute (Ptr<Ipv4Route> r)
+  {
+    m_ipv4Route = r;
+  }
+  /**
+   * Set next hop address
+   * \param nextHop the next hop IPv4 address
+   */
+  void SetNextHop (Ipv4Address nextHop)
+  {
+    m_ipv4Route->SetGateway (nextHop);
+  }
+  /**
+   * Get next hop address
+   * \returns the next hop address
+   */
+  Ipv4Address GetNextHop () const
+  {
+    return m_ipv4Route->GetGateway ();
+  }
+  /**
+   * Set output device
+   * \param dev The output device
+   */
+  void SetOutputDevice (Ptr<NetDevice> dev)
+  {
+    m_ipv4Route->SetOutputDevice (dev);
+  }
+  /**
+   * Get output device
+   * \returns the output device
+   */
+  Ptr<NetDevice> GetOutputDevice () const
+  {
+    return m_ipv4Route->GetOutputDevice ();
+  }
+  /**
+   * Get the Ipv4InterfaceAddress
+   * \returns the Ipv4InterfaceAddress
+   */
+  Ipv4InterfaceAddress GetInterface () const
+  {
+    return m_iface;
+  }
+  /**
+   * Set the Ipv4InterfaceAddress
+   * \param iface The Ipv4InterfaceAddress
+   */
+  void SetInterface (Ipv4InterfaceAddress iface)
+  {
+    m_iface = iface;
+  }
+  /**
+   * Set the valid sequence number
+   * \param s the sequence number
+   */
+  void SetValidSeqNo (bool s)
+  {
+    m_validSeqNo = s;
+  }
+  /**
+   * Get the valid sequence number
+   * \returns the valid sequence number
+   */
+  bool GetValidSeqNo () const
+  {
+    return m_validSeqNo;
+  }
+  /**
+   * Set the sequence number
+   * \param sn the sequence number
+   */
+  void SetSeqNo (uint32_t sn)
+  {
+    m_seqNo = sn;
+  }
+  /**
+   * Get the sequence number
+   * \returns the sequence number
+   */
+  uint32_t GetSeqNo () const
+  {
+    return m_seqNo;
+  }
+  /**
+   * Set the number of hops
+   * \param hop the number of hops
+   */
+  void SetHop (uint16_t hop)
+  {
+    if (m_advertisedSeqNo != m_seqNo)
+      {
+        m_advertisedSeqNo = m_seqNo;
+        m_advertisedHop = hop;
+      }
+    else if (hop > m_advertisedHop)
+      {
+        m_advertisedHop = hop;
+      }
+    m_hops = hop;
+  }
+  /**
+   * Get the number of hops
+   * \returns the number of hops
+   */
+  uint16_t GetHop () const
+  {
+    return m_hops;
+  }
+  /**
+   * Set the advertised hop count for the current sequence number
+   * \param hop the advertised hop count
+   */
+  void SetAdvertisedHop (uint16_t hop)
+  {
+    m_advertisedSeqNo = m_seqNo;
+    m_advertisedHop = hop;
+  }
+  /**
+   * Get the advertised hop count, the largest hop count of the route with the current
+   * sequence number, which this node may have advertised in RREPs
+   * \returns the advertised hop count
+   */
+  uint16_t GetAdvertisedHop () const
+  {
+    return m_advertisedSeqNo == m_seqNo ? m_advertisedHop : m_hops;
+  }
+  /**
+   * Set the lifetime
+   * \param lt The lifetime
+   */
+  void SetLifeTime (Time lt)
+  {
+    m_lifeTime = lt + Simulator::Now ();
+  }
+  /**
+   * Get the lifetime
+   * \returns the lifetime
+   */
+  Time GetLifeTime () const
+  {
+    return m_lifeTime - Simulator::Now ();
+  }
+  /**
+   * Set the route flags
+   * \param flag the route flags
+   */
+  void SetFlag (RouteFlags flag)
+  {
+    m_flag = flag;
+  }
+  /**
+   * Get the route flags
+   * \returns the route flags
+   */
+  RouteFlags GetFlag () const
+  {
+    return m_flag;
+  }
+  /**
+   * Set the RREQ count
+   * \param n the RREQ count
+   */
+  void SetRreqCnt (uint8_t n)
+  {
+    m_reqCount = n;
+  }
+  /**
+   * Get the RREQ count
+   * \returns the RREQ count
+   */
+  uint8_t GetRreqCnt () const
+  {
+    return m_reqCount;
+  }
+  /**
+   * Increment the RREQ count
+   */
+  void IncrementRreqCnt ()
+  {
+    m_reqCount++;
+  }
+  /**
+   * Set the unidirectional flag
+   * \param u the uni directional flag
+   */
+  void SetUnidirectional (bool u)
+  {
+    m_blackListState = u;
+  }
+  /**
+   * Get the unidirectional flag
+   * \returns the unidirectional flag
+   */
+  bool IsUnidirectional () const
+  {
+    return m_blackListState;
+  }
+  /**
+   * Set the blacklist timeout
+   * \param t the blacklist timeout value
+   */
+  void SetBlacklistTimeout (Time t)
+  {
+    m_blackListTimeout = t;
+  }
+  /**
+   * Get the blacklist timeout value
+   * \returns the blacklist timeout value
+   */
+  Time GetBlacklistTimeout () const
+  {
+    return m_blackListTimeout;
+  }
+
+  /**
+  * Get ETX 
+  */
+  uint32_t GetEtx () const 
+  { 
+    return m_etx; /* etx */
+  }
+
+  /**
+  * Set ETX 
+  */
+  void SetEtx (uint32_t etx)
+  { 
+    m_etx = etx; /* etx */
+  }
+  
+  /// RREP_ACK timer
+  Timer m_ackTimer;
+
+  /**
+   * \brief Compare destination address
+   * \param dst IP address to compare
+   * \return true if equal
+   */
+  bool operator== (Ipv4Address const  dst) const
+  {
+    return (m_ipv4Route->GetDestination () == dst);
+  }
+  /**
+   * Print packet to trace file
+   * \param stream The output stream
+   */
+  void Print (Ptr<OutputStreamWrapper> stream) const;
+
+private:
+  /// Valid Destination Sequence Number flag
+  bool m_validSeqNo;
+  /// Destination Sequence Number, if m_validSeqNo = true
+  uint32_t m_seqNo;
+  /// Hop Count (number of hops needed to reach destination)
+  uint16_t m_hops;
+  /// Advertised hop count of multipath mode, the largest hop count with m_advertisedSeqNo
+  uint16_t m_advertisedHop;
+  /// Sequence number of the advertised hop count
+  uint32_t m_advertisedSeqNo;
+  /**
+  * \brief Expiration or deletion time of the route
+  *	Lifetime field in the routing table plays dual role:
+  *	for an active route it is the expiration time, and for an invalid route
+  *	it is the deletion time.
+  */
+  Time m_lifeTime;
+  /** Ip route, include
+   *   - destination address
+   *   - source address
+   *   - next hop address (gateway)
+   *   - output device
+   */
+  Ptr<Ipv4Route> m_ipv4Route;
+  /// Output interface address
+  Ipv4InterfaceAddress m_iface;
+  /// Routing flags: valid, invalid or in search
+  RouteFlags m_flag;
+
+  /// List of precursors
+  PrecursorList m_precursorList;
+  /// Backup routes of multipath mode, the best first
+  std::vector<AlternateRoute> m_alternates;
+  /// When I can send another request
+  Time m_routeRequestTimout;
+  /// Number of route requests
+  uint8_t m_reqCount;
+  /// Indicate if this entry is in "blacklist"
+  bool m_blackListState;
+  /// Time for which the node is put into the blacklist
+  Time m_blackListTimeout;
+  
+  /// ETX metric field, its scale depends on the metric of the routing protocol
+  /// (see aodv-metric.h): ETX is multiplied by 10000 and rounded to obtain
+  /// resolution of 4 decimal places, light metrics use 8b logarithmic scale
+  /// and hop count metric is the number of hops
+  uint32_t m_etx; /*etx*/
+};
+
+/**
+ * \ingroup aodv
+ * \brief The Routing table used by AODV protocol
+ */
+class RoutingTable
+{
+public:
+  /**
+   * constructor
+   * \param t the routing table entry lifetime
+   */
+  RoutingTable (Time t);
+  ///\name Handle lifetime of invalid route
+  //\{
+  Time GetBadLinkLifetime () const
+  {
+    return m_badLinkLifetime;
+  }
+  void SetBadLinkLifetime (Time t)
+  {
+    m_badLinkLifetime = t;
+  }
+  //\}
+  /**
+   * Add routing table entry if it doesn't yet exist in routing table
+   * \param r routing table entry
+   * \return true in success
+   */
+  bool AddRoute (RoutingTableEntry & r);
+  /**
+   * Delete routing table entry with destination address dst, if it exists.
+   * \param dst destination address
+   * \return true on success
+   */
+  bool DeleteRoute (Ipv4Address dst);
+  /**
+   * Lookup routing table entry with destination address dst
+   * \param dst destination address
+   * \param rt entry with destination address dst, if exists
+   * \return true on success
+   */
+  bool LookupRoute (Ipv4Address dst, RoutingTableEntry & rt);
+  /**
+   * Lookup route in VALID state
+   * \param dst destination address
+   * \param rt entry with destination address dst, if exists
+   * \return true on success
+   */
+  bool LookupValidRoute (Ipv4Address dst, RoutingTableEntry & rt);
+  /**
+   * Update routing table
+   * \param rt entry with destination address dst, if exists
+   * \return true on success
+   */
+  bool Update (RoutingTableEntry & rt);
+  /**
+   * Set routing table entry flags
+   * \param dst destination address
+   * \param state the routing flags
+   * \return true on success
+   */
+  bool SetEntryState (Ipv4Address dst, RouteFlags state);
+  /**
+   * Lookup routing entries with next hop Address dst and not empty list of precursors.
+   *
+   * \param nextHop the next hop IP address
+   * \param unreachable
+   */
+  void GetListOfDestinationWithNextHop (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable);
+  /**
+   * Delete backup routes through the next hop from all entries
+   * \param nextHop the next hop IP address
+   */
+  void DeleteAlternatesWithNextHop (Ipv4Address nextHop);
+  /**
+   *   Update routing entries with this destination as follows:
+   *  1. The destination sequence number of this routing entry, if it
+   *     exists and is valid, is incremented.
+   *  2. The entry is invalidated by marking the route entry as invalid
+   *  3. The Lifetime field is updated to current time plus DELETE_PERIOD.
+   *  \param unreachable routes to invalidate
+   */
+  void InvalidateRoutesWithDst (std::map<Ipv4Address, uint32_t> const & unreachable);
+  /**
+   * Delete all route from interface with address iface
+   * \param iface the interface IP address
+   */
+  void DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface);
+  /// Delete all entries from routing table
+  void Clear ()
+  {
+    m_ipv4AddressEntry.clear ();
+  }
+  /// Delete all outdated entries and invalidate valid entry if Lifetime is expired
+  void Purge ();
+  /** Mark entry as unidirectional (e.g. add this neighbor to "blacklist" for blacklistTimeout period)
+   * \param neighbor - neighbor address link to which assumed to be unidirectional
+   * \param blacklistTimeout - time for which the neighboring node is put into the blacklist
+   * \return true on success
+   */
+  bool MarkLinkAsUnidirectional (Ipv4Address neighbor, Time blacklistTimeout);
+  /**
+   * Print routing table
+   * \param stream the output stream
+   */
+  void Print (Ptr<OutputStreamWrapper> stream) const;
+
+private:
+  /// The routing table
+  std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
+  /// Deletion time for invalid routes
+  Time m_badLinkLifetime;
+  /**
+   * const version of Purge, for use by Print() method
+   * \param table the routing table entry to purge
+   */
+  void Purge (std::map<Ipv4Address, RoutingTableEntry> &table) const;
+};
+
+}  // namespace aodv
+}  // namespace ns3
+
+#endif /* AODV_RTABLE_H */
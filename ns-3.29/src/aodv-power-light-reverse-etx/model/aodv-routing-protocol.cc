@@ -1235,6 +1235,7 @@ void
 RoutingProtocol::UpdateRouteToNeighbor (Ipv4Address sender, Ipv4Address receiver)
 {
   NS_LOG_FUNCTION (this << "sender " << sender << " receiver " << receiver);
+  uint8_t etx = m_nbEtx.GetEtxForNeighbor (sender); // cached link ETX, looked up once
   RoutingTableEntry toNeighbor;
   if (!m_routingTable.LookupRoute (sender, toNeighbor))
     {
@@ -1242,7 +1243,7 @@ RoutingProtocol::UpdateRouteToNeighbor (Ipv4Address sender, Ipv4Address receiver
       RoutingTableEntry newEntry (/*device=*/ dev, /*dst=*/ sender, /*know seqno=*/ false, /*seqno=*/ 0,
                                   /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),
                                   /*hops=*/ 1, /*next hop=*/ sender, /*lifetime=*/ m_activeRouteTimeout,
-                                  /*etx=*/ m_nbEtx.GetEtxForNeighbor (sender));
+                                  /*etx=*/ etx);
       m_routingTable.AddRoute (newEntry);
     }
   else
@@ -1251,7 +1252,7 @@ RoutingProtocol::UpdateRouteToNeighbor (Ipv4Address sender, Ipv4Address receiver
       if (toNeighbor.GetValidSeqNo () && (toNeighbor.GetHop () == 1) && (toNeighbor.GetOutputDevice () == dev))
         {
           toNeighbor.SetLifeTime (std::max (m_activeRouteTimeout, toNeighbor.GetLifeTime ()));
-          toNeighbor.SetEtx (m_nbEtx.GetEtxForNeighbor (sender));
+          toNeighbor.SetEtx (etx);
           m_routingTable.Update (toNeighbor); // this was missing in original AODV implementation
         }
       else
@@ -1260,7 +1261,7 @@ RoutingProtocol::UpdateRouteToNeighbor (Ipv4Address sender, Ipv4Address receiver
                                       /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),
                                       /*hops=*/ 1, /*next hop=*/ sender,
                                       /*lifetime=*/ std::max (m_activeRouteTimeout, toNeighbor.GetLifeTime ()),
-                                      /*etx=*/ m_nbEtx.GetEtxForNeighbor (sender));
+                                      /*etx=*/ etx);
           m_routingTable.Update (newEntry);
         }
     }
@@ -1289,6 +1290,7 @@ RoutingProtocol::RecvLpp (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
   // Add new or update existing etx entry for neighbor with IP address "src".
   // LPP count is updated based on lppTime stamp received in packet header.
   m_nbEtx.UpdateNeighborEtx (src, lppTimeStamp, power); /*etx*/
+  uint8_t etx = m_nbEtx.GetEtxForNeighbor (src); /*etx*/
   // Since ETX is changed we should update route entry for neighbor
   // LPP is used as HELLO so it should be updated as if HELLO message is received
   // We use LPP as HELLO message, so we do the same as in ProcessHello (), but with ETX metric
@@ -1301,7 +1303,7 @@ RoutingProtocol::RecvLpp (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
                                   /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),
                                   /*hop=*/ 1, /*nextHop=*/ src,
                                   /*lifeTime=*/ Time (m_allowedHelloLoss * m_helloInterval),
-                                  /*etx*/ m_nbEtx.GetEtxForNeighbor (src));
+                                  /*etx*/ etx);
       m_routingTable.AddRoute (newEntry);
     }
   else
@@ -1314,7 +1316,7 @@ RoutingProtocol::RecvLpp (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
       toNeighbor.SetInterface (m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0));
       toNeighbor.SetHop (1);
       toNeighbor.SetNextHop (src);
-      toNeighbor.SetEtx (m_nbEtx.GetEtxForNeighbor (src)); /*etx*/
+      toNeighbor.SetEtx (etx); /*etx*/
       m_routingTable.Update (toNeighbor);
     }
 
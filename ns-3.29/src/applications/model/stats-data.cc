@@ -23,6 +23,7 @@
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cstdlib>
 
 #include "ns3/simulator.h"
 #include "ns3/address-utils.h"
@@ -316,6 +317,7 @@ FlowData::Finalize ()
 StatsFlows::StatsFlows (uint64_t rngRun, std::string fn, bool scalarFileWriteEnable, bool vectorFileWriteEnable) :
     m_rngRun (rngRun),
     m_fileName (fn + "-Run_" + std::to_string (rngRun)),
+    m_lppPhyTxPending (false),
     m_scalarFileWriteEnable (scalarFileWriteEnable),
     m_vectorFileWriteEnable (vectorFileWriteEnable),
     m_histogramResolution (0.0001) // 0.1 ms
@@ -327,6 +329,21 @@ StatsFlows::StatsFlows (uint64_t rngRun, std::string fn, bool scalarFileWriteEna
   // data transmitted, and then used to calculate
   // the MAC/PHY overhead beyond the app-data
   Config::Connect ("/NodeList/*/DeviceList/*/Phy/State/Tx", MakeCallback (&StatsFlows::PhyPacketSent, this));
+  // duration of transmissions, to determine airtime used by the nodes
+  Config::Connect ("/NodeList/*/DeviceList/*/Phy/State/State", MakeCallback (&StatsFlows::PhyStateChanged, this));
+  // link probe packets of AODV with ETX metric, nothing is connected if AODV is not used
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/LppTx", MakeCallback (&StatsFlows::LppPacketSent, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/LppPiggyback", MakeCallback (&StatsFlows::LppPacketPiggybacked, this));
+  Config::Connect ("/NodeList/*/$ns3::aodv::RoutingProtocol/RreqForward", MakeCallback (&StatsFlows::RreqForwarded, this));
+  // cost of AODV route discoveries
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/RreqTx", MakeCallback (&StatsFlows::RreqSent, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/RrepTx", MakeCallback (&StatsFlows::RrepSent, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/RouteDiscovered", MakeCallback (&StatsFlows::RouteDiscovered, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/RouteDiscoveryFailed", MakeCallback (&StatsFlows::RouteDiscoveryFailed, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/LocalRepair", MakeCallback (&StatsFlows::LocalRepairFinished, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/RouteSwitch", MakeCallback (&StatsFlows::RouteSwitched, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/RouteCache", MakeCallback (&StatsFlows::RouteCacheLookup, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/ControlDrop", MakeCallback (&StatsFlows::ControlPacketDropped, this));
   //NodeList/[i]/DeviceList/[i]/$ns3::WifiNetDevice/Phy/$ns3::YansWifiPhy/State
 }
  
@@ -340,6 +357,171 @@ StatsFlows::PhyPacketSent (std::string context, Ptr<const Packet> packet, WifiMo
   uint32_t pktSize = packet->GetSize ();
   m_allPacketsStats.phyTxBytes += pktSize;
   //NS_LOG_UNCOND ("Received PHY size=" << pktSize);
+  // Packet keeps its uid down to phy. Duration of transmission is traced by phy
+  // state helper just after this callback.
+  if (!m_lppUids.empty () && m_lppUids.erase (packet->GetUid ()) > 0)
+    {
+      m_allPacketsStats.lppPhyTxPkts++;
+      m_lppPhyTxPending = true;
+    }
+}
+
+void
+StatsFlows::PhyStateChanged (std::string context, Time start, Time duration, WifiPhyState state)
+{
+  if (state != WifiPhyState::TX)
+    {
+      return;
+    }
+  m_allPacketsStats.phyTxAirtime += duration;
+  if (m_lppPhyTxPending)
+    {
+      m_allPacketsStats.lppPhyTxAirtime += duration;
+      m_lppPhyTxPending = false;
+    }
+}
+
+void
+StatsFlows::LppPacketSent (Ptr<const Packet> packet, Time interval, Time baseInterval)
+{
+  NS_LOG_FUNCTION (this << packet << interval << baseInterval);
+  m_allPacketsStats.lppTxPkts++;
+  // One LPP replaces interval / base interval LPPs which would be sent without adaptation
+  m_allPacketsStats.lppSavedPkts += interval.GetSeconds () / baseInterval.GetSeconds () - 1.0;
+  m_lppUids.insert (packet->GetUid ());
+}
+
+void
+StatsFlows::LppPacketPiggybacked (Ptr<const Packet> packet, Time interval, Time baseInterval)
+{
+  NS_LOG_FUNCTION (this << packet << interval << baseInterval);
+  m_allPacketsStats.lppPiggybackPkts++;
+  // Standalone LPP of the whole interval is not sent
+  m_allPacketsStats.lppSavedPkts += interval.GetSeconds () / baseInterval.GetSeconds ();
+}
+
+/**
+ * Get node ID from trace context
+ * \param context trace context "/NodeList/<node ID>/..."
+ * \return node ID
+ */
+static uint32_t
+GetNodeIdFromContext (std::string context)
+{
+  std::string::size_type start = context.find ("/NodeList/") + 10;
+  std::string::size_type end = context.find ('/', start);
+  return (uint32_t) std::atoi (context.substr (start, end - start).c_str ());
+}
+
+void
+StatsFlows::RreqForwarded (std::string context, Ipv4Address origin, uint32_t id, uint32_t absorbed)
+{
+  NS_LOG_FUNCTION (this << context << origin << id << absorbed);
+  m_allPacketsStats.rreqFwdPkts++;
+  m_allPacketsStats.rreqSuppressedPkts += absorbed;
+  std::map<std::pair<Ipv4Address, uint32_t>, uint32_t>::const_iterator i = m_rreqDiscovery.find (std::make_pair (origin, id));
+  if (i != m_rreqDiscovery.end ())
+    {
+      RouteDiscoveryData &d = m_routeDiscoveries[i->second];
+      d.rreqFwdPkts++;
+      d.rreqFwdPerNode[GetNodeIdFromContext (context)]++;
+    }
+}
+
+void
+StatsFlows::RreqSent (Ipv4Address origin, uint32_t id, Ipv4Address dst, bool retry)
+{
+  NS_LOG_FUNCTION (this << origin << id << dst << retry);
+  std::pair<Ipv4Address, Ipv4Address> key (origin, dst);
+  std::map<std::pair<Ipv4Address, Ipv4Address>, uint32_t>::iterator i = m_lastRouteDiscovery.find (key);
+  if (!retry || i == m_lastRouteDiscovery.end ())
+    {
+      RouteDiscoveryData d;
+      d.firstRreq = Simulator::Now ();
+      m_routeDiscoveries.push_back (d);
+      i = m_lastRouteDiscovery.insert (std::make_pair (key, 0)).first;
+      i->second = m_routeDiscoveries.size () - 1;
+    }
+  m_routeDiscoveries[i->second].rreqTxPkts++;
+  m_rreqDiscovery[std::make_pair (origin, id)] = i->second;
+}
+
+void
+StatsFlows::RrepSent (Ipv4Address origin, Ipv4Address dst)
+{
+  NS_LOG_FUNCTION (this << origin << dst);
+  std::map<std::pair<Ipv4Address, Ipv4Address>, uint32_t>::const_iterator i = m_lastRouteDiscovery.find (std::make_pair (origin, dst));
+  if (i != m_lastRouteDiscovery.end ())
+    {
+      m_routeDiscoveries[i->second].rrepTxPkts++;
+    }
+}
+
+void
+StatsFlows::RouteDiscovered (Ipv4Address origin, Ipv4Address dst, uint8_t hopCount, uint32_t etx)
+{
+  NS_LOG_FUNCTION (this << origin << dst << (uint32_t)hopCount << etx);
+  std::map<std::pair<Ipv4Address, Ipv4Address>, uint32_t>::const_iterator i = m_lastRouteDiscovery.find (std::make_pair (origin, dst));
+  if (i == m_lastRouteDiscovery.end ())
+    {
+      return;
+    }
+  RouteDiscoveryData &d = m_routeDiscoveries[i->second];
+  if (!d.found)
+    {
+      d.found = true;
+      d.firstRrep = Simulator::Now ();
+    }
+  // later RREPs may bring better route
+  d.hopCount = hopCount;
+  d.etx = etx;
+}
+
+void
+StatsFlows::RouteDiscoveryFailed (Ipv4Address origin, Ipv4Address dst)
+{
+  NS_LOG_FUNCTION (this << origin << dst);
+  std::map<std::pair<Ipv4Address, Ipv4Address>, uint32_t>::const_iterator i = m_lastRouteDiscovery.find (std::make_pair (origin, dst));
+  if (i != m_lastRouteDiscovery.end ())
+    {
+      m_routeDiscoveries[i->second].failed = true;
+    }
+}
+
+void
+StatsFlows::LocalRepairFinished (Ipv4Address dst, bool repaired)
+{
+  NS_LOG_FUNCTION (this << dst << repaired);
+  m_allPacketsStats.localRepairs++;
+  if (repaired)
+    {
+      m_allPacketsStats.localRepairSuccess++;
+    }
+}
+
+void
+StatsFlows::RouteSwitched (Ipv4Address dst, Ipv4Address nextHop)
+{
+  NS_LOG_FUNCTION (this << dst << nextHop);
+  m_allPacketsStats.routeSwitches++;
+}
+
+void
+StatsFlows::RouteCacheLookup (Ipv4Address dst, bool hit)
+{
+  NS_LOG_FUNCTION (this << dst << hit);
+  m_allPacketsStats.routeCacheLookups++;
+  if (hit)
+    {
+      m_allPacketsStats.routeCacheHits++;
+    }
+}
+
+void
+StatsFlows::ControlPacketDropped (Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  m_allPacketsStats.controlDrops++;
 }
 
  
@@ -473,6 +655,73 @@ StatsFlows::Finalize ()
   srs.aap.lostRatio = 100.0* (double)srs.aap.lostPackets / (double)srs.aap.txPackets;
   srs.aap.phyTxPkts = m_allPacketsStats.phyTxPkts;
   srs.aap.usefullNetTraffic = (double)m_allPacketsStats.totalTxBytes / (double)m_allPacketsStats.phyTxBytes * 100.0;
+  srs.aap.phyTxAirtime = m_allPacketsStats.phyTxAirtime.GetSeconds ();
+  srs.aap.lppTxPkts = m_allPacketsStats.lppTxPkts;
+  srs.aap.lppPiggybackPkts = m_allPacketsStats.lppPiggybackPkts;
+  srs.aap.lppSavedPkts = m_allPacketsStats.lppSavedPkts;
+  srs.aap.rreqFwdPkts = m_allPacketsStats.rreqFwdPkts;
+  srs.aap.rreqSuppressedPkts = m_allPacketsStats.rreqSuppressedPkts;
+  srs.aap.localRepairs = m_allPacketsStats.localRepairs;
+  srs.aap.routeSwitches = m_allPacketsStats.routeSwitches;
+  if (m_allPacketsStats.localRepairs > 0)
+    {
+      srs.aap.localRepairSuccess = 100.0 * m_allPacketsStats.localRepairSuccess / m_allPacketsStats.localRepairs;
+    }
+  srs.aap.routeCacheLookups = m_allPacketsStats.routeCacheLookups;
+  srs.aap.controlDrops = m_allPacketsStats.controlDrops;
+  if (m_allPacketsStats.routeCacheLookups > 0)
+    {
+      srs.aap.routeCacheHits = 100.0 * m_allPacketsStats.routeCacheHits / m_allPacketsStats.routeCacheLookups;
+    }
+  // Route discoveries
+  StatsHist latencyHist (0.001); // 1 ms
+  StatsHist txPktsHist (1.0, "packets");
+  double retries = 0, rreqFwdPkts = 0, rreqFwdNodes = 0, rrepTxPkts = 0, hopCount = 0, etx = 0, failures = 0;
+  for (std::vector<RouteDiscoveryData>::const_iterator d = m_routeDiscoveries.begin (); d != m_routeDiscoveries.end (); ++d)
+    {
+      retries += d->rreqTxPkts - 1;
+      rreqFwdPkts += d->rreqFwdPkts;
+      rreqFwdNodes += d->rreqFwdPerNode.size ();
+      rrepTxPkts += d->rrepTxPkts;
+      txPktsHist.AddValue (d->rreqTxPkts + d->rreqFwdPkts + d->rrepTxPkts);
+      if (d->failed)
+        {
+          failures++;
+        }
+      if (d->found)
+        {
+          latencyHist.AddValue ((d->firstRrep - d->firstRreq).GetSeconds ());
+          hopCount += d->hopCount;
+          etx += d->etx;
+        }
+    }
+  srs.aap.routeDiscoveries = m_routeDiscoveries.size ();
+  if (!m_routeDiscoveries.empty ())
+    {
+      srs.aap.routeDiscoverySuccess = 100.0 * latencyHist.GetCount () / m_routeDiscoveries.size ();
+      srs.aap.routeDiscoveryFailure = 100.0 * failures / m_routeDiscoveries.size ();
+      srs.aap.routeDiscoveryRetries = retries / m_routeDiscoveries.size ();
+      srs.aap.routeDiscoveryTxPkts = txPktsHist.GetMean ();
+      srs.aap.routeDiscoveryRreqFwdPkts = rreqFwdPkts / m_routeDiscoveries.size ();
+      srs.aap.routeDiscoveryRreqFwdNodes = rreqFwdNodes / m_routeDiscoveries.size ();
+      srs.aap.routeDiscoveryRrepTxPkts = rrepTxPkts / m_routeDiscoveries.size ();
+    }
+  if (rreqFwdNodes > 0)
+    {
+      srs.aap.routeDiscoveryRreqFwdPerNode = rreqFwdPkts / rreqFwdNodes;
+    }
+  if (latencyHist.GetCount () > 0)
+    {
+      srs.aap.routeDiscoveryLatencyAverage = latencyHist.GetMean ();
+      srs.aap.routeDiscoveryLatencyMedianEstimate = latencyHist.GetMedianEstimation ();
+      srs.aap.routeDiscoveryHopCount = hopCount / latencyHist.GetCount ();
+      srs.aap.routeDiscoveryEtx = etx / latencyHist.GetCount ();
+    }
+  if (m_allPacketsStats.lppPhyTxPkts > 0)
+    {
+      // saved LPPs are supposed to take the average airtime of sent LPPs
+      srs.aap.lppSavedAirtime = srs.aap.lppSavedPkts * m_allPacketsStats.lppPhyTxAirtime.GetSeconds () / m_allPacketsStats.lppPhyTxPkts;
+    }
   srs.aap.e2eDelayMin = m_allPacketsStats.delayHist.GetMin ();
   srs.aap.e2eDelayMax = m_allPacketsStats.delayHist.GetMax ();
   srs.aap.e2eDelayAverage = m_allPacketsStats.delayHist.GetMean ();
@@ -508,6 +757,32 @@ StatsFlows::Finalize ()
       out << "Lost packet ratio [%]:," << srs.aaf.lostRatio << "," << srs.aap.lostRatio << std::endl;
       out << "PHY Tx packets:," << "," << srs.aap.phyTxPkts << std::endl;
       out << "PHY over APP traffic ratio [%]:," << "," << srs.aap.usefullNetTraffic << std::endl;
+      out << "PHY Tx airtime [s]:," << "," << srs.aap.phyTxAirtime << std::endl;
+      out << "LPP Tx packets:," << "," << srs.aap.lppTxPkts << std::endl;
+      out << "LPP piggybacked packets:," << "," << srs.aap.lppPiggybackPkts << std::endl;
+      out << "LPP saved packets:," << "," << srs.aap.lppSavedPkts << std::endl;
+      out << "LPP saved airtime [s]:," << "," << srs.aap.lppSavedAirtime << std::endl;
+      out << "RREQ forwarded packets:," << "," << srs.aap.rreqFwdPkts << std::endl;
+      out << "RREQ suppressed re-floods:," << "," << srs.aap.rreqSuppressedPkts << std::endl;
+      out << "Route discoveries:," << "," << srs.aap.routeDiscoveries << std::endl;
+      out << "Route discovery success [%]:," << "," << srs.aap.routeDiscoverySuccess << std::endl;
+      out << "Route discovery failure [%]:," << "," << srs.aap.routeDiscoveryFailure << std::endl;
+      out << "Route discovery latency - Average [ms]:," << "," << 1000.0*srs.aap.routeDiscoveryLatencyAverage << std::endl;
+      out << "Route discovery latency - Median estimate (+/-0.5) [ms]:," << "," << 1000.0*srs.aap.routeDiscoveryLatencyMedianEstimate << std::endl;
+      out << "Route discovery - RREQ retries:," << "," << srs.aap.routeDiscoveryRetries << std::endl;
+      out << "Route discovery - Transmissions:," << "," << srs.aap.routeDiscoveryTxPkts << std::endl;
+      out << "Route discovery - RREQ forwards:," << "," << srs.aap.routeDiscoveryRreqFwdPkts << std::endl;
+      out << "Route discovery - RREQ forwarding nodes:," << "," << srs.aap.routeDiscoveryRreqFwdNodes << std::endl;
+      out << "Route discovery - RREQ forwards per forwarding node:," << "," << srs.aap.routeDiscoveryRreqFwdPerNode << std::endl;
+      out << "Route discovery - RREP transmissions:," << "," << srs.aap.routeDiscoveryRrepTxPkts << std::endl;
+      out << "Route discovery - Hop count:," << "," << srs.aap.routeDiscoveryHopCount << std::endl;
+      out << "Route discovery - ETX:," << "," << srs.aap.routeDiscoveryEtx << std::endl;
+      out << "Local repairs:," << "," << srs.aap.localRepairs << std::endl;
+      out << "Local repair success [%]:," << "," << srs.aap.localRepairSuccess << std::endl;
+      out << "Backup route switches:," << "," << srs.aap.routeSwitches << std::endl;
+      out << "Route cache lookups:," << "," << srs.aap.routeCacheLookups << std::endl;
+      out << "Route cache hits [%]:," << "," << srs.aap.routeCacheHits << std::endl;
+      out << "Control packets dropped by scheduler:," << "," << srs.aap.controlDrops << std::endl;
       out << "E2E delay - Min [ms]:," << 1000.0*srs.aaf.e2eDelayMin << "," << 1000.0*srs.aap.e2eDelayMin << std::endl;
       out << "E2E delay - Max [ms]:," << 1000.0*srs.aaf.e2eDelayMax << "," << 1000.0*srs.aap.e2eDelayMax << std::endl;
       out << "E2E delay - Average [ms]:," << 1000.0*srs.aaf.e2eDelayAverage << "," << 1000.0*srs.aap.e2eDelayAverage << std::endl;
@@ -516,6 +791,8 @@ StatsFlows::Finalize ()
       out << std::endl;
       out.close ();
       m_allPacketsStats.delayHist.WriteToCsvFile (m_fileName + "-sca.csv", 0.0001, "E2E Delay Hist:");
+      latencyHist.WriteToCsvFile (m_fileName + "-sca.csv", 0.001, "Route Discovery Latency Hist:");
+      txPktsHist.WriteToCsvFile (m_fileName + "-sca.csv", 1.0, "Route Discovery Transmissions Hist:");
     }
   Clear ();
   return srs;
@@ -525,6 +802,11 @@ void
 StatsFlows::Clear ()
 {
   m_allPacketsStats.Clear ();
+  m_lppUids.clear ();
+  m_lppPhyTxPending = false;
+  m_routeDiscoveries.clear ();
+  m_lastRouteDiscovery.clear ();
+  m_rreqDiscovery.clear ();
   for (uint16_t i = 0; i < m_flowData.size(); i++)
     {
       m_flowData[i].Clear ();
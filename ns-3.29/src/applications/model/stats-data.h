@@ -27,6 +27,8 @@
 #include <vector>
 #include <fstream>
 #include <utility> // std::pair
+#include <set>
+#include <map>
 
 #include "ns3/nstime.h"
 #include "ns3/ptr.h"
@@ -38,6 +40,7 @@
 #include "ns3/log.h"
 #include "ns3/wifi-mode.h"
 #include "ns3/wifi-preamble.h"
+#include "ns3/wifi-phy-state.h"
 
 namespace ns3 {
   
@@ -56,6 +59,32 @@ struct Summary
 		lostRatio (0),
 		phyTxPkts (0),
 		usefullNetTraffic (0),
+		phyTxAirtime (0),
+		lppTxPkts (0),
+		lppPiggybackPkts (0),
+		lppSavedPkts (0),
+		lppSavedAirtime (0),
+		rreqFwdPkts (0),
+		rreqSuppressedPkts (0),
+		routeDiscoveries (0),
+		routeDiscoverySuccess (0),
+		routeDiscoveryFailure (0),
+		routeDiscoveryLatencyAverage (0),
+		routeDiscoveryLatencyMedianEstimate (0),
+		routeDiscoveryRetries (0),
+		routeDiscoveryTxPkts (0),
+		routeDiscoveryRreqFwdPkts (0),
+		routeDiscoveryRreqFwdNodes (0),
+		routeDiscoveryRreqFwdPerNode (0),
+		routeDiscoveryRrepTxPkts (0),
+		routeDiscoveryHopCount (0),
+		routeDiscoveryEtx (0),
+		localRepairs (0),
+		localRepairSuccess (0),
+		routeSwitches (0),
+		routeCacheLookups (0),
+		routeCacheHits (0),
+		controlDrops (0),
 		e2eDelayMin (0),
 		e2eDelayMax (0),
 		e2eDelayAverage (0),
@@ -72,6 +101,32 @@ struct Summary
 	double lostRatio;
   double phyTxPkts;
   double usefullNetTraffic;
+  double phyTxAirtime; // [s]
+  double lppTxPkts; // AODV link probe packets
+  double lppPiggybackPkts; // AODV link probe packets piggybacked on other AODV messages
+  double lppSavedPkts; // LPPs not sent compared to LPP interval of the routing protocol
+  double lppSavedAirtime; // [s]
+  double rreqFwdPkts; // AODV RREQs forwarded by intermediate nodes
+  double rreqSuppressedPkts; // AODV RREQ re-floods suppressed by forwarding hold-down
+  double routeDiscoveries; // AODV route discoveries
+  double routeDiscoverySuccess; // [%] route discoveries with at least one RREP received by the originator
+  double routeDiscoveryFailure; // [%] route discoveries given up by the originator
+  double routeDiscoveryLatencyAverage; // [s] from the first RREQ to the first RREP, successful discoveries
+  double routeDiscoveryLatencyMedianEstimate; // [s]
+  double routeDiscoveryRetries; // RREQ retries per discovery
+  double routeDiscoveryTxPkts; // RREQs sent and forwarded and RREPs sent and forwarded per discovery
+  double routeDiscoveryRreqFwdPkts; // RREQs forwarded per discovery
+  double routeDiscoveryRreqFwdNodes; // nodes which have forwarded RREQ per discovery
+  double routeDiscoveryRreqFwdPerNode; // RREQs forwarded by one forwarding node per discovery
+  double routeDiscoveryRrepTxPkts; // RREPs sent and forwarded per discovery
+  double routeDiscoveryHopCount; // hop count of discovered routes
+  double routeDiscoveryEtx; // ETX of discovered routes, in units of the metric
+  double localRepairs; // AODV local repairs of broken routes
+  double localRepairSuccess; // [%] local repairs which have found a route
+  double routeSwitches; // AODV broken routes switched to backup routes (multipath mode)
+  double routeCacheLookups; // AODV route cache lookups for RREQ replies
+  double routeCacheHits; // [%] route cache lookups answered from the cache
+  double controlDrops; // AODV control packets dropped by the control packet scheduler
 	double e2eDelayMin;
 	double e2eDelayMax;
 	double e2eDelayAverage;
@@ -102,6 +157,20 @@ struct ScalarData
 	    totalTxBytes (0),
 	    phyTxPkts (0),
 	    phyTxBytes (0),
+	    phyTxAirtime (0),
+	    lppTxPkts (0),
+	    lppPiggybackPkts (0),
+	    lppPhyTxPkts (0),
+	    lppPhyTxAirtime (0),
+	    lppSavedPkts (0),
+	    rreqFwdPkts (0),
+	    rreqSuppressedPkts (0),
+	    localRepairs (0),
+	    localRepairSuccess (0),
+	    routeSwitches (0),
+	    routeCacheLookups (0),
+	    routeCacheHits (0),
+	    controlDrops (0),
 	    delayHist (histRes)  // 0.1 ms, default
   {
     delayHist.Clear ();
@@ -115,6 +184,20 @@ struct ScalarData
 	  totalTxBytes = 0;
     phyTxPkts = 0;
     phyTxBytes = 0;
+    phyTxAirtime = Time (0);
+    lppTxPkts = 0;
+    lppPiggybackPkts = 0;
+    lppPhyTxPkts = 0;
+    lppPhyTxAirtime = Time (0);
+    lppSavedPkts = 0;
+    rreqFwdPkts = 0;
+    rreqSuppressedPkts = 0;
+    localRepairs = 0;
+    localRepairSuccess = 0;
+    routeSwitches = 0;
+    routeCacheLookups = 0;
+    routeCacheHits = 0;
+    controlDrops = 0;
 	  delayHist.Clear ();
   }
 
@@ -125,12 +208,55 @@ struct ScalarData
   uint16_t packetSizeInBytes;
   uint16_t phyTxPkts; // number of phy packets sent
   uint64_t phyTxBytes; // phy bytes sent
+  Time phyTxAirtime; // total duration of phy transmissions
+  uint32_t lppTxPkts; // number of AODV link probe packets sent
+  uint32_t lppPiggybackPkts; // number of AODV link probe packets piggybacked on other AODV messages
+  uint32_t lppPhyTxPkts; // number of phy packets carrying LPP
+  Time lppPhyTxAirtime; // duration of phy transmissions carrying LPP
+  double lppSavedPkts; // sum of (interval / base interval - 1) over sent LPPs
+  uint32_t rreqFwdPkts; // number of AODV RREQs forwarded by intermediate nodes
+  uint32_t rreqSuppressedPkts; // number of better RREQ copies absorbed during forwarding hold-down
+  uint32_t localRepairs; // number of AODV local repairs of broken routes
+  uint32_t localRepairSuccess; // number of local repairs which have found a route
+  uint32_t routeSwitches; // number of broken routes switched to backup routes
+  uint32_t routeCacheLookups; // number of AODV route cache lookups for RREQ replies
+  uint32_t routeCacheHits; // number of route cache lookups answered from the cache
+  uint32_t controlDrops; // number of control packets dropped by the control packet scheduler
   Time firstPacketSent, lastPacketSent;
   Time firstPacketReceived, lastPacketReceived;
   Time firstDelay, lastDelay;
   StatsHist delayHist;
 };
 
+/*******************************************************
+ * RouteDiscoveryData
+ *******************************************************/
+// Cost of one AODV route discovery, from the first RREQ of the originator
+// until the next discovery of the same destination by the same originator
+struct RouteDiscoveryData
+{
+  RouteDiscoveryData ()
+    : rreqTxPkts (0),
+      rreqFwdPkts (0),
+      rrepTxPkts (0),
+      hopCount (0),
+      etx (0),
+      found (false),
+      failed (false)
+  {};
+
+  Time firstRreq; // the first RREQ sent by the originator
+  Time firstRrep; // the first RREP received by the originator
+  uint32_t rreqTxPkts; // RREQs sent by the originator, the first one and retries
+  uint32_t rreqFwdPkts; // RREQs forwarded by other nodes
+  std::map<uint32_t, uint32_t> rreqFwdPerNode; // node ID -> RREQs forwarded by the node
+  uint32_t rrepTxPkts; // RREPs sent and forwarded
+  uint8_t hopCount; // hop count of the route chosen by the originator
+  uint32_t etx; // ETX of the route chosen by the originator
+  bool found; // at least one RREP is received by the originator
+  bool failed; // the originator has given up
+};
+
 /*******************************************************
  * VectorData
  *******************************************************/
@@ -277,6 +403,31 @@ public:
   void PacketReceived (Ptr<const Packet> packet, uint32_t sinkNodeId, uint32_t sinkAppId, Address sourceAddr);
   void PacketSent (Ptr<const Packet> packet);
   void PhyPacketSent (std::string context, Ptr<const Packet> packet, WifiMode mode, WifiPreamble preamble, uint8_t txPower);
+  void PhyStateChanged (std::string context, Time start, Time duration, WifiPhyState state);
+  // AODV LPP is sent, interval is time until the next LPP of the node and base interval
+  // is LPP interval of the routing protocol without adaptation
+  void LppPacketSent (Ptr<const Packet> packet, Time interval, Time baseInterval);
+  // AODV LPP is piggybacked on other AODV message instead of being sent alone
+  void LppPacketPiggybacked (Ptr<const Packet> packet, Time interval, Time baseInterval);
+  // AODV RREQ is forwarded by the node in context, absorbed is number of its copies which
+  // are not forwarded thanks to forwarding hold-down
+  void RreqForwarded (std::string context, Ipv4Address origin, uint32_t id, uint32_t absorbed);
+  // AODV RREQ is sent by the originator of route discovery, retry is false for a new discovery
+  void RreqSent (Ipv4Address origin, uint32_t id, Ipv4Address dst, bool retry);
+  // AODV RREP of route discovery (origin, dst) is sent or forwarded
+  void RrepSent (Ipv4Address origin, Ipv4Address dst);
+  // AODV RREP is received by the originator, hop count and ETX of the chosen route
+  void RouteDiscovered (Ipv4Address origin, Ipv4Address dst, uint8_t hopCount, uint32_t etx);
+  // AODV route discovery (origin, dst) is given up by the originator
+  void RouteDiscoveryFailed (Ipv4Address origin, Ipv4Address dst);
+  // AODV local repair of broken route to dst has finished, repaired is false if RERR is sent
+  void LocalRepairFinished (Ipv4Address dst, bool repaired);
+  // AODV broken route to dst is switched to backup route through nextHop
+  void RouteSwitched (Ipv4Address dst, Ipv4Address nextHop);
+  // AODV route cache is looked up for RREQ to dst, hit is true if the cached route is used
+  void RouteCacheLookup (Ipv4Address dst, bool hit);
+  // AODV control packet is dropped from the full control queue
+  void ControlPacketDropped (Ptr<const Packet> packet);
 
   RunSummary Finalize ();
 
@@ -298,6 +449,13 @@ private:
   std::vector<FlowData> m_flowData;
   std::string m_fileName;
   ScalarData m_allPacketsStats;
+  std::set<uint64_t> m_lppUids; // LPPs not yet sent by phy
+  bool m_lppPhyTxPending; // last phy packet sent is LPP, its duration is not traced yet
+  std::vector<RouteDiscoveryData> m_routeDiscoveries;
+  // the last route discovery of (origin, dst) -> index in m_routeDiscoveries
+  std::map<std::pair<Ipv4Address, Ipv4Address>, uint32_t> m_lastRouteDiscovery;
+  // RREQ (origin, id) -> index in m_routeDiscoveries
+  std::map<std::pair<Ipv4Address, uint32_t>, uint32_t> m_rreqDiscovery;
   bool m_scalarFileWriteEnable;
   bool m_vectorFileWriteEnable;
   double m_histogramResolution;
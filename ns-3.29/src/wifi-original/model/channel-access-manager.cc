@@ -116,6 +116,7 @@ ChannelAccessManager::ChannelAccessManager ()
     m_rxing (false),
     m_sleeping (false),
     m_off (false),
+    m_lazyAccessTimeout (false),
     m_slot (Seconds (0.0)),
     m_sifs (Seconds (0.0)),
     m_phyListener (0)
@@ -197,6 +198,19 @@ ChannelAccessManager::GetEifsNoDifs () const
   return m_eifsNoDifs;
 }
 
+void
+ChannelAccessManager::SetLazyAccessTimeout (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  m_lazyAccessTimeout = enable;
+}
+
+bool
+ChannelAccessManager::GetLazyAccessTimeout (void) const
+{
+  return m_lazyAccessTimeout;
+}
+
 void
 ChannelAccessManager::Add (Ptr<Txop> dcf)
 {
@@ -538,6 +552,32 @@ ChannelAccessManager::DoRestartAccessTimeoutIfNeeded (void)
     {
       NS_LOG_DEBUG ("expected backoff end=" << expectedBackoffEnd);
       Time expectedBackoffDelay = expectedBackoffEnd - Simulator::Now ();
+      if (m_lazyAccessTimeout)
+        {
+          if (m_accessTimeout.IsRunning ()
+              && Simulator::GetDelayLeft (m_accessTimeout) <= expectedBackoffDelay)
+            {
+              //the pending timeout re-evaluates the backoff when it fires
+              return;
+            }
+          if (!m_accessTimeout.IsRunning () && m_spareAccessTimeout.IsRunning ()
+              && Simulator::GetDelayLeft (m_spareAccessTimeout) <= expectedBackoffDelay)
+            {
+              NS_LOG_DEBUG ("reuse spare access timeout");
+              m_accessTimeout = m_spareAccessTimeout;
+              m_spareAccessTimeout = EventId ();
+              return;
+            }
+          if (m_accessTimeout.IsRunning ())
+            {
+              //keep the later timeout as a spare instead of cancelling it
+              m_spareAccessTimeout.Cancel ();
+              m_spareAccessTimeout = m_accessTimeout;
+            }
+          m_accessTimeout = Simulator::Schedule (expectedBackoffDelay,
+                                                 &ChannelAccessManager::AccessTimeout, this);
+          return;
+        }
       if (m_accessTimeout.IsRunning ()
           && Simulator::GetDelayLeft (m_accessTimeout) > expectedBackoffDelay)
         {
@@ -650,6 +690,7 @@ ChannelAccessManager::NotifySwitchingStartNow (Time duration)
     {
       m_accessTimeout.Cancel ();
     }
+  m_spareAccessTimeout.Cancel ();
 
   //Reset backoffs
   for (States::iterator i = m_states.begin (); i != m_states.end (); i++)
@@ -682,6 +723,7 @@ ChannelAccessManager::NotifySleepNow (void)
     {
       m_accessTimeout.Cancel ();
     }
+  m_spareAccessTimeout.Cancel ();
 
   //Reset backoffs
   for (States::iterator i = m_states.begin (); i != m_states.end (); i++)
@@ -701,6 +743,7 @@ ChannelAccessManager::NotifyOffNow (void)
     {
       m_accessTimeout.Cancel ();
     }
+  m_spareAccessTimeout.Cancel ();
 
   //Reset backoffs
   for (States::iterator i = m_states.begin (); i != m_states.end (); i++)
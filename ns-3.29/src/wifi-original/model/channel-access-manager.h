@@ -98,6 +98,20 @@ public:
    * \return value set previously using SetEifsNoDifs.
    */
   Time GetEifsNoDifs () const;
+  /**
+   * \param enable whether access timeouts which are no longer the earliest
+   *        wake-up are kept for later reuse instead of being cancelled.
+   *
+   * In this mode an access timeout firing too early only re-evaluates the
+   * backoff end from the last busy/idle timestamps, and a later pending
+   * timeout is reused as the next wake-up when it fires in time. This is
+   * meant for DCF/EDCA contention without PCF.
+   */
+  void SetLazyAccessTimeout (bool enable);
+  /**
+   * \return true if lazy access timeouts are enabled
+   */
+  bool GetLazyAccessTimeout (void) const;
 
   /**
    * \param dcf a new Txop.
@@ -343,6 +357,8 @@ private:
   bool m_off;                   //!< flag whether it is in off state
   Time m_eifsNoDifs;            //!< EIFS no DIFS time
   EventId m_accessTimeout;      //!< the access timeout ID
+  EventId m_spareAccessTimeout; //!< later access timeout kept for reuse in lazy mode
+  bool m_lazyAccessTimeout;     //!< flag whether later access timeouts are reused instead of cancelled
   Time m_slot;                  //!< the slot time
   Time m_sifs;                  //!< the SIFS time
   PhyListener* m_phyListener;   //!< the phy listener
@@ -25,6 +25,7 @@
 #include "interference-helper.h"
 #include "wifi-phy.h"
 #include "error-rate-model.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -124,6 +125,8 @@ InterferenceHelper::InterferenceHelper ()
     m_firstPower (0),
     m_rxing (false)
 {
+  // Room for a few overlapping frames, the vector only grows afterwards
+  m_niChanges.reserve (32);
   // Always have a zero power noise event in the list
   AddNiChangeEvent (Time (0), NiChange (0.0, 0));
 }
@@ -207,14 +210,17 @@ InterferenceHelper::AppendEvent (Ptr<Event> event)
     {
       m_firstPower = previousPowerStart;
       // Always leave the first zero power noise event in the list
-      m_niChanges.erase (++(m_niChanges.begin ()),
-                         GetNextPosition (event->GetStartTime ()));
+      // Only the changes still in the future are moved, so pruning is cheap
+      NiChanges::const_iterator next = GetNextPosition (event->GetStartTime ());
+      m_niChanges.erase (m_niChanges.begin () + 1,
+                         m_niChanges.begin () + (next - m_niChanges.begin ()));
     }
-  auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
-  auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
-  for (auto i = first; i != last; ++i)
+  // The end is never before the start, so inserting it keeps the start index valid
+  std::size_t first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
+  std::size_t last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
+  for (std::size_t i = first; i != last; ++i)
     {
-      i->second.AddPower (event->GetRxPowerW ());
+      m_niChanges[i].second.AddPower (event->GetRxPowerW ());
     }
 }
 
@@ -234,20 +240,20 @@ InterferenceHelper::CalculateSnr (double signal, double noiseInterference, uint1
 }
 
 double
-InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const
+InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges::const_iterator *first,
+                                                 NiChanges::const_iterator *last) const
 {
   double noiseInterference = m_firstPower;
-  auto it = m_niChanges.find (event->GetStartTime ());
+  auto it = GetFirstPosition (event->GetStartTime ());
   for (; it != m_niChanges.end () && it->second.GetEvent () != event; ++it)
     {
       noiseInterference = it->second.GetPower ();
     }
-  ni->emplace (event->GetStartTime (), NiChange (0, event));
-  while (++it != m_niChanges.end () && it->second.GetEvent () != event)
-    {
-      ni->insert (*it);
-    }
-  ni->emplace (event->GetEndTime (), NiChange (0, event));
+  *first = it;
+  it = std::find_if (it + 1, m_niChanges.end (),
+                     [&event] (const NiChanges::value_type &c) { return c.second.GetEvent () == event; });
+  NS_ASSERT (it != m_niChanges.end ());
+  *last = it + 1;
   return noiseInterference;
 }
 
@@ -274,12 +280,13 @@ InterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, WifiM
 }
 
 double
-InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges::const_iterator first,
+                                             NiChanges::const_iterator last) const
 {
   NS_LOG_FUNCTION (this);
   const WifiTxVector txVector = event->GetTxVector ();
   double psr = 1.0; /* Packet Success Rate */
-  auto j = ni->begin ();
+  auto j = first;
   Time previous = j->first;
   WifiMode payloadMode = event->GetPayloadMode ();
   WifiPreamble preamble = txVector.GetPreambleType ();
@@ -289,7 +296,7 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
   double noiseInterferenceW = m_firstPower;
   double powerW = event->GetRxPowerW ();
-  while (++j != ni->end ())
+  while (++j != last)
     {
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
@@ -322,12 +329,13 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
 }
 
 double
-InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges::const_iterator first,
+                                            NiChanges::const_iterator last) const
 {
   NS_LOG_FUNCTION (this);
   const WifiTxVector txVector = event->GetTxVector ();
   double psr = 1.0; /* Packet Success Rate */
-  auto j = ni->begin ();
+  auto j = first;
   Time previous = j->first;
   WifiPreamble preamble = txVector.GetPreambleType ();
   WifiMode mcsHeaderMode;
@@ -353,7 +361,7 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
   double noiseInterferenceW = m_firstPower;
   double powerW = event->GetRxPowerW ();
-  while (++j != ni->end ())
+  while (++j != last)
     {
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
@@ -739,8 +747,8 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
 {
-  NiChanges ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  NiChanges::const_iterator first, last;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &first, &last);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
                              event->GetTxVector ().GetChannelWidth ());
@@ -748,7 +756,7 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
   /* calculate the SNIR at the start of the packet and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePlcpPayloadPer (event, &ni);
+  double per = CalculatePlcpPayloadPer (event, first, last);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -759,8 +767,8 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<Event> event) const
 {
-  NiChanges ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  NiChanges::const_iterator first, last;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &first, &last);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
                              event->GetTxVector ().GetChannelWidth ());
@@ -768,7 +776,7 @@ InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<Event> event) const
   /* calculate the SNIR at the start of the plcp header and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePlcpHeaderPer (event, &ni);
+  double per = CalculatePlcpHeaderPer (event, first, last);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -789,7 +797,15 @@ InterferenceHelper::EraseEvents (void)
 InterferenceHelper::NiChanges::const_iterator
 InterferenceHelper::GetNextPosition (Time moment) const
 {
-  return m_niChanges.upper_bound (moment);
+  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), moment,
+                           [] (Time t, const NiChanges::value_type &c) { return t < c.first; });
+}
+
+InterferenceHelper::NiChanges::const_iterator
+InterferenceHelper::GetFirstPosition (Time moment) const
+{
+  return std::lower_bound (m_niChanges.begin (), m_niChanges.end (), moment,
+                           [] (const NiChanges::value_type &c, Time t) { return c.first < t; });
 }
 
 InterferenceHelper::NiChanges::const_iterator
@@ -802,10 +818,12 @@ InterferenceHelper::GetPreviousPosition (Time moment) const
   return it;
 }
 
-InterferenceHelper::NiChanges::iterator
+std::size_t
 InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change)
 {
-  return m_niChanges.insert (GetNextPosition (moment), std::make_pair (moment, change));
+  std::size_t index = GetNextPosition (moment) - m_niChanges.begin ();
+  m_niChanges.insert (m_niChanges.begin () + index, std::make_pair (moment, change));
+  return index;
 }
 
 void
@@ -821,7 +839,7 @@ InterferenceHelper::NotifyRxEnd ()
   NS_LOG_FUNCTION (this);
   m_rxing = false;
   //Update m_firstPower for frame capture
-  auto it = m_niChanges.find (Simulator::Now ());
+  auto it = GetFirstPosition (Simulator::Now ());
   it--;
   m_firstPower = it->second.GetPower ();
 }
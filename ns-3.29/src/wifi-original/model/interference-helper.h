@@ -23,7 +23,7 @@
 
 #include "ns3/nstime.h"
 #include "wifi-tx-vector.h"
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -244,9 +244,10 @@ private:
   };
 
   /**
-   * typedef for a multimap of NiChanges
+   * typedef for a time ordered vector of NiChanges. Changes at the same
+   * time are kept in insertion order.
    */
-  typedef std::multimap<Time, NiChange> NiChanges;
+  typedef std::vector<std::pair<Time, NiChange> > NiChanges;
 
   /**
    * Append the given Event.
@@ -255,14 +256,17 @@ private:
    */
   void AppendEvent (Ptr<Event> event);
   /**
-   * Calculate noise and interference power in W.
+   * Calculate noise and interference power in W and find the NiChanges
+   * spanned by the event.
    *
    * \param event
-   * \param ni
+   * \param first set to the NiChange of the event start
+   * \param last set past the NiChange of the event end
    *
    * \return noise and interference power
    */
-  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
+  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges::const_iterator *first,
+                                      NiChanges::const_iterator *last) const;
   /**
    * Calculate SNR (linear ratio) from the given signal power and noise+interference power.
    * (Mode is not currently used)
@@ -291,21 +295,25 @@ private:
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
+   * \param first the NiChange of the event start
+   * \param last past the NiChange of the event end
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges::const_iterator first,
+                                  NiChanges::const_iterator last) const;
   /**
    * Calculate the error rate of the plcp header. The plcp header can be divided into
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
+   * \param first the NiChange of the event start
+   * \param last past the NiChange of the event end
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges::const_iterator first,
+                                 NiChanges::const_iterator last) const;
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel; ///< error rate model
@@ -323,29 +331,31 @@ private:
    */
   NiChanges::const_iterator GetNextPosition (Time moment) const;
   /**
-   * Returns an iterator to the first nichange that is later than moment
+   * Returns an iterator to the last nichange that is before than moment
    *
    * \param moment time to check from
    * \returns an iterator to the list of NiChanges
    */
-  //NiChanges::iterator GetNextPosition (Time moment);
+  NiChanges::const_iterator GetPreviousPosition (Time moment) const;
+
   /**
-   * Returns an iterator to the last nichange that is before than moment
+   * Returns an iterator to the first nichange at moment, or later if
+   * there is none at moment
    *
    * \param moment time to check from
    * \returns an iterator to the list of NiChanges
    */
-  NiChanges::const_iterator GetPreviousPosition (Time moment) const;
+  NiChanges::const_iterator GetFirstPosition (Time moment) const;
 
   /**
    * Add NiChange to the list at the appropriate position and
-   * return the iterator of the new event.
+   * return the index of the new event.
    *
    * \param moment
    * \param change
-   * \returns the iterator of the new event
+   * \returns the index of the new event
    */
-  NiChanges::iterator AddNiChangeEvent (Time moment, NiChange change);
+  std::size_t AddNiChangeEvent (Time moment, NiChange change);
 };
 
 } //namespace ns3
@@ -577,6 +577,19 @@ RegularWifiMac::GetQosSupported () const
   return m_qosSupported;
 }
 
+void
+RegularWifiMac::SetLazyAccessTimeout (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  m_channelAccessManager->SetLazyAccessTimeout (enable);
+}
+
+bool
+RegularWifiMac::GetLazyAccessTimeout () const
+{
+  return m_channelAccessManager->GetLazyAccessTimeout ();
+}
+
 void
 RegularWifiMac::SetVhtSupported (bool enable)
 {
@@ -1085,6 +1098,13 @@ RegularWifiMac::GetTypeId (void)
                    MakeBooleanAccessor (&RegularWifiMac::SetQosSupported,
                                         &RegularWifiMac::GetQosSupported),
                    MakeBooleanChecker ())
+    .AddAttribute ("LazyAccessTimeout",
+                   "If true, access timeouts which are no longer the earliest wake-up "
+                   "are kept and reused instead of being cancelled and rescheduled.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RegularWifiMac::SetLazyAccessTimeout,
+                                        &RegularWifiMac::GetLazyAccessTimeout),
+                   MakeBooleanChecker ())
     .AddAttribute ("HtSupported",
                    "This Boolean attribute is set to enable 802.11n support at this STA.",
                    BooleanValue (false),
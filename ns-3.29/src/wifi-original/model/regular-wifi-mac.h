@@ -449,6 +449,20 @@ protected:
    */
   bool GetQosSupported () const;
 
+  /**
+   * Enable or disable reuse of access timeouts in the channel access manager.
+   *
+   * \param enable whether later access timeouts are reused instead of cancelled
+   */
+  void SetLazyAccessTimeout (bool enable);
+
+  /**
+   * Return whether access timeouts are reused in the channel access manager.
+   *
+   * \return true if lazy access timeouts are enabled, false otherwise
+   */
+  bool GetLazyAccessTimeout () const;
+
   /**
    * Enable or disable HT support for the device.
    *
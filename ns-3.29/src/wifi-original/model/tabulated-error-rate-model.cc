@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/object-factory.h"
+#include "tabulated-error-rate-model.h"
+#include "wifi-tx-vector.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TabulatedErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (TabulatedErrorRateModel);
+
+namespace {
+
+/// Identifies a table shared among model instances
+struct TableKey
+{
+  uint16_t modelUid;   //!< TypeId UID of the wrapped model
+  uint32_t modeUid;    //!< WifiMode UID
+  double minSnrDb;     //!< lowest SNR of the grid (dB)
+  double snrStepDb;    //!< distance between grid points (dB)
+  std::size_t size;    //!< number of grid points
+
+  /**
+   * \param o the other key
+   * \return true if this key orders before o
+   */
+  bool operator< (const TableKey &o) const
+  {
+    if (modelUid != o.modelUid)
+      {
+        return modelUid < o.modelUid;
+      }
+    if (modeUid != o.modeUid)
+      {
+        return modeUid < o.modeUid;
+      }
+    if (minSnrDb != o.minSnrDb)
+      {
+        return minSnrDb < o.minSnrDb;
+      }
+    if (snrStepDb != o.snrStepDb)
+      {
+        return snrStepDb < o.snrStepDb;
+      }
+    return size < o.size;
+  }
+};
+
+/**
+ * \return tables of all instances; map nodes are never erased, so
+ *         pointers to the tables stay valid
+ */
+std::map<TableKey, std::vector<double> > &
+GetSharedTables (void)
+{
+  static std::map<TableKey, std::vector<double> > tables;
+  return tables;
+}
+
+} //anonymous namespace
+
+TypeId
+TabulatedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TabulatedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<TabulatedErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel",
+                   "The TypeId name of the error rate model whose results are tabulated.",
+                   StringValue ("ns3::NistErrorRateModel"),
+                   MakeStringAccessor (&TabulatedErrorRateModel::SetErrorRateModelType),
+                   MakeStringChecker ())
+    .AddAttribute ("Exact",
+                   "If true, all requests are passed to the wrapped model (bit-exact results).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TabulatedErrorRateModel::m_exact),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MinSnr",
+                   "The lowest SNR (dB) in the table, lower SNRs are passed to the wrapped model.",
+                   DoubleValue (-10.0),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::SetMinSnr,
+                                       &TabulatedErrorRateModel::GetMinSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The highest SNR (dB) in the table, higher SNRs are passed to the wrapped model.",
+                   DoubleValue (60.0),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::SetMaxSnr,
+                                       &TabulatedErrorRateModel::GetMaxSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrStep",
+                   "The SNR distance (dB) between two table points. Smaller step gives more accurate results.",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::SetSnrStep,
+                                       &TabulatedErrorRateModel::GetSnrStep),
+                   MakeDoubleChecker<double> (1e-6))
+  ;
+  return tid;
+}
+
+TabulatedErrorRateModel::TabulatedErrorRateModel ()
+  : m_exact (false),
+    m_minSnrDb (-10.0),
+    m_maxSnrDb (60.0),
+    m_snrStepDb (0.01)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TabulatedErrorRateModel::~TabulatedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TabulatedErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_model = 0;
+  m_tables.clear ();
+  ErrorRateModel::DoDispose ();
+}
+
+void
+TabulatedErrorRateModel::SetErrorRateModel (const Ptr<ErrorRateModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  m_tables.clear ();
+}
+
+Ptr<ErrorRateModel>
+TabulatedErrorRateModel::GetErrorRateModel (void) const
+{
+  return m_model;
+}
+
+void
+TabulatedErrorRateModel::SetErrorRateModelType (std::string type)
+{
+  NS_LOG_FUNCTION (this << type);
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  SetErrorRateModel (factory.Create<ErrorRateModel> ());
+}
+
+void
+TabulatedErrorRateModel::SetMinSnr (double snrDb)
+{
+  m_minSnrDb = snrDb;
+  m_tables.clear ();
+}
+
+double
+TabulatedErrorRateModel::GetMinSnr (void) const
+{
+  return m_minSnrDb;
+}
+
+void
+TabulatedErrorRateModel::SetMaxSnr (double snrDb)
+{
+  m_maxSnrDb = snrDb;
+  m_tables.clear ();
+}
+
+double
+TabulatedErrorRateModel::GetMaxSnr (void) const
+{
+  return m_maxSnrDb;
+}
+
+void
+TabulatedErrorRateModel::SetSnrStep (double stepDb)
+{
+  m_snrStepDb = stepDb;
+  m_tables.clear ();
+}
+
+double
+TabulatedErrorRateModel::GetSnrStep (void) const
+{
+  return m_snrStepDb;
+}
+
+const std::vector<double> &
+TabulatedErrorRateModel::GetTable (WifiMode mode, WifiTxVector txVector) const
+{
+  std::map<uint32_t, const std::vector<double> *>::const_iterator it = m_tables.find (mode.GetUid ());
+  if (it != m_tables.end ())
+    {
+      return *it->second;
+    }
+  TableKey key;
+  key.modelUid = m_model->GetInstanceTypeId ().GetUid ();
+  key.modeUid = mode.GetUid ();
+  key.minSnrDb = m_minSnrDb;
+  key.snrStepDb = m_snrStepDb;
+  key.size = (m_maxSnrDb > m_minSnrDb) ? static_cast<std::size_t> ((m_maxSnrDb - m_minSnrDb) / m_snrStepDb) + 1 : 1;
+  std::vector<double> &table = GetSharedTables ()[key];
+  if (table.empty ())
+    {
+      NS_LOG_DEBUG ("Computing " << key.size << " points for " << mode);
+      table.resize (key.size);
+      for (std::size_t i = 0; i < key.size; ++i)
+        {
+          double snr = std::pow (10.0, (m_minSnrDb + i * m_snrStepDb) / 10.0);
+          double success = m_model->GetChunkSuccessRate (mode, txVector, snr, 1);
+          //logarithm of zero would break the interpolation
+          table[i] = std::log (std::max (success, DBL_MIN));
+        }
+    }
+  m_tables[mode.GetUid ()] = &table;
+  return table;
+}
+
+double
+TabulatedErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
+  if (m_exact || !(snr > 0))
+    {
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  const std::vector<double> &table = GetTable (mode, txVector);
+  double pos = (10.0 * std::log10 (snr) - m_minSnrDb) / m_snrStepDb;
+  if (pos < 0 || pos >= table.size () - 1)
+    {
+      //out of the grid
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  std::size_t i = static_cast<std::size_t> (pos);
+  double logSuccess = table[i] + (pos - i) * (table[i + 1] - table[i]);
+  return std::exp (static_cast<double> (nbits) * logSuccess);
+}
+
+} //namespace ns3
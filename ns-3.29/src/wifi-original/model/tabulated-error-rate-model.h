@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Belgrade, Faculty of Traffic and Transport Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TABULATED_ERROR_RATE_MODEL_H
+#define TABULATED_ERROR_RATE_MODEL_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ * \brief Error rate model decorator using precomputed per-bit success rate tables.
+ *
+ * The wrapped model (NistErrorRateModel by default) is evaluated once per
+ * WifiMode on a uniform grid of SNR values in dB, and the natural logarithm
+ * of the single bit chunk success rate is stored. GetChunkSuccessRate then
+ * interpolates linearly between grid points and returns exp (nbits * value),
+ * which avoids erfc, pow and series evaluation on every interference chunk.
+ *
+ * This relies on the chunk success rate of the wrapped model being
+ * (1 - pe (snr))^nbits, which holds for NistErrorRateModel, YansErrorRateModel
+ * and DsssErrorRateModel. Tables are shared among all instances wrapping the
+ * same model type with the same grid, so the wrapped model must be stateless.
+ *
+ * SNR values outside of the grid, and all values when the Exact attribute
+ * is set, are passed to the wrapped model, whose results are then bit-exact.
+ */
+class TabulatedErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TabulatedErrorRateModel ();
+  virtual ~TabulatedErrorRateModel ();
+
+  double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+  /**
+   * Set the error rate model whose results are tabulated.
+   *
+   * \param model the wrapped error rate model
+   */
+  void SetErrorRateModel (const Ptr<ErrorRateModel> model);
+  /**
+   * \return the wrapped error rate model
+   */
+  Ptr<ErrorRateModel> GetErrorRateModel (void) const;
+  /**
+   * Create the wrapped error rate model from its type name.
+   *
+   * \param type the TypeId name of the wrapped error rate model
+   */
+  void SetErrorRateModelType (std::string type);
+  /**
+   * Set the lowest SNR of the grid.
+   *
+   * \param snrDb the SNR in dB
+   */
+  void SetMinSnr (double snrDb);
+  /**
+   * \return the lowest SNR of the grid in dB
+   */
+  double GetMinSnr (void) const;
+  /**
+   * Set the highest SNR of the grid.
+   *
+   * \param snrDb the SNR in dB
+   */
+  void SetMaxSnr (double snrDb);
+  /**
+   * \return the highest SNR of the grid in dB
+   */
+  double GetMaxSnr (void) const;
+  /**
+   * Set the SNR distance between two grid points.
+   *
+   * \param stepDb the step in dB
+   */
+  void SetSnrStep (double stepDb);
+  /**
+   * \return the SNR distance between two grid points in dB
+   */
+  double GetSnrStep (void) const;
+
+private:
+  void DoDispose (void);
+
+  /**
+   * Return the table for the given mode, computing it on first use.
+   *
+   * \param mode the Wi-Fi mode
+   * \param txVector TXVECTOR passed to the wrapped model
+   *
+   * \return logarithm of the single bit success rate on the SNR grid
+   */
+  const std::vector<double> & GetTable (WifiMode mode, WifiTxVector txVector) const;
+
+  Ptr<ErrorRateModel> m_model; //!< wrapped error rate model
+  bool m_exact;                //!< pass all requests to the wrapped model
+  double m_minSnrDb;           //!< lowest SNR of the grid (dB)
+  double m_maxSnrDb;           //!< highest SNR of the grid (dB)
+  double m_snrStepDb;          //!< distance between grid points (dB)
+  /// tables of this instance, indexed by WifiMode UID
+  mutable std::map<uint32_t, const std::vector<double> *> m_tables;
+};
+
+} //namespace ns3
+
+#endif /* TABULATED_ERROR_RATE_MODEL_H */
@@ -372,6 +372,8 @@ WifiPhy::WifiPhy ()
     m_initialChannelNumber (0),
     m_totalAmpduSize (0),
     m_totalAmpduNumSymbols (0),
+    m_txDurationCacheHits (0),
+    m_txDurationCacheMisses (0),
     m_currentEvent (0),
     m_wifiRadioEnergyModel (0)
 {
@@ -2224,14 +2226,79 @@ WifiPhy::CalculatePlcpPreambleAndHeaderDuration (WifiTxVector txVector)
   return duration;
 }
 
+bool
+WifiPhy::TxDurationKey::operator== (const TxDurationKey &o) const
+{
+  return size == o.size && modeUid == o.modeUid && frequency == o.frequency
+         && channelWidth == o.channelWidth && guardInterval == o.guardInterval
+         && preamble == o.preamble && nss == o.nss && ness == o.ness && stbc == o.stbc;
+}
+
+std::size_t
+WifiPhy::TxDurationKeyHash::operator() (const TxDurationKey &k) const
+{
+  std::size_t h = k.size;
+  h = h * 31 + k.modeUid;
+  h = h * 31 + k.frequency;
+  h = h * 31 + k.channelWidth;
+  h = h * 31 + k.guardInterval;
+  h = h * 31 + k.preamble;
+  h = h * 31 + k.nss;
+  h = h * 31 + k.ness;
+  h = h * 31 + k.stbc;
+  return h;
+}
+
 Time
 WifiPhy::CalculateTxDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag)
 {
+  //A-MPDU subframe durations depend on the previous subframes, so only
+  //durations of normal MPDUs are cached
+  if (mpdutype != NORMAL_MPDU)
+    {
+      return CalculatePlcpPreambleAndHeaderDuration (txVector)
+             + GetPayloadDuration (size, txVector, frequency, mpdutype, incFlag);
+    }
+  TxDurationKey key;
+  key.size = size;
+  key.modeUid = txVector.GetMode ().GetUid ();
+  key.frequency = frequency;
+  key.channelWidth = txVector.GetChannelWidth ();
+  key.guardInterval = txVector.GetGuardInterval ();
+  key.preamble = txVector.GetPreambleType ();
+  key.nss = txVector.GetNss ();
+  key.ness = txVector.GetNess ();
+  key.stbc = txVector.IsStbc ();
+  TxDurationCache::const_iterator it = m_txDurationCache.find (key);
+  if (it != m_txDurationCache.end ())
+    {
+      m_txDurationCacheHits++;
+      return it->second;
+    }
+  m_txDurationCacheMisses++;
   Time duration = CalculatePlcpPreambleAndHeaderDuration (txVector)
     + GetPayloadDuration (size, txVector, frequency, mpdutype, incFlag);
+  if (m_txDurationCache.size () >= TX_DURATION_CACHE_SIZE)
+    {
+      NS_LOG_DEBUG ("TX duration cache full, flushing");
+      m_txDurationCache.clear ();
+    }
+  m_txDurationCache.insert (std::make_pair (key, duration));
   return duration;
 }
 
+uint64_t
+WifiPhy::GetTxDurationCacheHits (void) const
+{
+  return m_txDurationCacheHits;
+}
+
+uint64_t
+WifiPhy::GetTxDurationCacheMisses (void) const
+{
+  return m_txDurationCacheMisses;
+}
+
 Time
 WifiPhy::CalculateTxDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency)
 {
@@ -2336,8 +2403,6 @@ WifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, MpduType m
   m_state->SwitchToTx (txDuration, packet, GetPowerDbm (txVector.GetTxPowerLevel ()), txVector);
 
   Ptr<Packet> newPacket = packet->Copy (); // obtain non-const Packet
-  WifiPhyTag oldtag;
-  newPacket->RemovePacketTag (oldtag);
   if (m_state->GetState () == WifiPhyState::OFF)
     {
       NS_LOG_DEBUG ("Transmission canceled because device is OFF");
@@ -2349,7 +2414,9 @@ WifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, MpduType m
       isFrameComplete = 0;
     }
   WifiPhyTag tag (txVector, mpdutype, isFrameComplete);
-  newPacket->AddPacketTag (tag);
+  //a retransmitted or forwarded packet may still carry the tag of its
+  //previous transmission, which is then updated in place
+  newPacket->ReplacePacketTag (tag);
 
   StartTx (newPacket, txVector, txDuration);
 }
@@ -2357,8 +2424,10 @@ WifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, MpduType m
 void
 WifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet, double rxPowerW, Time rxDuration)
 {
+  //the tag list is shared with the copies delivered to the other receivers,
+  //removing the tag would copy the list, so the tag is only read
   WifiPhyTag tag;
-  bool found = packet->RemovePacketTag (tag);
+  bool found = packet->PeekPacketTag (tag);
   if (!found)
     {
       NS_FATAL_ERROR ("Received Wi-Fi Signal with no WifiPhyTag");
@@ -27,6 +27,7 @@
 #include "wifi-phy-standard.h"
 #include "interference-helper.h"
 #include "wifi-phy-state-helper.h"
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -235,6 +236,14 @@ public:
    * \return the total amount of time this PHY will stay busy for the transmission of these bytes.
    */
   Time CalculateTxDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag);
+  /**
+   * \return the number of TX duration calculations answered from the cache
+   */
+  uint64_t GetTxDurationCacheHits (void) const;
+  /**
+   * \return the number of TX duration calculations not found in the cache
+   */
+  uint64_t GetTxDurationCacheMisses (void) const;
 
   /**
    * \param txVector the transmission parameters used for this packet
@@ -1780,6 +1789,44 @@ private:
   uint8_t               m_channelNumber;            //!< Operating channel number
   uint8_t               m_initialChannelNumber;     //!< Initial channel number
 
+  /**
+   * Parameters the duration of a non aggregated MPDU depends on.
+   */
+  struct TxDurationKey
+  {
+    uint32_t size;          //!< MPDU size (bytes)
+    uint32_t modeUid;       //!< UID of the payload WifiMode
+    uint16_t frequency;     //!< channel center frequency (MHz)
+    uint16_t channelWidth;  //!< channel width (MHz)
+    uint16_t guardInterval; //!< guard interval (ns)
+    uint8_t preamble;       //!< preamble type
+    uint8_t nss;            //!< number of spatial streams
+    uint8_t ness;           //!< number of extension spatial streams
+    bool stbc;              //!< STBC is used
+
+    /**
+     * \param o the other key
+     * \return true if all parameters are equal
+     */
+    bool operator== (const TxDurationKey &o) const;
+  };
+  /// Hash function of TxDurationKey
+  struct TxDurationKeyHash
+  {
+    /**
+     * \param k the key
+     * \return the hash value
+     */
+    std::size_t operator() (const TxDurationKey &k) const;
+  };
+  /// cache of TX durations of non aggregated MPDUs
+  typedef std::unordered_map<TxDurationKey, Time, TxDurationKeyHash> TxDurationCache;
+  static const std::size_t TX_DURATION_CACHE_SIZE = 256; //!< entries kept before the cache is flushed
+
+  TxDurationCache m_txDurationCache; //!< TX duration cache
+  uint64_t m_txDurationCacheHits;    //!< number of cache hits
+  uint64_t m_txDurationCacheMisses;  //!< number of cache misses
+
   Time m_channelSwitchDelay;     //!< Time required to switch between channel
   uint32_t m_totalAmpduSize;     //!< Total size of the previously transmitted MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
   double m_totalAmpduNumSymbols; //!< Number of symbols previously transmitted for the MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
@@ -382,6 +382,12 @@ WifiRemoteStationManager::GetTypeId (void)
                    MakeEnumAccessor (&WifiRemoteStationManager::m_htProtectionMode),
                    MakeEnumChecker (WifiRemoteStationManager::RTS_CTS, "Rts-Cts",
                                     WifiRemoteStationManager::CTS_TO_SELF, "Cts-To-Self"))
+    .AddAttribute ("StationExpiry",
+                   "Remote stations which were silent for longer than this time are deleted "
+                   "and recreated with default state when heard again. Zero keeps them forever.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&WifiRemoteStationManager::m_stationExpiry),
+                   MakeTimeChecker ())
     .AddTraceSource ("MacTxRtsFailed",
                      "The transmission of a RTS by the MAC layer has failed",
                      MakeTraceSourceAccessor (&WifiRemoteStationManager::m_macTxRtsFailed),
@@ -1637,17 +1643,69 @@ WifiRemoteStationManager::GetInfo (Mac48Address address)
   return state->m_info;
 }
 
+uint64_t
+WifiRemoteStationManager::GetStateKey (Mac48Address address)
+{
+  uint8_t buffer[6];
+  address.CopyTo (buffer);
+  uint64_t key = 0;
+  for (uint8_t i = 0; i < 6; i++)
+    {
+      key = (key << 8) | buffer[i];
+    }
+  return key;
+}
+
+void
+WifiRemoteStationManager::PurgeStations (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  m_lastPurge = now;
+  for (Stations::iterator i = m_stations.begin (); i != m_stations.end (); )
+    {
+      if (now - i->second->m_state->m_lastLookup > m_stationExpiry)
+        {
+          delete i->second;
+          i = m_stations.erase (i);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  for (StationStates::iterator i = m_states.begin (); i != m_states.end (); )
+    {
+      if (now - i->second->m_lastLookup > m_stationExpiry)
+        {
+          NS_LOG_DEBUG ("Deleting silent station " << i->second->m_address);
+          delete i->second;
+          i = m_states.erase (i);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
 WifiRemoteStationState *
 WifiRemoteStationManager::LookupState (Mac48Address address) const
 {
   NS_LOG_FUNCTION (this << address);
-  for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+  uint64_t key = GetStateKey (address);
+  StationStates::const_iterator it = m_states.find (key);
+  if (it != m_states.end ())
     {
-      if ((*i)->m_address == address)
-        {
-          NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
-          return (*i);
-        }
+      NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
+      it->second->m_lastLookup = Simulator::Now ();
+      return it->second;
+    }
+  //stations still in use were looked up now, so only silent ones can be deleted
+  if (m_stationExpiry.IsStrictlyPositive ()
+      && Simulator::Now () - m_lastPurge > m_stationExpiry)
+    {
+      const_cast<WifiRemoteStationManager *> (this)->PurgeStations ();
     }
   WifiRemoteStationState *state = new WifiRemoteStationState ();
   state->m_state = WifiRemoteStationState::BRAND_NEW;
@@ -1667,7 +1725,8 @@ WifiRemoteStationManager::LookupState (Mac48Address address) const
   state->m_htSupported = false;
   state->m_vhtSupported = false;
   state->m_heSupported = false;
-  const_cast<WifiRemoteStationManager *> (this)->m_states.push_back (state);
+  state->m_lastLookup = Simulator::Now ();
+  const_cast<WifiRemoteStationManager *> (this)->m_states.insert (std::make_pair (key, state));
   NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning new state");
   return state;
 }
@@ -1691,13 +1750,12 @@ WifiRemoteStation *
 WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << address << +tid);
-  for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
+  uint64_t key = (GetStateKey (address) << 8) | tid;
+  Stations::const_iterator it = m_stations.find (key);
+  if (it != m_stations.end ())
     {
-      if ((*i)->m_tid == tid
-          && (*i)->m_state->m_address == address)
-        {
-          return (*i);
-        }
+      it->second->m_state->m_lastLookup = Simulator::Now ();
+      return it->second;
     }
   WifiRemoteStationState *state = LookupState (address);
 
@@ -1706,7 +1764,7 @@ WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
   station->m_tid = tid;
   station->m_ssrc = 0;
   station->m_slrc = 0;
-  const_cast<WifiRemoteStationManager *> (this)->m_stations.push_back (station);
+  const_cast<WifiRemoteStationManager *> (this)->m_stations.insert (std::make_pair (key, station));
   return station;
 }
 
@@ -1869,12 +1927,12 @@ WifiRemoteStationManager::Reset (void)
   NS_LOG_FUNCTION (this);
   for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_states.clear ();
   for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_stations.clear ();
   m_bssBasicRateSet.clear ();
@@ -28,6 +28,7 @@
 #include "ns3/mac48-address.h"
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -1320,6 +1321,16 @@ private:
    * \return WifiRemoteStationState corresponding to the address
    */
   WifiRemoteStationState* LookupState (Mac48Address address) const;
+  /**
+   * Delete the state and stations of all remote stations which were not
+   * looked up for longer than the StationExpiry time.
+   */
+  void PurgeStations (void);
+  /**
+   * \param address the address of the station
+   * \return the key of the station state
+   */
+  static uint64_t GetStateKey (Mac48Address address);
   /**
    * Return the station associated with the given address and TID.
    *
@@ -1387,13 +1398,13 @@ private:
   uint32_t GetNFragments (const WifiMacHeader *header, Ptr<const Packet> packet);
 
   /**
-   * A vector of WifiRemoteStations
+   * WifiRemoteStations indexed by station address and TID
    */
-  typedef std::vector <WifiRemoteStation *> Stations;
+  typedef std::unordered_map <uint64_t, WifiRemoteStation *> Stations;
   /**
-   * A vector of WifiRemoteStationStates
+   * WifiRemoteStationStates indexed by station address
    */
-  typedef std::vector <WifiRemoteStationState *> StationStates;
+  typedef std::unordered_map <uint64_t, WifiRemoteStationState *> StationStates;
 
   /**
    * This is a pointer to the WifiPhy associated with this
@@ -1426,6 +1437,8 @@ private:
 
   StationStates m_states;  //!< States of known stations
   Stations m_stations;     //!< Information for each known stations
+  Time m_stationExpiry;    //!< Time after which silent stations are deleted, zero if never
+  Time m_lastPurge;        //!< Last time silent stations were deleted
 
   WifiMode m_defaultTxMode; //!< The default transmission mode
   WifiMode m_defaultTxMcs;   //!< The default transmission modulation-coding scheme (MCS)
@@ -1515,6 +1528,7 @@ struct WifiRemoteStationState
   bool m_htSupported;         //!< Flag if HT is supported by the station
   bool m_vhtSupported;        //!< Flag if VHT is supported by the station
   bool m_heSupported;         //!< Flag if HE is supported by the station
+  Time m_lastLookup;          //!< Last time the station was looked up
 };
 
 /**